@@ -91,6 +91,10 @@
 #define BLOCK_FLAG_BOTTOM_FIELD_FIRST 0x1000
 /** This block contains a single field from interlaced picture. */
 #define BLOCK_FLAG_SINGLE_FIELD  0x2000
+/** This block starts at a splice point out of the network (ad break start) */
+#define BLOCK_FLAG_SPLICE_OUT    0x4000
+/** This block starts at a splice point back into the network */
+#define BLOCK_FLAG_SPLICE_IN     0x8000
 
 /** This block contains an interlaced picture */
 #define BLOCK_FLAG_INTERLACED_MASK \
@@ -99,6 +103,9 @@
 #define BLOCK_FLAG_TYPE_MASK \
     (BLOCK_FLAG_TYPE_I|BLOCK_FLAG_TYPE_P|BLOCK_FLAG_TYPE_B|BLOCK_FLAG_TYPE_PB)
 
+#define BLOCK_FLAG_SPLICE_MASK \
+    (BLOCK_FLAG_SPLICE_OUT|BLOCK_FLAG_SPLICE_IN)
+
 /* These are for input core private usage only */
 #define BLOCK_FLAG_CORE_PRIVATE_MASK  0x00ff0000
 #define BLOCK_FLAG_CORE_PRIVATE_SHIFT 16
@@ -257,6 +264,45 @@ VLC_API block_t *block_mmap_Alloc(void *addr, size_t length) VLC_USED VLC_MALLOC
  */
 VLC_API block_t * block_shm_Alloc(void *addr, size_t length) VLC_USED VLC_MALLOC;
 
+/**
+ * Slices a block without copying.
+ *
+ * Cuts the payload of a block in two at the given offset. The head is
+ * returned, and the tail replaces the original block (a block that is already
+ * a slice is advanced in place, so that cutting a block into many small
+ * pieces costs one allocation per piece). Both share the same
+ * underlying storage, which is released only once both blocks (and any
+ * further split off them) have been released.
+ *
+ * The head inherits the properties (flags, timestamps...) of the original
+ * block, whereas the tail has default properties. Neither block can grow into
+ * the payload of the other: block_Realloc() will copy the data if needed.
+ *
+ * @param pp pointer to the (unchained) block to split [IN/OUT]
+ * @param offset byte offset of the cut, at most the payload length
+ * @return the head block, or NULL on memory error (the original block is
+ * left unchanged in that case). If offset equals the payload length, the
+ * original block is returned and *pp is set to NULL.
+ */
+VLC_API block_t *block_Slice(block_t **pp, size_t offset) VLC_USED;
+
+/**
+ * Shares a block without copying.
+ *
+ * Creates another reference to the payload of a block, e.g. to hand the same
+ * data over to several consumers. The original block may be replaced by an
+ * equivalent one. The storage is released once all the references have been
+ * released.
+ *
+ * The new block inherits the properties (flags, timestamps...) of the
+ * original. The payload is shared, so it must not be modified in place:
+ * block_Realloc() will copy the data if a block needs to grow.
+ *
+ * @param pp pointer to the (unchained) block to share [IN/OUT]
+ * @return the new reference, or NULL on memory error (*pp remains valid).
+ */
+VLC_API block_t *block_Share(block_t **pp) VLC_USED;
+
 /**
  * Maps a file handle in memory.
  *
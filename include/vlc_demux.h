@@ -120,6 +120,73 @@ typedef struct demux_meta_t
     input_attachment_t **attachments;    /**< array of attachments */
 } demux_meta_t;
 
+/**
+ * ETR 290 (DVB measurement guidelines) first and second priority indicators,
+ * as measured by the transport stream demuxer (see DEMUX_GET_TS_STATS)
+ */
+enum demux_etr290_indicator
+{
+    DEMUX_ETR290_TS_SYNC_LOSS,            /**< 1.1 */
+    DEMUX_ETR290_SYNC_BYTE_ERROR,         /**< 1.2 */
+    DEMUX_ETR290_PAT_ERROR,               /**< 1.3 */
+    DEMUX_ETR290_CC_ERROR,                /**< 1.4 */
+    DEMUX_ETR290_PMT_ERROR,               /**< 1.5 */
+    DEMUX_ETR290_PID_ERROR,               /**< 1.6 */
+    DEMUX_ETR290_TRANSPORT_ERROR,         /**< 2.1 */
+    DEMUX_ETR290_CRC_ERROR,               /**< 2.2 */
+    DEMUX_ETR290_PCR_REPETITION_ERROR,    /**< 2.3a */
+    DEMUX_ETR290_PCR_DISCONTINUITY_ERROR, /**< 2.3b */
+    DEMUX_ETR290_PCR_ACCURACY_ERROR,      /**< 2.4 */
+    DEMUX_ETR290_PTS_ERROR,               /**< 2.5 */
+    DEMUX_ETR290_CAT_ERROR,               /**< 2.6 */
+    DEMUX_ETR290_COUNT
+};
+
+typedef struct
+{
+    uint64_t i_count;  /**< occurrences since the start */
+    uint32_t i_window; /**< occurrences during the last second of stream */
+    mtime_t  i_last;   /**< stream time of the last occurrence, or -1 */
+} demux_etr290_counter_t;
+
+/**
+ * Measurements of a transport stream PID
+ */
+typedef struct
+{
+    uint16_t i_pid;
+    int      i_program; /**< number of the (first) program of the PID, or -1 */
+
+    /** PES header analysis, if the PID is an elementary stream */
+    bool     b_analysis;
+    uint8_t  i_stream_id;  /**< of the last PES */
+    uint64_t i_packets;
+    uint64_t i_scrambled;  /**< scrambled packets */
+    uint32_t i_pes;        /**< PES packets */
+    uint32_t i_cc_errors;  /**< continuity counter errors */
+    uint32_t i_bitrate;    /**< bits per second over the last second */
+    mtime_t  i_pts;        /**< last PTS (90kHz), or -1 */
+    bool     b_pcr_offset;
+    mtime_t  i_pcr_offset; /**< last PTS minus the program PCR (90kHz) */
+
+    bool     b_etr290;     /**< whether the ETR 290 indicators are measured */
+    demux_etr290_counter_t etr290[DEMUX_ETR290_COUNT];
+} demux_ts_pid_stats_t;
+
+/**
+ * Measurements of the transport stream demuxer (see DEMUX_GET_TS_STATS)
+ */
+struct demux_ts_stats_t
+{
+    /** Whole stream indicators, if measured. The PCR accuracy is not
+     * measured if the access filters the PIDs. */
+    bool b_etr290;
+    demux_etr290_counter_t etr290[DEMUX_ETR290_COUNT];
+
+    size_t i_pids;
+    demux_ts_pid_stats_t *p_pids; /**< by increasing PID, to be freed */
+};
+
 /**
  * Control query identifiers for use with demux_t.pf_control
  *
@@ -329,7 +396,13 @@ enum demux_query_e
      * work in future VLC versions, nor with all demux filters
      */
     DEMUX_FILTER_ENABLE,
-    DEMUX_FILTER_DISABLE
+    DEMUX_FILTER_DISABLE,
+
+    /** Retrieves the PES header analysis and the ETR 290 indicators of the
+     * transport stream, per PID. Fails if neither is enabled.
+     *
+     * arg1= demux_ts_stats_t *, whose p_pids must be freed */
+    DEMUX_GET_TS_STATS,
 };
 
 /*************************************************************************
@@ -421,6 +421,18 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* Clock */
+    int64_t i_clock_jitter;   /**< reception jitter (in microseconds) */
+    float   f_clock_drift;    /**< drift of the stream clock (in ppm) */
+
+    /* Sout queues */
+    int64_t i_sout_queue_depth;   /**< bytes queued by the access outputs */
+    int64_t i_sout_queue_max;     /**< most bytes queued by one of them */
+    int64_t i_sout_queue_dropped; /**< writes dropped by the access outputs */
+
+    /* Transport stream */
+    demux_ts_stats_t *p_ts; /**< TS demuxer measurements, or NULL */
 };
 
 /**
@@ -0,0 +1,127 @@
+/*****************************************************************************
+ * vlc_tracer.h: per-frame latency tracing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_TRACER_H
+#define VLC_TRACER_H 1
+
+/**
+ * \defgroup tracer Latency tracer
+ * \ingroup misc
+ *
+ * Opt-in tracing of the time spent by blocks and pictures in the main
+ * pipeline stages (see the "trace-file" option).
+ *
+ * Events are tagged with the timestamp of the traced frame, in the time
+ * base of the demuxer: the PTS, or the DTS if there is none. Past the
+ * decoder, the data is dated with the system clock; such dates are mapped
+ * back to the demuxer timestamp they were converted from. The hops of a
+ * given frame can then be matched, and the latency between two successive
+ * hops of the same frame is measured.
+ * @{
+ */
+
+enum vlc_tracer_stage
+{
+    VLC_TRACER_ACCESS_READ,  /**< access read (span) */
+    VLC_TRACER_DEMUX,        /**< demux call (span) */
+    VLC_TRACER_DECODER_IN,   /**< block queued to a decoder (instant) */
+    VLC_TRACER_DECODE,       /**< decoder call (span) */
+    VLC_TRACER_FILTER,       /**< video filters (span) */
+    VLC_TRACER_RENDER,       /**< video rendering with subpictures (span) */
+    VLC_TRACER_DISPLAY,      /**< video display (span) */
+    VLC_TRACER_ENCODE,       /**< stream output encoder call (span) */
+    VLC_TRACER_MUX,          /**< mux input and call (span) */
+    VLC_TRACER_ACCESS_OUT,   /**< access output write (span) */
+    VLC_TRACER_STAGE_COUNT
+};
+
+typedef struct vlc_tracer vlc_tracer_t;
+
+/**
+ * Returns the tracer of the instance of an object.
+ *
+ * \return the tracer or NULL if tracing is disabled
+ */
+VLC_API vlc_tracer_t *vlc_tracer_Get(vlc_object_t *obj);
+#define vlc_tracer_Get(o) vlc_tracer_Get(VLC_OBJECT(o))
+
+/**
+ * Records an event.
+ *
+ * \param start date of the beginning of the event
+ * \param end date of the end of the event, equal to start for an instant
+ * \param ts demuxer timestamp of the traced frame, or VLC_TS_INVALID
+ */
+VLC_API void vlc_tracer_Record(vlc_tracer_t *tracer,
+                               enum vlc_tracer_stage stage,
+                               mtime_t start, mtime_t end, mtime_t ts);
+
+/**
+ * Returns the demuxer timestamp a system date was converted from, or
+ * VLC_TS_INVALID if unknown.
+ */
+VLC_API mtime_t vlc_tracer_Resolve(vlc_tracer_t *tracer, mtime_t date);
+
+/**
+ * Returns the start date of a traced span, or 0 if tracing is disabled.
+ */
+static inline mtime_t vlc_tracer_Begin(vlc_tracer_t *tracer)
+{
+    return likely(tracer == NULL) ? 0 : mdate();
+}
+
+/**
+ * Ends a span started with vlc_tracer_Begin(), for a demuxer timestamp.
+ */
+static inline void vlc_tracer_End(vlc_tracer_t *tracer,
+                                  enum vlc_tracer_stage stage,
+                                  mtime_t start, mtime_t ts)
+{
+    if (unlikely(tracer != NULL))
+        vlc_tracer_Record(tracer, stage, start, mdate(), ts);
+}
+
+/**
+ * Ends a span started with vlc_tracer_Begin(), for a system date.
+ */
+static inline void vlc_tracer_EndDate(vlc_tracer_t *tracer,
+                                      enum vlc_tracer_stage stage,
+                                      mtime_t start, mtime_t date)
+{
+    if (unlikely(tracer != NULL))
+        vlc_tracer_Record(tracer, stage, start, mdate(),
+                          vlc_tracer_Resolve(tracer, date));
+}
+
+/**
+ * Records an instant event, for a demuxer timestamp.
+ */
+static inline void vlc_tracer_Mark(vlc_tracer_t *tracer,
+                                   enum vlc_tracer_stage stage, mtime_t ts)
+{
+    if (unlikely(tracer != NULL))
+    {
+        mtime_t now = mdate();
+        vlc_tracer_Record(tracer, stage, now, now, ts);
+    }
+}
+
+/** @} */
+#endif
@@ -0,0 +1,324 @@
+/*****************************************************************************
+ * fanout.c: deliver one muxed stream to several access outputs
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_sout.h>
+#include <vlc_block.h>
+
+/*
+ * The stream is muxed once, and every block written to this access output is
+ * handed over by reference to each destination access output. The
+ * destinations are asynchronous access outputs, each written from its own
+ * thread through a bounded queue, so that a slow consumer (an HTTP client,
+ * a disk) does not stall the others.
+ *
+ * Usage: std{mux=ts,access=fanout{dst="udp://239.0.0.1",
+ *                                 dst="file:///rec.ts",policy=block},dst=x}
+ * The "policy" and "queue-size" options apply to the preceding destination.
+ * They default to --sout-access-policy and --sout-access-queue-size.
+ */
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+vlc_module_begin ()
+    set_description( N_("Fan-out stream output") )
+    set_shortname( N_("Fan-out") )
+    set_capability( "sout access", 0 )
+    set_category( CAT_SOUT )
+    set_subcategory( SUBCAT_SOUT_ACO )
+    add_shortcut( "fanout" )
+    set_callbacks( Open, Close )
+vlc_module_end ()
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+typedef struct
+{
+    sout_access_out_t *p_access;
+    bool               b_copy;   /* the access output modifies the data */
+    bool               b_dead;
+} fanout_output_t;
+
+struct sout_access_out_sys_t
+{
+    int                i_outputs;
+    fanout_output_t  **pp_outputs;
+};
+
+static ssize_t Write( sout_access_out_t *, block_t * );
+static int     Seek( sout_access_out_t *, off_t );
+static int     Control( sout_access_out_t *, int, va_list );
+
+/* Same as the core --sout-access-policy values */
+static const char *const ppsz_policies[] = { "block", "drop", "disconnect" };
+
+static bool IsPolicy( const char *psz )
+{
+    for( size_t i = 0; i < ARRAY_SIZE(ppsz_policies); i++ )
+        if( !strcmp( psz, ppsz_policies[i] ) )
+            return true;
+    return false;
+}
+
+static fanout_output_t *OutputNew( sout_access_out_t *p_access,
+                                   const config_chain_t *p_dst,
+                                   const char *psz_policy, int64_t i_queue )
+{
+    const char *psz_dst = p_dst->psz_value;
+    const char *psz_sep = strstr( psz_dst, "://" );
+    char *psz_access, *psz_path;
+
+    /* The options of this destination follow it */
+    var_SetString( p_access, "sout-access-policy", psz_policy ? psz_policy : "" );
+    var_SetInteger( p_access, "sout-access-queue-size", i_queue );
+
+    for( const config_chain_t *p_cfg = p_dst->p_next;
+         p_cfg && strcmp( p_cfg->psz_name, "dst" ); p_cfg = p_cfg->p_next )
+    {
+        long i_size;
+
+        if( !p_cfg->psz_value )
+            continue;
+        if( !strcmp( p_cfg->psz_name, "policy" ) && IsPolicy( p_cfg->psz_value ) )
+            var_SetString( p_access, "sout-access-policy", p_cfg->psz_value );
+        else if( !strcmp( p_cfg->psz_name, "queue-size" )
+              && (i_size = strtol( p_cfg->psz_value, NULL, 0 )) > 0 )
+            var_SetInteger( p_access, "sout-access-queue-size", i_size );
+        else
+            msg_Err( p_access, " * ignore option `%s=%s'",
+                     p_cfg->psz_name, p_cfg->psz_value );
+    }
+
+    if( psz_sep )
+    {
+        psz_access = strndup( psz_dst, psz_sep - psz_dst );
+        psz_path = strdup( psz_sep + 3 );
+    }
+    else
+    {
+        psz_access = strdup( "file" );
+        psz_path = strdup( psz_dst );
+    }
+
+    fanout_output_t *p_out = NULL;
+    if( unlikely(!psz_access || !psz_path) )
+        goto out;
+
+    p_out = calloc( 1, sizeof(*p_out) );
+    if( unlikely(!p_out) )
+        goto out;
+
+    p_out->p_access = sout_AccessOutNew( p_access, psz_access, psz_path );
+    if( !p_out->p_access )
+    {
+        msg_Err( p_access, "cannot create access output `%s'", psz_dst );
+        free( p_out );
+        p_out = NULL;
+        goto out;
+    }
+
+    /* The live HTTP output encrypts the segments in place */
+    p_out->b_copy = !strcmp( p_out->p_access->psz_access, "livehttp" );
+out:
+    free( psz_access );
+    free( psz_path );
+    return p_out;
+}
+
+/*****************************************************************************
+ * Open:
+ *****************************************************************************/
+static int Open( vlc_object_t *p_this )
+{
+    sout_access_out_t *p_access = (sout_access_out_t*)p_this;
+    sout_access_out_sys_t *p_sys = malloc( sizeof(*p_sys) );
+    if( unlikely(!p_sys) )
+        return VLC_ENOMEM;
+    TAB_INIT( p_sys->i_outputs, p_sys->pp_outputs );
+    p_access->p_sys = p_sys;
+
+    /* Each destination has its own queue and writer thread */
+    char *psz_policy = var_InheritString( p_access, "sout-access-policy" );
+    int64_t i_queue = var_InheritInteger( p_access, "sout-access-queue-size" );
+    var_Create( p_access, "sout-access-async", VLC_VAR_BOOL );
+    var_SetBool( p_access, "sout-access-async", true );
+    var_Create( p_access, "sout-access-policy", VLC_VAR_STRING );
+    var_Create( p_access, "sout-access-queue-size", VLC_VAR_INTEGER );
+
+    for( config_chain_t *p_cfg = p_access->p_cfg; p_cfg; p_cfg = p_cfg->p_next )
+    {
+        if( strcmp( p_cfg->psz_name, "dst" ) || !p_cfg->psz_value
+         || !*p_cfg->psz_value )
+            continue;
+
+        msg_Dbg( p_access, " * adding `%s'", p_cfg->psz_value );
+        fanout_output_t *p_out = OutputNew( p_access, p_cfg, psz_policy,
+                                            i_queue );
+        if( p_out )
+            TAB_APPEND( p_sys->i_outputs, p_sys->pp_outputs, p_out );
+    }
+
+    var_Destroy( p_access, "sout-access-queue-size" );
+    var_Destroy( p_access, "sout-access-policy" );
+    var_Destroy( p_access, "sout-access-async" );
+    free( psz_policy );
+
+    if( p_sys->i_outputs == 0 )
+    {
+        msg_Err( p_access, "no destination given" );
+        TAB_CLEAN( p_sys->i_outputs, p_sys->pp_outputs );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    p_access->pf_write = Write;
+    p_access->pf_seek = Seek;
+    p_access->pf_control = Control;
+
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Close:
+ *****************************************************************************/
+static void Close( vlc_object_t *p_this )
+{
+    sout_access_out_t *p_access = (sout_access_out_t*)p_this;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    for( int i = 0; i < p_sys->i_outputs; i++ )
+    {
+        sout_AccessOutDelete( p_sys->pp_outputs[i]->p_access );
+        free( p_sys->pp_outputs[i] );
+    }
+    TAB_CLEAN( p_sys->i_outputs, p_sys->pp_outputs );
+    free( p_sys );
+}
+
+/*****************************************************************************
+ * Write: hands a reference to the data over to each destination
+ *****************************************************************************/
+static void Send( sout_access_out_t *p_access, fanout_output_t *p_out,
+                  block_t *p_block )
+{
+    if( sout_AccessOutWrite( p_out->p_access, p_block ) < 0 )
+    {
+        msg_Warn( p_access, "`%s://%s' disconnected",
+                  p_out->p_access->psz_access, p_out->p_access->psz_path );
+        p_out->b_dead = true;
+    }
+}
+
+static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    size_t i_write = 0;
+
+    while( p_buffer )
+    {
+        block_t *p_next = p_buffer->p_next;
+        p_buffer->p_next = NULL;
+        i_write += p_buffer->i_buffer;
+
+        /* The destinations which modify the data get their own copies. The
+         * original block goes to the last live destination which does not,
+         * and the other ones get references to it. */
+        fanout_output_t *p_last = NULL;
+        for( int i = 0; i < p_sys->i_outputs; i++ )
+        {
+            fanout_output_t *p_out = p_sys->pp_outputs[i];
+            if( p_out->b_dead )
+                continue;
+            if( p_out->b_copy )
+            {
+                block_t *p_copy = block_Duplicate( p_buffer );
+                if( likely(p_copy) )
+                    Send( p_access, p_out, p_copy );
+                continue;
+            }
+            if( p_last )
+            {
+                block_t *p_ref = block_Share( &p_buffer );
+                if( likely(p_ref) )
+                    Send( p_access, p_last, p_ref );
+            }
+            p_last = p_out;
+        }
+
+        if( p_last )
+            Send( p_access, p_last, p_buffer );
+        else
+            block_Release( p_buffer );
+
+        p_buffer = p_next;
+    }
+
+    return i_write;
+}
+
+static int Seek( sout_access_out_t *p_access, off_t i_pos )
+{
+    (void) i_pos;
+    msg_Err( p_access, "cannot seek a fan-out" );
+    return VLC_EGENERIC;
+}
+
+static int Control( sout_access_out_t *p_access, int i_query, va_list args )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    switch( i_query )
+    {
+        case ACCESS_OUT_CONTROLS_PACE:
+        {
+            /* Pace the input only if all destinations can */
+            bool *pb = va_arg( args, bool * );
+            *pb = true;
+            for( int i = 0; i < p_sys->i_outputs; i++ )
+                if( !sout_AccessOutCanControlPace( p_sys->pp_outputs[i]->p_access ) )
+                    *pb = false;
+            break;
+        }
+
+        case ACCESS_OUT_CAN_SEEK:
+            *va_arg( args, bool * ) = false;
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
@@ -31,12 +31,16 @@
 #endif
 
 #include <assert.h>
+#include <limits.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_SYS_UIO_H
+#   include <sys/uio.h>
+#endif
 #ifdef __OS2__
 #   include <io.h>      /* setmode() */
 #endif
@@ -73,59 +77,70 @@ static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
     return val;
 }
 
+#if defined(IOV_MAX) && IOV_MAX < 64
+# define IOV_COUNT IOV_MAX
+#else
+# define IOV_COUNT 64
+#endif
+
 /*****************************************************************************
- * Write: standard write on a file descriptor.
+ * Gather: fills an I/O vector with the payload of a chain of blocks
  *****************************************************************************/
-static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+static int Gather(const block_t *block, struct iovec *iov)
 {
-    size_t i_write = 0;
+    int count = 0;
 
-    while( p_buffer )
+    for (; block != NULL && count < IOV_COUNT; block = block->p_next)
     {
-        ssize_t val = write ((intptr_t)p_access->p_sys,
-                             p_buffer->p_buffer, p_buffer->i_buffer);
-        if (val <= 0)
-        {
-            if (errno == EINTR)
-                continue;
-            block_ChainRelease (p_buffer);
-            msg_Err( p_access, "cannot write: %s", vlc_strerror_c(errno) );
-            return -1;
-        }
+        if (block->i_buffer == 0)
+            continue;
+        iov[count].iov_base = block->p_buffer;
+        iov[count].iov_len = block->i_buffer;
+        count++;
+    }
+    return count;
+}
 
-        if ((size_t)val >= p_buffer->i_buffer)
-        {
-            block_t *p_next = p_buffer->p_next;
-            block_Release (p_buffer);
-            p_buffer = p_next;
-        }
-        else
-        {
-            p_buffer->p_buffer += val;
-            p_buffer->i_buffer -= val;
-        }
-        i_write += val;
+/* Releases the written bytes from the head of a chain of blocks */
+static block_t *Consume(block_t *block, size_t len)
+{
+    while (block != NULL && len >= block->i_buffer)
+    {
+        block_t *next = block->p_next;
+
+        len -= block->i_buffer;
+        block_Release(block);
+        block = next;
+    }
+
+    if (block != NULL)
+    {
+        block->p_buffer += len;
+        block->i_buffer -= len;
     }
-    return i_write;
+    return block;
 }
 
-static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
+/*****************************************************************************
+ * Write: vectored write on a file descriptor.
+ *****************************************************************************/
+static ssize_t Write(sout_access_out_t *access, block_t *block)
 {
     int fd = (intptr_t)access->p_sys;
-    ssize_t total = 0;
+    size_t total = 0;
 
     while (block != NULL)
     {
-        if (block->i_buffer == 0)
-        {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
+        struct iovec iov[IOV_COUNT];
+        int count = Gather(block, iov);
+
+        if (count == 0)
+        {   /* only empty blocks left */
+            block_ChainRelease(block);
+            break;
         }
 
-        /* TODO: vectorized I/O with writev() */
-        ssize_t val = vlc_write(fd, block->p_buffer, block->i_buffer);
+        ssize_t val = vlc_writev(fd, iov, count);
         if (val < 0)
         {
             if (errno == EINTR)
@@ -133,15 +148,11 @@ static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
 
             block_ChainRelease(block);
             msg_Err(access, "cannot write: %s", vlc_strerror_c(errno));
-            total = -1;
-            break;
+            return -1;
         }
 
         total += val;
-
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
+        block = Consume(block, val);
     }
 
     return total;
@@ -155,18 +166,19 @@ static ssize_t Send(sout_access_out_t *access, block_t *block)
 
     while (block != NULL)
     {
-        if (block->i_buffer == 0)
-        {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
+        struct iovec iov[IOV_COUNT];
+        struct msghdr msg = { .msg_iov = iov };
+
+        msg.msg_iovlen = Gather(block, iov);
+        if (msg.msg_iovlen == 0)
+        {   /* only empty blocks left */
+            block_ChainRelease(block);
+            break;
         }
 
-        /* TODO: vectorized I/O with sendmsg() */
-        ssize_t val = send(fd, block->p_buffer, block->i_buffer, MSG_NOSIGNAL);
-        if (val <= 0)
-        {   /* FIXME: errno is meaningless if val is zero */
+        ssize_t val = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (val < 0)
+        {
             if (errno == EINTR)
                 continue;
             block_ChainRelease(block);
@@ -175,10 +187,7 @@ static ssize_t Send(sout_access_out_t *access, block_t *block)
         }
 
         total += val;
-
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
+        block = Consume(block, val);
     }
     return total;
 }
@@ -347,7 +356,7 @@ static int Open( vlc_object_t *p_this )
 #endif
     else
     {
-        p_access->pf_write = WritePipe;
+        p_access->pf_write = Write;
         p_access->pf_seek = NULL;
     }
     p_access->pf_control = Control;
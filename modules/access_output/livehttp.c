@@ -71,6 +71,11 @@ static void Close( vlc_object_t * );
 #define SPLITANYWHERE_LONGTEXT N_("Don't require a keyframe before splitting "\
                                 "a segment. Needed for audio only.")
 
+#define SPLICE_TEXT N_("Split segments on splice points")
+#define SPLICE_LONGTEXT N_("Start a new segment at each SCTE-35 splice point "\
+                           "signalled by the TS muxer, and mark it with "\
+                           "EXT-X-CUE-OUT/EXT-X-CUE-IN in the index.")
+
 #define NUMSEGS_TEXT N_("Number of segments")
 #define NUMSEGS_LONGTEXT N_("Number of segments to include in index")
 
@@ -117,6 +122,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "initial-segment-number", 1, INTITIAL_SEG_TEXT, INITIAL_SEG_LONGTEXT, false )
     add_bool( SOUT_CFG_PREFIX "splitanywhere", false,
               SPLITANYWHERE_TEXT, SPLITANYWHERE_LONGTEXT, true )
+    add_bool( SOUT_CFG_PREFIX "splice", false,
+              SPLICE_TEXT, SPLICE_LONGTEXT, true )
     add_bool( SOUT_CFG_PREFIX "delsegs", true,
               DELSEGS_TEXT, DELSEGS_LONGTEXT, true )
     add_bool( SOUT_CFG_PREFIX "ratecontrol", false,
@@ -145,6 +152,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "seglen",
     "splitanywhere",
+    "splice",
     "numsegs",
     "delsegs",
     "index",
@@ -170,6 +178,7 @@ typedef struct output_segment
     char *psz_duration;
     float f_seglength;
     uint32_t i_segment_number;
+    uint32_t i_splice; /* BLOCK_FLAG_SPLICE_* if it starts at a splice point */
     uint8_t aes_ivs[16];
 } output_segment_t;
 
@@ -196,6 +205,8 @@ struct sout_access_out_sys_t
     bool b_delsegs;
     bool b_ratecontrol;
     bool b_splitanywhere;
+    bool b_splice;
+    uint32_t i_splice; /* of the next segment */
     bool b_caching;
     bool b_generate_iv;
     bool b_segment_has_data;
@@ -245,6 +256,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_numsegs = var_GetInteger( p_access, SOUT_CFG_PREFIX "numsegs" );
     p_sys->i_initial_segment = var_GetInteger( p_access, SOUT_CFG_PREFIX "initial-segment-number" );
     p_sys->b_splitanywhere = var_GetBool( p_access, SOUT_CFG_PREFIX "splitanywhere" );
+    p_sys->b_splice = var_GetBool( p_access, SOUT_CFG_PREFIX "splice" );
     p_sys->b_delsegs = var_GetBool( p_access, SOUT_CFG_PREFIX "delsegs" );
     p_sys->b_ratecontrol = var_GetBool( p_access, SOUT_CFG_PREFIX "ratecontrol") ;
     p_sys->b_caching = var_GetBool( p_access, SOUT_CFG_PREFIX "caching") ;
@@ -646,6 +658,18 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                 }
             }
 
+            if( segment->i_splice )
+            {
+                if( fputs( segment->i_splice == BLOCK_FLAG_SPLICE_OUT ?
+                           "#EXT-X-CUE-OUT\n" : "#EXT-X-CUE-IN\n", fp ) < 0 )
+                {
+                    free( psz_current_uri );
+                    free( psz_idxTmp );
+                    fclose( fp );
+                    return -1;
+                }
+            }
+
             val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
             if ( val < 0 )
             {
@@ -896,6 +920,9 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
     }
     msg_Dbg( p_access, "Successfully opened livehttp file: %s (%"PRIu32")" , segment->psz_filename, i_newseg );
 
+    segment->i_splice = p_sys->i_splice;
+    p_sys->i_splice = 0;
+
     p_sys->psz_cursegPath = strdup(segment->psz_filename);
     p_sys->i_handle = fd;
     p_sys->i_segment = i_newseg;
@@ -911,7 +938,8 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
     ssize_t writevalue = 0;
 
     if( p_sys->i_handle > 0 && p_sys->b_segment_has_data &&
-       (( p_buffer->i_length + p_buffer->i_dts - p_sys->i_opendts ) >= p_sys->i_seglenm ) )
+       ( p_sys->i_splice ||
+        ( p_buffer->i_length + p_buffer->i_dts - p_sys->i_opendts ) >= p_sys->i_seglenm ) )
     {
         writevalue = writeSegment( p_access );
         if( unlikely( writevalue < 0 ) )
@@ -923,6 +951,16 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
         return writevalue;
     }
 
+    /* Nothing was written since the current segment was opened: it starts
+     * at the splice point, and no other segment must be started for it */
+    if( p_sys->i_splice && p_sys->i_handle >= 0 && !p_sys->b_segment_has_data )
+    {
+        output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t,
+                                        vlc_array_count( &p_sys->segments_t ) - 1 );
+        segment->i_splice = p_sys->i_splice;
+        p_sys->i_splice = 0;
+    }
+
     if ( unlikely( p_sys->i_handle < 0 ) )
     {
         p_sys->i_opendts = p_buffer->i_dts;
@@ -1040,6 +1078,14 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
             p_sys->b_segment_has_data = true;
         }
 
+        /* The muxer only flags splice points on headers */
+        if( p_sys->b_splice && ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) &&
+            ( p_buffer->i_flags & BLOCK_FLAG_SPLICE_MASK ) )
+        {
+            msg_Dbg( p_access, "Splice point, starting a new segment" );
+            p_sys->i_splice = p_buffer->i_flags & BLOCK_FLAG_SPLICE_MASK;
+        }
+
         ssize_t ret = CheckSegmentChange( p_access, p_buffer );
         if( ret < 0 )
         {
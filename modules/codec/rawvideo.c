@@ -32,6 +32,8 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 
+#include "../video_chroma/v210.h"
+
 /*****************************************************************************
  * decoder_sys_t : raw video decoder descriptor
  *****************************************************************************/
@@ -43,6 +45,7 @@ struct decoder_sys_t
     size_t size;
     unsigned pitches[PICTURE_PLANE_MAX];
     unsigned lines[PICTURE_PLANE_MAX];
+    bool v210; /* packed, unpacked to I422_10L by the decoder */
 
     /*
      * Common properties
@@ -78,9 +81,10 @@ vlc_module_end ()
  */
 static int OpenCommon( decoder_t *p_dec )
 {
+    const bool v210 = p_dec->fmt_in.i_codec == VLC_CODEC_V210;
     const vlc_chroma_description_t *dsc =
         vlc_fourcc_GetChromaDescription( p_dec->fmt_in.i_codec );
-    if( dsc == NULL || dsc->plane_count == 0 )
+    if( !v210 && ( dsc == NULL || dsc->plane_count == 0 ) )
         return VLC_EGENERIC;
 
     if( p_dec->fmt_in.video.i_width <= 0 || p_dec->fmt_in.video.i_height == 0 )
@@ -114,6 +118,14 @@ static int OpenCommon( decoder_t *p_dec )
         date_Init( &p_sys->pts, p_dec->fmt_out.video.i_frame_rate,
                     p_dec->fmt_out.video.i_frame_rate_base );
 
+    p_sys->v210 = v210;
+    if( v210 )
+    {
+        p_sys->pitches[0] = v210_LineSize( p_dec->fmt_in.video.i_width );
+        p_sys->lines[0] = p_dec->fmt_in.video.i_height;
+        p_sys->size = p_sys->pitches[0] * p_sys->lines[0];
+    }
+    else
     for( unsigned i = 0; i < dsc->plane_count; i++ )
     {
         unsigned pitch = p_dec->fmt_in.video.i_width * dsc->pixel_size
@@ -201,6 +213,20 @@ static void FillPicture( decoder_t *p_dec, block_t *p_block, picture_t *p_pic )
     decoder_sys_t *p_sys = p_dec->p_sys;
     const uint8_t *p_src = p_block->p_buffer;
 
+    if( p_sys->v210 )
+    {
+        for( int y = 0; y < p_pic->p[0].i_visible_lines; y++ )
+        {
+            v210_UnpackPlanar(
+                (uint16_t *)&p_pic->p[0].p_pixels[y * p_pic->p[0].i_pitch],
+                (uint16_t *)&p_pic->p[1].p_pixels[y * p_pic->p[1].i_pitch],
+                (uint16_t *)&p_pic->p[2].p_pixels[y * p_pic->p[2].i_pitch],
+                p_src, p_dec->fmt_in.video.i_width );
+            p_src += p_sys->pitches[0];
+        }
+        return;
+    }
+
     for( int i = 0; i < p_pic->i_planes; i++ )
     {
         uint8_t *p_dst = p_pic->p[i].p_pixels;
@@ -271,6 +297,9 @@ static int OpenDecoder( vlc_object_t *p_this )
     int ret = OpenCommon( p_dec );
     if( ret == VLC_SUCCESS )
     {
+        if( p_dec->p_sys->v210 )
+            p_dec->fmt_out.i_codec =
+            p_dec->fmt_out.video.i_chroma = VLC_CODEC_I422_10L;
         p_dec->pf_decode = DecodeFrame;
         p_dec->pf_flush  = Flush;
     }
@@ -0,0 +1,288 @@
+/*****************************************************************************
+ * scte35.h : SCTE-35 splice information helpers
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+#ifndef VLC_SCTE35_H
+#define VLC_SCTE35_H
+
+/* The VLC_CODEC_SCTE_35 blocks carry one complete splice_info_section.
+ * Their dts is the reception date, and their pts the splice date (equal to
+ * the dts for immediate splices). */
+
+#define SCTE35_TABLE_ID     0xFC
+#define SCTE35_STREAM_TYPE  0x86
+
+#define SCTE35_SPLICE_INSERT 0x05
+#define SCTE35_TIME_SIGNAL   0x06
+
+enum
+{
+    SCTE35_SPLICE_NONE = 0,
+    SCTE35_SPLICE_OUT, /* out of the network, i.e. start of a break */
+    SCTE35_SPLICE_IN,  /* back to the network */
+};
+
+typedef struct
+{
+    int      i_type;       /* SCTE35_SPLICE_* */
+    uint8_t  i_command;    /* splice_command_type */
+    uint32_t i_event_id;
+    bool     b_immediate;
+    int64_t  i_pts;        /* 90 kHz, pts_adjustment applied, -1 if immediate */
+    int64_t  i_duration;   /* 90 kHz, -1 if unknown */
+} scte35_splice_t;
+
+static inline int64_t scte35_get_33bits( const uint8_t *p )
+{
+    return ((int64_t)(p[0] & 0x01) << 32) | GetDWBE( &p[1] );
+}
+
+static inline void scte35_set_33bits( uint8_t *p, int64_t i_value )
+{
+    p[0] = (p[0] & 0xfe) | ((i_value >> 32) & 0x01);
+    SetDWBE( &p[1], i_value & 0xffffffff );
+}
+
+/* Parses a splice_time(), returns its size or 0 on error */
+static inline size_t scte35_parse_splice_time( const uint8_t *p, size_t i_buffer,
+                                              int64_t *pi_pts )
+{
+    if( i_buffer < 1 )
+        return 0;
+    *pi_pts = -1;
+    if( !(p[0] & 0x80) ) /* time_specified_flag */
+        return 1;
+    if( i_buffer < 5 )
+        return 0;
+    *pi_pts = scte35_get_33bits( p );
+    return 5;
+}
+
+static inline void scte35_parse_splice_insert( const uint8_t *p, size_t i_buffer,
+                                               scte35_splice_t *p_splice )
+{
+    if( i_buffer < 6 )
+        return;
+    p_splice->i_event_id = GetDWBE( p );
+    if( p[4] & 0x80 ) /* splice_event_cancel_indicator */
+        return;
+
+    const bool b_out = p[5] & 0x80;
+    const bool b_program = p[5] & 0x40;
+    const bool b_duration = p[5] & 0x20;
+    p_splice->b_immediate = p[5] & 0x10;
+    p += 6; i_buffer -= 6;
+
+    if( b_program )
+    {
+        if( !p_splice->b_immediate )
+        {
+            size_t i_size = scte35_parse_splice_time( p, i_buffer, &p_splice->i_pts );
+            if( !i_size )
+                return;
+            p += i_size; i_buffer -= i_size;
+        }
+    }
+    else
+    {
+        /* Use the first component splice time */
+        if( i_buffer < 1 )
+            return;
+        unsigned i_count = p[0];
+        p++; i_buffer--;
+        for( unsigned i = 0; i < i_count; i++ )
+        {
+            if( i_buffer < 1 )
+                return;
+            p++; i_buffer--; /* component_tag */
+            if( !p_splice->b_immediate )
+            {
+                int64_t i_pts;
+                size_t i_size = scte35_parse_splice_time( p, i_buffer, &i_pts );
+                if( !i_size )
+                    return;
+                if( i == 0 )
+                    p_splice->i_pts = i_pts;
+                p += i_size; i_buffer -= i_size;
+            }
+        }
+    }
+
+    if( b_duration && i_buffer >= 5 ) /* break_duration() */
+        p_splice->i_duration = scte35_get_33bits( p );
+
+    if( !p_splice->b_immediate && p_splice->i_pts < 0 )
+        return;
+    p_splice->i_type = b_out ? SCTE35_SPLICE_OUT : SCTE35_SPLICE_IN;
+}
+
+/* Only the segmentation types of breaks and advertisements are splice
+ * points: the starts have even values, and the ends the next odd value */
+static inline int scte35_segmentation_type( uint8_t i_type_id )
+{
+    if( i_type_id == 0x22 || i_type_id == 0x23 ||
+        (i_type_id >= 0x30 && i_type_id <= 0x37) )
+        return (i_type_id & 1) ? SCTE35_SPLICE_IN : SCTE35_SPLICE_OUT;
+    return SCTE35_SPLICE_NONE;
+}
+
+static inline void scte35_parse_segmentation( const uint8_t *p, size_t i_buffer,
+                                              scte35_splice_t *p_splice )
+{
+    /* identifier, segmentation_event_id, cancel indicator and flags */
+    if( i_buffer < 10 || memcmp( p, "CUEI", 4 ) )
+        return;
+    p_splice->i_event_id = GetDWBE( &p[4] );
+    if( p[8] & 0x80 )
+        return;
+
+    const bool b_program = p[9] & 0x80;
+    const bool b_duration = p[9] & 0x40;
+    size_t i_offset = 10;
+    if( !b_program )
+    {
+        if( i_offset >= i_buffer )
+            return;
+        i_offset += 1 + 6 * p[i_offset];
+    }
+    if( b_duration )
+    {
+        if( i_offset + 5 > i_buffer )
+            return;
+        p_splice->i_duration = ((int64_t)p[i_offset] << 32) |
+                               GetDWBE( &p[i_offset + 1] );
+        i_offset += 5;
+    }
+    /* segmentation_upid */
+    if( i_offset + 2 > i_buffer )
+        return;
+    i_offset += 2 + p[i_offset + 1];
+    if( i_offset >= i_buffer )
+        return;
+    p_splice->i_type = scte35_segmentation_type( p[i_offset] );
+}
+
+/* Parses a complete splice_info_section. Returns true if it describes a
+ * splice point, i.e. a splice_insert or a time_signal with a break or
+ * advertisement segmentation descriptor. */
+static inline bool scte35_Parse( const uint8_t *p_buffer, size_t i_buffer,
+                                 scte35_splice_t *p_splice )
+{
+    p_splice->i_type = SCTE35_SPLICE_NONE;
+    p_splice->i_command = 0;
+    p_splice->i_event_id = 0;
+    p_splice->b_immediate = false;
+    p_splice->i_pts = -1;
+    p_splice->i_duration = -1;
+
+    if( i_buffer < 18 || p_buffer[0] != SCTE35_TABLE_ID )
+        return false;
+
+    size_t i_section = 3 + (((p_buffer[1] & 0x0f) << 8) | p_buffer[2]);
+    if( i_section > i_buffer || i_section < 18 )
+        return false;
+    i_buffer = i_section - 4; /* CRC */
+
+    if( p_buffer[3] != 0 || (p_buffer[4] & 0x80) ) /* version, encrypted */
+        return false;
+
+    const int64_t i_adjustment = scte35_get_33bits( &p_buffer[4] );
+    size_t i_command = ((p_buffer[11] & 0x0f) << 8) | p_buffer[12];
+    p_splice->i_command = p_buffer[13];
+
+    const uint8_t *p = &p_buffer[14];
+    size_t i_left = i_buffer - 14;
+    const bool b_legacy = i_command == 0xfff; /* unspecified length */
+    if( b_legacy )
+        i_command = i_left;
+    if( i_command > i_left )
+        return false;
+
+    switch( p_splice->i_command )
+    {
+        case SCTE35_SPLICE_INSERT:
+            scte35_parse_splice_insert( p, i_command, p_splice );
+            break;
+
+        case SCTE35_TIME_SIGNAL:
+        {
+            size_t i_time = scte35_parse_splice_time( p, i_command, &p_splice->i_pts );
+            if( !i_time || p_splice->i_pts < 0 )
+                return false;
+            if( b_legacy )
+                i_command = i_time;
+
+            const uint8_t *p_desc = p + i_command;
+            size_t i_desc = i_left - i_command;
+            if( i_desc < 2 )
+                return false;
+            size_t i_loop = GetWBE( p_desc );
+            p_desc += 2; i_desc -= 2;
+            if( i_loop < i_desc )
+                i_desc = i_loop;
+
+            while( i_desc >= 2 && p_splice->i_type == SCTE35_SPLICE_NONE )
+            {
+                size_t i_length = p_desc[1];
+                if( 2 + i_length > i_desc )
+                    break;
+                if( p_desc[0] == 0x02 ) /* segmentation_descriptor */
+                    scte35_parse_segmentation( &p_desc[2], i_length, p_splice );
+                p_desc += 2 + i_length; i_desc -= 2 + i_length;
+            }
+            break;
+        }
+
+        default:
+            return false;
+    }
+
+    if( p_splice->i_pts >= 0 )
+        p_splice->i_pts = (p_splice->i_pts + i_adjustment) & 0x1FFFFFFFF;
+
+    return p_splice->i_type != SCTE35_SPLICE_NONE;
+}
+
+static inline uint32_t scte35_crc32( const uint8_t *p, size_t i_buffer )
+{
+    uint32_t i_crc = 0xffffffff;
+    for( size_t i = 0; i < i_buffer; i++ )
+    {
+        i_crc ^= (uint32_t)p[i] << 24;
+        for( int j = 0; j < 8; j++ )
+            i_crc = (i_crc & 0x80000000) ? (i_crc << 1) ^ 0x04c11db7 : i_crc << 1;
+    }
+    return i_crc;
+}
+
+/* Rewrites the pts_adjustment of a non encrypted section, e.g. when
+ * remuxing with another time base, and updates its CRC */
+static inline bool scte35_SetPTSAdjustment( uint8_t *p_buffer, size_t i_buffer,
+                                            int64_t i_adjustment )
+{
+    if( i_buffer < 18 || p_buffer[0] != SCTE35_TABLE_ID || (p_buffer[4] & 0x80) )
+        return false;
+    size_t i_section = 3 + (((p_buffer[1] & 0x0f) << 8) | p_buffer[2]);
+    if( i_section > i_buffer || i_section < 18 )
+        return false;
+
+    scte35_set_33bits( &p_buffer[4], i_adjustment & 0x1FFFFFFFF );
+    SetDWBE( &p_buffer[i_section - 4], scte35_crc32( p_buffer, i_section - 4 ) );
+    return true;
+}
+
+#endif
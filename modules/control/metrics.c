@@ -0,0 +1,478 @@
+/*****************************************************************************
+ * metrics.c: Prometheus statistics exporter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stddef.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_interface.h>
+#include <vlc_input.h>
+#include <vlc_demux.h>
+#include <vlc_playlist.h>
+#include <vlc_httpd.h>
+#include <vlc_memstream.h>
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+static int  Open (vlc_object_t *);
+static void Close(vlc_object_t *);
+
+#define URL_TEXT N_("Metrics URL")
+#define URL_LONGTEXT N_("Path under which the statistics are served, " \
+  "in the Prometheus text format, by the HTTP server (see --http-host " \
+  "and --http-port).")
+
+vlc_module_begin()
+    set_shortname(N_("Metrics"))
+    set_description(N_("Prometheus statistics exporter"))
+    set_category(CAT_INTERFACE)
+    set_subcategory(SUBCAT_INTERFACE_CONTROL)
+
+    add_string("metrics-url", "/metrics", URL_TEXT, URL_LONGTEXT, true)
+
+    set_capability("interface", 0)
+    set_callbacks(Open, Close)
+vlc_module_end()
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+struct intf_sys_t
+{
+    httpd_host_t *host;
+    httpd_file_t *file;
+};
+
+enum metric_type
+{
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_RATE, /* stats_GetRate() value, in units per microsecond */
+};
+
+static const struct
+{
+    const char *name;
+    const char *help;
+    enum metric_type type;
+    size_t offset;
+    float scale; /* for rates only */
+} metrics[] = {
+#define COUNTER(n, h, f) { n, h, METRIC_COUNTER, offsetof(input_stats_t, f), 0 }
+#define GAUGE(n, h, f) { n, h, METRIC_GAUGE, offsetof(input_stats_t, f), 0 }
+#define RATE(n, h, f, s) { n, h, METRIC_RATE, offsetof(input_stats_t, f), s }
+    COUNTER("vlc_input_read_packets_total", "Packets read by the access",
+            i_read_packets),
+    COUNTER("vlc_input_read_bytes_total", "Bytes read by the access",
+            i_read_bytes),
+    RATE("vlc_input_bitrate_bits", "Access input bitrate in bits per second",
+         f_input_bitrate, 8e6f),
+    COUNTER("vlc_demux_read_bytes_total", "Bytes sent by the demuxer",
+            i_demux_read_bytes),
+    RATE("vlc_demux_bitrate_bits", "Demuxed bitrate in bits per second",
+         f_demux_bitrate, 8e6f),
+    COUNTER("vlc_demux_corrupted_total", "Corrupted blocks sent by the demuxer",
+            i_demux_corrupted),
+    COUNTER("vlc_demux_discontinuities_total",
+            "Discontinuities (such as continuity counter errors) detected by "
+            "the demuxer", i_demux_discontinuity),
+    GAUGE("vlc_clock_jitter_microseconds",
+          "Estimated reception jitter of the program clock", i_clock_jitter),
+    RATE("vlc_clock_drift_ppb",
+         "Drift of the program clock in parts per billion (with --clock-pll)",
+         f_clock_drift, 1e3f),
+    COUNTER("vlc_decoded_video_total", "Decoded video blocks",
+            i_decoded_video),
+    COUNTER("vlc_decoded_audio_total", "Decoded audio blocks",
+            i_decoded_audio),
+    COUNTER("vlc_displayed_pictures_total", "Displayed pictures",
+            i_displayed_pictures),
+    COUNTER("vlc_lost_pictures_total", "Late or dropped pictures",
+            i_lost_pictures),
+    COUNTER("vlc_played_audio_buffers_total", "Played audio buffers",
+            i_played_abuffers),
+    COUNTER("vlc_lost_audio_buffers_total", "Lost audio buffers",
+            i_lost_abuffers),
+    COUNTER("vlc_sout_sent_packets_total", "Packets sent by the stream output",
+            i_sent_packets),
+    COUNTER("vlc_sout_sent_bytes_total", "Bytes sent by the stream output",
+            i_sent_bytes),
+    RATE("vlc_sout_bitrate_bits", "Stream output bitrate in bits per second",
+         f_send_bitrate, 8e6f),
+    GAUGE("vlc_sout_queue_bytes",
+          "Bytes queued by the asynchronous access outputs",
+          i_sout_queue_depth),
+    GAUGE("vlc_sout_queue_max_bytes",
+          "Most bytes queued by one asynchronous access output",
+          i_sout_queue_max),
+    COUNTER("vlc_sout_queue_dropped_total",
+            "Writes dropped by the asynchronous access outputs",
+            i_sout_queue_dropped),
+#undef RATE
+#undef GAUGE
+#undef COUNTER
+};
+
+/* ETR 290 indicators, in enum demux_etr290_indicator order */
+static const char *const etr290_names[DEMUX_ETR290_COUNT] = {
+    "ts_sync_loss", "sync_byte_error", "pat_error", "cc_error", "pmt_error",
+    "pid_error", "transport_error", "crc_error", "pcr_repetition_error",
+    "pcr_discontinuity_error", "pcr_accuracy_error", "pts_error", "cat_error",
+};
+
+struct input_snapshot
+{
+    char *name;
+    int id; /* playlist item, as several items can have the same URI */
+    bool active;
+    double values[ARRAY_SIZE(metrics)];
+    bool has_ts;
+    demux_ts_stats_t ts; /* transport stream demuxer measurements */
+};
+
+/* Copies the counters, which must be locked */
+static void CopyCounters(struct input_snapshot *snap,
+                         const input_stats_t *stats)
+{
+    snap->has_ts = false;
+    if (stats->p_ts != NULL)
+    {
+        snap->ts = *stats->p_ts;
+        snap->ts.p_pids = vlc_alloc(snap->ts.i_pids, sizeof (*snap->ts.p_pids));
+        if (snap->ts.p_pids != NULL || snap->ts.i_pids == 0)
+        {
+            if (snap->ts.i_pids > 0)
+                memcpy(snap->ts.p_pids, stats->p_ts->p_pids,
+                       snap->ts.i_pids * sizeof (*snap->ts.p_pids));
+            snap->has_ts = true;
+        }
+    }
+
+    for (size_t m = 0; m < ARRAY_SIZE(metrics); m++)
+    {
+        const char *field = (const char *)stats + metrics[m].offset;
+
+        if (metrics[m].type == METRIC_RATE)
+            snap->values[m] = *(const float *)field * metrics[m].scale;
+        else
+            snap->values[m] = *(const int64_t *)field;
+    }
+}
+
+/* Prints the input labels, leaving the label set open for more */
+static void PrintLabel(struct vlc_memstream *ms,
+                       const struct input_snapshot *snap)
+{
+    vlc_memstream_printf(ms, "{id=\"%d\",input=\"", snap->id);
+    for (const char *p = snap->name; *p; p++)
+        switch (*p)
+        {
+            case '\\': vlc_memstream_puts(ms, "\\\\"); break;
+            case '"':  vlc_memstream_puts(ms, "\\\""); break;
+            case '\n': vlc_memstream_puts(ms, "\\n");  break;
+            default:   vlc_memstream_putc(ms, *p);     break;
+        }
+    vlc_memstream_putc(ms, '"');
+}
+
+static void PrintETR290(struct vlc_memstream *ms,
+                        const struct input_snapshot *snap, const char *pid,
+                        int program, const demux_etr290_counter_t *counters,
+                        bool all)
+{
+    for (int i = 0; i < DEMUX_ETR290_COUNT; i++)
+    {
+        if (!all && counters[i].i_count == 0)
+            continue;
+        vlc_memstream_puts(ms, "vlc_ts_etr290_errors_total");
+        PrintLabel(ms, snap);
+        vlc_memstream_printf(ms, ",pid=\"%s\",program=\"%d\","
+                             "indicator=\"%s\"} %"PRIu64"\n", pid, program,
+                             etr290_names[i], counters[i].i_count);
+    }
+}
+
+/* PES header analysis of each elementary stream (with --ts-pes-analysis) */
+static const struct
+{
+    const char *name;
+    const char *help;
+    enum metric_type type;
+    size_t offset;
+    unsigned size;
+} ts_metrics[] = {
+#define TS_METRIC(n, h, t, f) \
+    { n, h, t, offsetof(demux_ts_pid_stats_t, f), \
+      sizeof (((demux_ts_pid_stats_t *)0)->f) }
+    TS_METRIC("vlc_ts_pid_packets_total", "Packets of the elementary stream",
+              METRIC_COUNTER, i_packets),
+    TS_METRIC("vlc_ts_pid_scrambled_packets_total",
+              "Scrambled packets of the elementary stream", METRIC_COUNTER,
+              i_scrambled),
+    TS_METRIC("vlc_ts_pid_pes_total", "PES packets of the elementary stream",
+              METRIC_COUNTER, i_pes),
+    TS_METRIC("vlc_ts_pid_cc_errors_total",
+              "Continuity counter errors of the elementary stream",
+              METRIC_COUNTER, i_cc_errors),
+    TS_METRIC("vlc_ts_pid_bitrate_bits",
+              "Bitrate of the elementary stream over the last second of "
+              "stream", METRIC_GAUGE, i_bitrate),
+#undef TS_METRIC
+};
+
+static void PrintPIDLabel(struct vlc_memstream *ms,
+                          const struct input_snapshot *snap,
+                          const demux_ts_pid_stats_t *pid)
+{
+    PrintLabel(ms, snap);
+    vlc_memstream_printf(ms, ",pid=\"%"PRIu16"\",program=\"%d\"",
+                         pid->i_pid, pid->i_program);
+}
+
+static void PrintTS(struct vlc_memstream *ms,
+                    const struct input_snapshot *snaps, size_t count)
+{
+    for (size_t m = 0; m < ARRAY_SIZE(ts_metrics); m++)
+    {
+        vlc_memstream_printf(ms, "# HELP %s %s\n# TYPE %s %s\n",
+                             ts_metrics[m].name, ts_metrics[m].help,
+                             ts_metrics[m].name,
+                             ts_metrics[m].type == METRIC_COUNTER ? "counter"
+                                                                  : "gauge");
+
+        for (size_t i = 0; i < count; i++)
+            for (size_t j = 0; snaps[i].has_ts && j < snaps[i].ts.i_pids; j++)
+            {
+                const demux_ts_pid_stats_t *pid = &snaps[i].ts.p_pids[j];
+                const char *field = (const char *)pid + ts_metrics[m].offset;
+
+                if (!pid->b_analysis)
+                    continue;
+                vlc_memstream_puts(ms, ts_metrics[m].name);
+                PrintPIDLabel(ms, &snaps[i], pid);
+                if (ts_metrics[m].size == sizeof (uint64_t))
+                    vlc_memstream_printf(ms, "} %"PRIu64"\n",
+                                         *(const uint64_t *)field);
+                else
+                    vlc_memstream_printf(ms, "} %"PRIu32"\n",
+                                         *(const uint32_t *)field);
+            }
+    }
+
+    vlc_memstream_puts(ms, "# HELP vlc_ts_pid_pcr_offset_seconds Last PTS "
+                           "minus the program clock of the elementary "
+                           "stream\n"
+                           "# TYPE vlc_ts_pid_pcr_offset_seconds gauge\n");
+    for (size_t i = 0; i < count; i++)
+        for (size_t j = 0; snaps[i].has_ts && j < snaps[i].ts.i_pids; j++)
+        {
+            const demux_ts_pid_stats_t *pid = &snaps[i].ts.p_pids[j];
+
+            if (!pid->b_analysis || !pid->b_pcr_offset)
+                continue;
+            vlc_memstream_puts(ms, "vlc_ts_pid_pcr_offset_seconds");
+            PrintPIDLabel(ms, &snaps[i], pid);
+            vlc_memstream_printf(ms, "} %.6f\n", pid->i_pcr_offset / 90000.);
+        }
+
+    vlc_memstream_puts(ms, "# HELP vlc_ts_etr290_errors_total ETR 290 first "
+                           "and second priority errors, for the whole "
+                           "stream (pid \"all\") and per PID (with "
+                           "--ts-etr290)\n"
+                           "# TYPE vlc_ts_etr290_errors_total counter\n");
+    for (size_t i = 0; i < count; i++)
+    {
+        const demux_ts_stats_t *ts = &snaps[i].ts;
+
+        if (!snaps[i].has_ts || !ts->b_etr290)
+            continue;
+        PrintETR290(ms, &snaps[i], "all", -1, ts->etr290, true);
+        for (size_t j = 0; j < ts->i_pids; j++)
+        {
+            char pid[6];
+
+            if (!ts->p_pids[j].b_etr290)
+                continue;
+            snprintf(pid, sizeof (pid), "%"PRIu16, ts->p_pids[j].i_pid);
+            PrintETR290(ms, &snaps[i], pid, ts->p_pids[j].i_program,
+                        ts->p_pids[j].etr290, false);
+        }
+    }
+}
+
+/**
+ * Copies the statistics of all the playlist items which have been played,
+ * so that the playlist lock is not held while formatting.
+ */
+static size_t TakeSnapshots(playlist_t *pl, struct input_snapshot **out)
+{
+    struct input_snapshot *snaps = NULL;
+    size_t count = 0;
+
+    playlist_Lock(pl);
+
+    playlist_item_t *current = playlist_CurrentPlayingItem(pl);
+    if (pl->items.i_size > 0)
+        snaps = vlc_alloc(pl->items.i_size, sizeof (*snaps));
+
+    for (int i = 0; snaps != NULL && i < pl->items.i_size; i++)
+    {
+        playlist_item_t *item = ARRAY_VAL(pl->items, i);
+        input_item_t *input = item->p_input;
+        input_stats_t *stats = input->p_stats;
+
+        if (stats == NULL)
+            continue;
+
+        struct input_snapshot *snap = &snaps[count];
+        snap->name = input_item_GetURI(input);
+        if (snap->name == NULL)
+            continue;
+        snap->id = item->i_id;
+        snap->active = item == current;
+
+        vlc_mutex_lock(&stats->lock);
+        CopyCounters(snap, stats);
+        vlc_mutex_unlock(&stats->lock);
+        count++;
+    }
+
+    playlist_Unlock(pl);
+
+    *out = snaps;
+    return count;
+}
+
+static int Fill(httpd_file_sys_t *data, httpd_file_t *file,
+                uint8_t *request, uint8_t **pp_data, int *pi_data)
+{
+    intf_thread_t *intf = (intf_thread_t *)data;
+    struct input_snapshot *snaps;
+    struct vlc_memstream ms;
+
+    (void) file; (void) request;
+
+    size_t count = TakeSnapshots(pl_Get(intf), &snaps);
+
+    vlc_memstream_open(&ms);
+
+    vlc_memstream_puts(&ms, "# HELP vlc_input_active Whether the input is "
+                            "being played\n# TYPE vlc_input_active gauge\n");
+    for (size_t i = 0; i < count; i++)
+    {
+        vlc_memstream_puts(&ms, "vlc_input_active");
+        PrintLabel(&ms, &snaps[i]);
+        vlc_memstream_printf(&ms, "} %d\n", snaps[i].active);
+    }
+
+    for (size_t m = 0; m < ARRAY_SIZE(metrics); m++)
+    {
+        vlc_memstream_printf(&ms, "# HELP %s %s\n# TYPE %s %s\n",
+                             metrics[m].name, metrics[m].help, metrics[m].name,
+                             metrics[m].type == METRIC_COUNTER ? "counter"
+                                                               : "gauge");
+
+        for (size_t i = 0; i < count; i++)
+        {
+            vlc_memstream_puts(&ms, metrics[m].name);
+            PrintLabel(&ms, &snaps[i]);
+            vlc_memstream_printf(&ms, "} %.0f\n", snaps[i].values[m]);
+        }
+    }
+
+    PrintTS(&ms, snaps, count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        free(snaps[i].name);
+        if (snaps[i].has_ts)
+            free(snaps[i].ts.p_pids);
+    }
+    free(snaps);
+
+    if (vlc_memstream_close(&ms))
+    {
+        *pp_data = NULL;
+        *pi_data = 0;
+        return VLC_ENOMEM;
+    }
+
+    *pp_data = (uint8_t *)ms.ptr;
+    *pi_data = ms.length;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Open: initialize interface
+ *****************************************************************************/
+static int Open(vlc_object_t *object)
+{
+    intf_thread_t *intf = (intf_thread_t *)object;
+
+    if (!var_InheritBool(intf, "stats"))
+        msg_Warn(intf, "statistics are disabled (see --stats)");
+
+    intf_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->host = vlc_http_HostNew(object);
+    if (sys->host == NULL)
+    {
+        free(sys);
+        return VLC_EGENERIC;
+    }
+
+    char *url = var_InheritString(intf, "metrics-url");
+    sys->file = httpd_FileNew(sys->host, url ? url : "/metrics",
+                              "text/plain; version=0.0.4", NULL, NULL, Fill,
+                              (httpd_file_sys_t *)intf);
+    free(url);
+    if (sys->file == NULL)
+    {
+        httpd_HostDelete(sys->host);
+        free(sys);
+        return VLC_EGENERIC;
+    }
+
+    intf->p_sys = sys;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Close: destroy interface
+ *****************************************************************************/
+static void Close(vlc_object_t *object)
+{
+    intf_thread_t *intf = (intf_thread_t *)object;
+    intf_sys_t *sys = intf->p_sys;
+
+    httpd_FileDelete(sys->file);
+    httpd_HostDelete(sys->host);
+    free(sys);
+}
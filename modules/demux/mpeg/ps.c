@@ -35,6 +35,7 @@
 
 #include "pes.h"
 #include "ps.h"
+#include "../../packetizer/startcode_helper.h"
 
 /* TODO:
  *  - re-add pre-scanning.
@@ -829,8 +830,18 @@ static int ps_pkt_resynch( stream_t *s, int format, bool b_pack )
             }
         }
 
-        if( p_peek[0] == 0 && p_peek[1] == 0 && p_peek[2] == 1 &&
-            p_peek[3] >= PS_STREAM_ID_END_STREAM &&
+        /* Jump to the next start code candidate */
+        const uint8_t *p_sync = startcode_FindAnnexB( p_peek, &p_peek[i_peek] );
+        if( p_sync == NULL )
+        {
+            i_skip += i_peek - 3;
+            break;
+        }
+        i_peek -= p_sync - p_peek;
+        i_skip += p_sync - p_peek;
+        p_peek = p_sync;
+
+        if( p_peek[3] >= PS_STREAM_ID_END_STREAM &&
             ( !b_pack || p_peek[3] == PS_STREAM_ID_PACK_HEADER ) )
         {
             return vlc_stream_Read( s, NULL, i_skip ) == i_skip ? 1 : -1;
@@ -44,6 +44,7 @@
 #include "ts_psip.h"
 
 #include "ts_hotfixes.h"
+#include "ts_etr290.h"
 #include "ts_sl.h"
 #include "ts_metadata.h"
 #include "sections.h"
@@ -53,6 +54,7 @@
 #include "ts.h"
 
 #include "../../codec/scte18.h"
+#include "../../packetizer/startcode_helper.h"
 #include "../opus.h"
 #include "../../mux/mpeg/csa.h"
 
@@ -118,6 +120,21 @@ static void Close ( vlc_object_t * );
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
+#define ANALYSIS_TEXT N_("PES header analysis")
+#define ANALYSIS_LONGTEXT N_("Also receive the unselected elementary streams, " \
+    "but only parse their PES headers instead of gathering their payload. " \
+    "The bitrate, continuity errors and PTS to PCR offset of each PID are " \
+    "reported in the input statistics.")
+
+#define ANALYSIS_INFO_TEXT N_("Analysis in the media information")
+#define ANALYSIS_INFO_LONGTEXT N_("Also publish the PES header analysis " \
+    "and the ETR 290 counters in the media information, every second.")
+
+#define ETR290_TEXT N_("ETR 290 monitoring")
+#define ETR290_LONGTEXT N_("Measure the ETR 290 first and second priority " \
+    "indicators, per PID and for the whole stream. This implies the PES " \
+    "header analysis. The counters are reported in the input statistics.")
+
 static const char *const ts_standards_list[] =
     { "auto", "mpeg", "dvb", "arib", "atsc", "tdmb" };
 static const char *const ts_standards_list_text[] =
@@ -153,6 +170,10 @@ vlc_module_begin ()
     add_bool( "ts-split-es", true, SPLIT_ES_TEXT, SPLIT_ES_LONGTEXT, false )
     add_bool( "ts-seek-percent", false, SEEK_PERCENT_TEXT, SEEK_PERCENT_LONGTEXT, true )
     add_bool( "ts-cc-check", true, CC_CHECK_TEXT, CC_CHECK_LONGTEXT, true )
+    add_bool( "ts-pes-analysis", false, ANALYSIS_TEXT, ANALYSIS_LONGTEXT, true )
+    add_bool( "ts-etr290", false, ETR290_TEXT, ETR290_LONGTEXT, true )
+    add_bool( "ts-analysis-info", false, ANALYSIS_INFO_TEXT,
+              ANALYSIS_INFO_LONGTEXT, true )
 
     add_obsolete_bool( "ts-silent" );
 
@@ -186,10 +207,16 @@ static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *, block_t *, size_t
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, mtime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static uint64_t TSTell( demux_sys_t * );
+static void ReadAheadFlush( demux_sys_t * );
+static int TSSeek( demux_sys_t *, uint64_t );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, int64_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, mtime_t );
 static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
+static void AnalyzePESPacket( demux_t *, ts_pid_t *, const block_t *, int );
+static void AnalysisReport( demux_t * );
+static int GetTSStats( demux_t *, demux_ts_stats_t * );
 
 #define TS_PACKET_SIZE_188 188
 #define TS_PACKET_SIZE_192 192
@@ -426,6 +453,14 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_pmt_es = 0;
     p_sys->seltype = PROGRAM_AUTO_DEFAULT;
 
+    p_sys->p_etr290 = NULL;
+    if( var_InheritBool( p_demux, "ts-etr290" ) )
+        p_sys->p_etr290 = ts_etr290_New( !p_sys->b_access_control );
+    p_sys->analysis.b_enabled = var_InheritBool( p_demux, "ts-pes-analysis" ) ||
+                                p_sys->p_etr290 != NULL;
+    p_sys->analysis.b_info = var_InheritBool( p_demux, "ts-analysis-info" );
+    p_sys->analysis.i_next_report = 0;
+
     /* Read config */
     p_sys->b_es_id_pid = var_CreateGetBool( p_demux, "ts-es-id-pid" );
     p_sys->i_next_extraid = 1;
@@ -573,11 +608,17 @@ static void Close( vlc_object_t *p_this )
         vlc_stream_Delete( p_sys->arib.b25stream );
     }
 
+    if( p_sys->p_readahead )
+        block_Release( p_sys->p_readahead );
+
     vlc_mutex_destroy( &p_sys->csa_lock );
 
     /* Release all non default pids */
     ts_pid_list_Release( p_demux, &p_sys->pids );
 
+    if( p_sys->p_etr290 )
+        ts_etr290_Delete( p_sys->p_etr290 );
+
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
@@ -653,6 +694,8 @@ static int Demux( demux_t *p_demux )
         {
             msg_Dbg( p_demux, "transport_error_indicator set (pid=%d)",
                      PIDGet( p_pkt ) );
+            if( p_sys->p_etr290 )
+                ts_etr290_TransportError( p_sys->p_etr290, PIDGet( p_pkt ) );
             block_Release( p_pkt );
             continue;
         }
@@ -668,6 +711,12 @@ static int Demux( demux_t *p_demux )
                 p_sys->b_valid_scrambling = true;
         }
 
+        if( p_sys->p_etr290 )
+        {
+            ts_etr290_Packet( p_sys->p_etr290, p_pid, p_pkt->p_buffer );
+            ts_etr290_Check( p_demux, p_sys->p_etr290 );
+        }
+
         /* Drop duplicates and invalid (DOES NOT drop corrupted) */
         p_pkt = ProcessTSPacket( p_demux, p_pid, p_pkt, &i_header );
         if( !p_pkt )
@@ -712,8 +761,12 @@ static int Demux( demux_t *p_demux )
                 UpdatePESFilters( p_demux, p_demux->p_sys->seltype == PROGRAM_ALL );
             }
 
+            if( p_sys->analysis.b_enabled )
+                AnalyzePESPacket( p_demux, p_pid, p_pkt, i_header );
+
             /* Emulate HW filter */
-            if( !p_sys->b_access_control && !(p_pid->i_flags & FLAG_FILTERED) )
+            if( !(p_pid->i_flags & FLAG_FILTERED) &&
+                ( !p_sys->b_access_control || (p_pid->i_flags & FLAG_ANALYZED) ) )
             {
                 /* That packet is for an unselected ES, don't waste time/memory gathering its data */
                 block_Release( p_pkt );
@@ -758,6 +811,14 @@ static int Demux( demux_t *p_demux )
             break;
     }
 
+    if( p_sys->analysis.b_enabled && mdate() >= p_sys->analysis.i_next_report )
+    {
+        AnalysisReport( p_demux );
+        if( p_sys->p_etr290 && p_sys->analysis.b_info && p_demux->p_input )
+            ts_etr290_Report( p_sys->p_etr290, input_GetItem( p_demux->p_input ) );
+        p_sys->analysis.i_next_report = mdate() + CLOCK_FREQ;
+    }
+
     demux_UpdateTitleFromStream( p_demux );
     return VLC_DEMUXER_SUCCESS;
 }
@@ -818,7 +879,7 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
 
         p_pmt_pid->i_flags &= ~FLAG_FILTERED;
         for( int j=0; j< p_pmt->e_streams.i_size; j++ )
-            p_pmt->e_streams.p_elems[j]->i_flags &= ~FLAG_FILTERED;
+            p_pmt->e_streams.p_elems[j]->i_flags &= ~(FLAG_FILTERED|FLAG_ANALYZED);
         GetPID(p_sys, p_pmt->i_pid_pcr)->i_flags &= ~FLAG_FILTERED;
     }
 
@@ -833,6 +894,14 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
         else
              p_pmt->b_selected = ProgramIsSelected( p_sys, p_pmt->i_number );
 
+        /* Analysis receives every ES, but only the headers of the
+           unselected ones are looked at */
+        if( p_sys->analysis.b_enabled )
+        {
+            for( int j=0; j<p_pmt->e_streams.i_size; j++ )
+                p_pmt->e_streams.p_elems[j]->i_flags |= FLAG_ANALYZED;
+        }
+
         if( p_pmt->b_selected )
         {
             p_pmt_pid->i_flags |= FLAG_FILTERED;
@@ -936,7 +1005,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TSTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -983,7 +1052,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         i64 = stream_Size( p_sys->stream );
         if( i64 > 0 &&
-            vlc_stream_Seek( p_sys->stream, (int64_t)(i64 * f) ) == VLC_SUCCESS )
+            TSSeek( p_sys, (int64_t)(i64 * f) ) == VLC_SUCCESS )
         {
             ReadyQueuesPostSeek( p_demux );
             return VLC_SUCCESS;
@@ -1120,9 +1189,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        ReadAheadFlush( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        ReadAheadFlush( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_SEEKPOINT,
                                      args );
 
@@ -1146,6 +1217,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     case DEMUX_GET_SIGNAL:
         return vlc_stream_vaControl( p_sys->stream, STREAM_GET_SIGNAL, args );
 
+    case DEMUX_GET_TS_STATS:
+        if( !p_sys->analysis.b_enabled )
+            return VLC_EGENERIC;
+        return GetTSStats( p_demux, va_arg( args, demux_ts_stats_t * ) );
+
     case DEMUX_GET_ATTACHMENTS:
     {
         input_attachment_t ***ppp_attach = va_arg( args, input_attachment_t *** );
@@ -1700,80 +1776,156 @@ static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool
     return b_ret;
 }
 
-static block_t* ReadTSPacket( demux_t *p_demux )
+/* Returns the offset of the first packet followed by another sync byte,
+ * or i_peek - i_packet_size if none */
+static unsigned FindTSSync( const uint8_t *p_peek, unsigned i_peek,
+                            unsigned i_packet_size, unsigned i_header_size )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
+    const unsigned i_max = i_peek - i_packet_size;
+    const uint8_t *p = &p_peek[i_header_size];
+    const uint8_t *p_end = &p_peek[i_max];
 
-    block_t     *p_pkt;
+    /* memchr() is vectorized by the C library, and sync bytes are rare
+     * enough in garbage for the candidates check to stay cheap */
+    while( p < p_end && (p = memchr( p, 0x47, p_end - p )) != NULL )
+    {
+        if( p[i_packet_size] == 0x47 )
+            return p - &p_peek[i_header_size];
+        p++;
+    }
+    return i_max;
+}
 
-    /* Get a new TS packet */
-    if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
+/* Number of packets read from the stream at once: as many as a UDP datagram
+ * usually carries, so that the reads of a block-based access are passed by
+ * reference, and sliced per packet without any copy */
+#define TS_READ_AHEAD_PACKETS 7
+
+static uint64_t TSTell( demux_sys_t *p_sys )
+{
+    uint64_t i_pos = vlc_stream_Tell( p_sys->stream );
+    if( p_sys->p_readahead )
+        i_pos -= p_sys->p_readahead->i_buffer;
+    return i_pos;
+}
+
+static void ReadAheadFlush( demux_sys_t *p_sys )
+{
+    if( p_sys->p_readahead )
     {
-        int64_t size = stream_Size( p_sys->stream );
-        if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
-            msg_Dbg( p_demux, "EOF at %"PRIu64, vlc_stream_Tell( p_sys->stream ) );
-        else
-            msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, vlc_stream_Tell(p_sys->stream) );
-        return NULL;
+        block_Release( p_sys->p_readahead );
+        p_sys->p_readahead = NULL;
     }
+}
 
-    if( p_pkt->i_buffer < TS_HEADER_SIZE + p_sys->i_packet_header_size )
+static int TSSeek( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    ReadAheadFlush( p_sys );
+    return vlc_stream_Seek( p_sys->stream, i_pos );
+}
+
+/* Reads ahead until at least i_size bytes are buffered, if available.
+ * Returns the number of bytes buffered. */
+static size_t ReadAhead( demux_t *p_demux, size_t i_size )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    block_t *p_ra = p_sys->p_readahead;
+    size_t i_buffered = p_ra ? p_ra->i_buffer : 0;
+
+    if( i_buffered >= i_size )
+        return i_buffered;
+
+    /* Complete the buffered data up to whole packets, so that the following
+     * reads stay aligned on the blocks of the access */
+    size_t i_read = __MAX( i_size, p_sys->i_packet_size * TS_READ_AHEAD_PACKETS )
+                  - i_buffered;
+    block_t *p_block = vlc_stream_Block( p_sys->stream, i_read );
+    if( p_block == NULL )
+        return i_buffered;
+
+    if( p_ra != NULL )
     {
-        block_Release( p_pkt );
-        return NULL;
+        /* Leftover of a short read or a resync: rare enough to be copied */
+        p_ra->p_next = p_block;
+        p_block = block_ChainGather( p_ra );
+        if( unlikely(p_block == NULL) )
+        {
+            block_ChainRelease( p_ra );
+            p_sys->p_readahead = NULL;
+            return 0;
+        }
     }
+    p_sys->p_readahead = p_block;
+    return p_block->i_buffer;
+}
 
-    /* Skip header (BluRay streams).
-     * re-sync logic would do this (by adjusting packet start), but this would result in losing first and last ts packets.
-     * First packet is usually PAT, and losing it means losing whole first GOP. This is fatal with still-image based menus.
-     */
-    p_pkt->p_buffer += p_sys->i_packet_header_size;
-    p_pkt->i_buffer -= p_sys->i_packet_header_size;
+static block_t* ReadTSPacket( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-    /* Check sync byte and re-sync if needed */
-    if( p_pkt->p_buffer[0] != 0x47 )
+    block_t     *p_pkt;
+
+    for( ;; )
     {
+        /* Get a new TS packet */
+        size_t i_buffered = ReadAhead( p_demux, p_sys->i_packet_size );
+        if( i_buffered == 0 )
+        {
+            int64_t size = stream_Size( p_sys->stream );
+            if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
+                msg_Dbg( p_demux, "EOF at %"PRIu64, vlc_stream_Tell( p_sys->stream ) );
+            else
+                msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, vlc_stream_Tell(p_sys->stream) );
+            return NULL;
+        }
+
+        p_pkt = block_Slice( &p_sys->p_readahead,
+                             __MIN( i_buffered, p_sys->i_packet_size ) );
+        if( unlikely(p_pkt == NULL) )
+            return NULL;
+
+        if( p_pkt->i_buffer < TS_HEADER_SIZE + p_sys->i_packet_header_size )
+        {
+            block_Release( p_pkt );
+            return NULL;
+        }
+
+        /* Skip header (BluRay streams).
+         * re-sync logic would do this (by adjusting packet start), but this would result in losing first and last ts packets.
+         * First packet is usually PAT, and losing it means losing whole first GOP. This is fatal with still-image based menus.
+         */
+        p_pkt->p_buffer += p_sys->i_packet_header_size;
+        p_pkt->i_buffer -= p_sys->i_packet_header_size;
+
+        /* Check sync byte and re-sync if needed */
+        if( p_pkt->p_buffer[0] == 0x47 )
+            return p_pkt;
+
         msg_Warn( p_demux, "lost synchro" );
+        if( p_sys->p_etr290 )
+            ts_etr290_SyncLoss( p_sys->p_etr290 );
         block_Release( p_pkt );
         for( ;; )
         {
-            const uint8_t *p_peek;
-            int i_peek = 0;
-            unsigned i_skip = 0;
-
-            i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
-                    p_sys->i_packet_size * 10 );
-            if( i_peek < 0 || (unsigned)i_peek < p_sys->i_packet_size + 1 )
+            size_t i_peek = ReadAhead( p_demux, p_sys->i_packet_size * 10 );
+            if( i_peek < p_sys->i_packet_size + 1 )
             {
                 msg_Dbg( p_demux, "eof ?" );
                 return NULL;
             }
 
-            while( i_skip < i_peek - p_sys->i_packet_size )
-            {
-                if( p_peek[i_skip + p_sys->i_packet_header_size] == 0x47 &&
-                        p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
-                {
-                    break;
-                }
-                i_skip++;
-            }
+            block_t *p_ra = p_sys->p_readahead;
+            unsigned i_skip = FindTSSync( p_ra->p_buffer, i_peek,
+                                          p_sys->i_packet_size,
+                                          p_sys->i_packet_header_size );
             msg_Dbg( p_demux, "skipping %d bytes of garbage", i_skip );
-            if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
-                return NULL;
+            p_ra->p_buffer += i_skip;
+            p_ra->i_buffer -= i_skip;
 
             if( i_skip < i_peek - p_sys->i_packet_size )
-            {
                 break;
-            }
-        }
-        if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
-        {
-            msg_Dbg( p_demux, "eof ?" );
-            return NULL;
         }
     }
-    return p_pkt;
 }
 
 static mtime_t GetPCR( const block_t *p_pkt )
@@ -1882,13 +2034,13 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaled
 
     /* Deal with common but worst binary search case */
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
-        return vlc_stream_Seek( p_sys->stream, 0 );
+        return TSSeek( p_sys, 0 );
 
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSTell( p_sys );
 
     /* Find the time position by using binary search algorithm. */
     uint64_t i_head_pos = 0;
@@ -1904,7 +2056,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaled
         uint64_t i_div = i_splitpos % p_sys->i_packet_size;
         i_splitpos -= i_div;
 
-        if ( vlc_stream_Seek( p_sys->stream, i_splitpos ) != VLC_SUCCESS )
+        if ( TSSeek( p_sys, i_splitpos ) != VLC_SUCCESS )
             break;
 
         uint64_t i_pos = i_splitpos;
@@ -1918,7 +2070,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaled
                 break;
             }
             else
-                i_pos = vlc_stream_Tell( p_sys->stream );
+                i_pos = TSTell( p_sys );
 
             int i_pid = PIDGet( p_pkt );
             ts_pid_t *p_pid = GetPID(p_sys, i_pid);
@@ -1975,7 +2127,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaled
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
-        vlc_stream_Seek( p_sys->stream, i_initial_pos );
+        TSSeek( p_sys, i_initial_pos );
         return VLC_EGENERIC;
     }
     return VLC_SUCCESS;
@@ -2056,7 +2208,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, int64_t *pi_
                         if( b_end )
                         {
                             p_pmt->i_last_dts = *pi_pcr;
-                            p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                            p_pmt->i_last_dts_byte = TSTell( p_sys );
                         }
                         /* Start, only keep first */
                         else if( b_pcrresult && p_pmt->pcr.i_first == -1 )
@@ -2084,7 +2236,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, int64_t *pi_
 int ProbeStart( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = 0;
@@ -2097,7 +2249,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
         i_pos = p_sys->i_packet_size * i_probe_count;
         i_pos = __MIN( i_pos, i_stream_size );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TSSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         ProbeChunk( p_demux, i_program, false, &i_pcr, &b_found );
@@ -2107,7 +2259,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && (i_pcr == -1 || !b_found) &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TSSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2116,7 +2268,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
 int ProbeEnd( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = PROBE_CHUNK_COUNT;
@@ -2129,7 +2281,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
         i_pos = i_stream_size - (p_sys->i_packet_size * i_probe_count);
         i_pos = __MAX( i_pos, 0 );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TSSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         ProbeChunk( p_demux, i_program, true, &i_pcr, &b_found );
@@ -2139,7 +2291,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && (i_pcr == -1 || !b_found) &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TSSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2190,14 +2342,14 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, mtime_t i_pcr )
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TSTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TSTell( p_sys );
             }
         }
     }
@@ -2398,6 +2550,240 @@ static void PCRFixHandle( demux_t *p_demux, ts_pmt_t *p_pmt, block_t *p_block )
     }
 }
 
+/* Accounts the packet of an ES for the analysis, and extracts in place the
+ * header of the PES it starts. The payload is never gathered. */
+static void AnalyzePESPacket( demux_t *p_demux, ts_pid_t *pid,
+                              const block_t *p_pkt, int i_skip )
+{
+    ts_stream_t *p_pes = pid->u.p_stream;
+    const uint8_t *p = p_pkt->p_buffer;
+
+    p_pes->analysis.i_packets++;
+    if( p_pkt->i_flags & BLOCK_FLAG_SCRAMBLED )
+    {
+        p_pes->analysis.i_scrambled++;
+        return;
+    }
+
+    if( p_pes->transport != TS_TRANSPORT_PES ||
+        (p[1] & 0x40) == 0 || (p[3] & 0x10) == 0 || /* no PES start */
+        (size_t)i_skip + 9 > p_pkt->i_buffer )
+        return;
+
+    const uint8_t *p_header = &p[i_skip];
+    if( p_header[0] != 0 || p_header[1] != 0 || p_header[2] != 1 )
+        return;
+
+    unsigned i_pes_skip;
+    mtime_t i_dts = -1;
+    mtime_t i_pts = -1;
+    uint8_t i_stream_id;
+    if( ParsePESHeader( VLC_OBJECT(p_demux), p_header, p_pkt->i_buffer - i_skip,
+                        &i_pes_skip, &i_dts, &i_pts, &i_stream_id, NULL ) != VLC_SUCCESS )
+        return;
+
+    p_pes->analysis.i_pes++;
+    p_pes->analysis.i_stream_id = i_stream_id;
+    if( i_pts == -1 )
+        return;
+    p_pes->analysis.i_pts = i_pts;
+    if( p_demux->p_sys->p_etr290 )
+        ts_etr290_PTS( p_demux->p_sys->p_etr290, pid->i_pid );
+    p_pes->analysis.i_dts = ( i_dts > -1 ) ? i_dts : i_pts;
+
+    const ts_pmt_t *p_pmt = p_pes->p_es->p_program;
+    if( p_pmt && p_pmt->pcr.i_current > -1 )
+    {
+        p_pes->analysis.i_pcr_offset =
+            TimeStampWrapAround( p_pmt->pcr.i_first, i_pts ) - p_pmt->pcr.i_current;
+        p_pes->analysis.b_pcr_offset = true;
+    }
+}
+
+/* Updates the bitrate of every ES, and publishes the analysis in the media
+ * information if requested */
+static void AnalysisReport( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    input_item_t *p_item = NULL;
+
+    if( p_sys->analysis.b_info && p_demux->p_input )
+        p_item = input_GetItem( p_demux->p_input );
+    const ts_pid_t *p_patpid = GetPID(p_sys, 0);
+
+    if( p_patpid->type != TYPE_PAT )
+        return;
+
+    const ts_pat_t *p_pat = p_patpid->u.p_pat;
+    for( int i=0; i< p_pat->programs.i_size; i++ )
+    {
+        const ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+        for( int j=0; j<p_pmt->e_streams.i_size; j++ )
+        {
+            const ts_pid_t *espid = p_pmt->e_streams.p_elems[j];
+            ts_stream_t *p_pes = espid->u.p_stream;
+
+            /* Bitrate over the elapsed program time */
+            if( p_pmt->pcr.i_current > -1 )
+            {
+                if( p_pes->analysis.i_report_pcr > -1 &&
+                    p_pmt->pcr.i_current > p_pes->analysis.i_report_pcr )
+                {
+                    uint64_t i_bits = ( p_pes->analysis.i_packets -
+                                        p_pes->analysis.i_report_packets ) * 188 * 8;
+                    p_pes->analysis.i_bitrate = i_bits * 90000 /
+                        ( p_pmt->pcr.i_current - p_pes->analysis.i_report_pcr );
+                }
+                p_pes->analysis.i_report_pcr = p_pmt->pcr.i_current;
+                p_pes->analysis.i_report_packets = p_pes->analysis.i_packets;
+            }
+
+            if( !p_item )
+                continue;
+
+            char psz_cat[20];
+            snprintf( psz_cat, sizeof(psz_cat), "TS PID %d", espid->i_pid );
+            input_item_AddInfo( p_item, psz_cat, _("Program"), "%d",
+                                p_pmt->i_number );
+            input_item_AddInfo( p_item, psz_cat, _("Stream ID"), "0x%x",
+                                p_pes->analysis.i_stream_id );
+            input_item_AddInfo( p_item, psz_cat, _("Bitrate"), "%u kb/s",
+                                (unsigned)(p_pes->analysis.i_bitrate / 1000) );
+            input_item_AddInfo( p_item, psz_cat, _("Packets"), "%"PRIu64,
+                                p_pes->analysis.i_packets );
+            input_item_AddInfo( p_item, psz_cat, _("Scrambled packets"), "%"PRIu64,
+                                p_pes->analysis.i_scrambled );
+            input_item_AddInfo( p_item, psz_cat, _("PES packets"), "%"PRIu32,
+                                p_pes->analysis.i_pes );
+            input_item_AddInfo( p_item, psz_cat, _("Continuity errors"), "%"PRIu32,
+                                p_pes->analysis.i_cc_errors );
+            if( p_pes->analysis.i_pts > -1 )
+                input_item_AddInfo( p_item, psz_cat, _("PTS"), "%"PRId64,
+                                    p_pes->analysis.i_pts );
+            if( p_pes->analysis.b_pcr_offset )
+                input_item_AddInfo( p_item, psz_cat, _("PTS to PCR offset"),
+                                    "%"PRId64" ms",
+                                    p_pes->analysis.i_pcr_offset / 90 );
+        }
+    }
+}
+
+/* Returns the number of the first program a PID belongs to, or -1 */
+static int PIDProgram( demux_sys_t *p_sys, uint16_t i_pid )
+{
+    const ts_pid_t *p_patpid = GetPID(p_sys, 0);
+
+    if( p_patpid->type != TYPE_PAT )
+        return -1;
+
+    const ts_pat_t *p_pat = p_patpid->u.p_pat;
+    for( int i=0; i< p_pat->programs.i_size; i++ )
+    {
+        const ts_pid_t *pmtpid = p_pat->programs.p_elems[i];
+        const ts_pmt_t *p_pmt = pmtpid->u.p_pmt;
+        if( pmtpid->i_pid == i_pid || p_pmt->i_pid_pcr == i_pid )
+            return p_pmt->i_number;
+        for( int j=0; j<p_pmt->e_streams.i_size; j++ )
+            if( p_pmt->e_streams.p_elems[j]->i_pid == i_pid )
+                return p_pmt->i_number;
+    }
+    return -1;
+}
+
+static int ComparePIDStats( const void *a, const void *b )
+{
+    return ((const demux_ts_pid_stats_t *)a)->i_pid -
+           ((const demux_ts_pid_stats_t *)b)->i_pid;
+}
+
+static demux_ts_pid_stats_t * FindPIDStats( demux_ts_stats_t *p_stats,
+                                            uint16_t i_pid )
+{
+    for( size_t i = 0; i < p_stats->i_pids; i++ )
+        if( p_stats->p_pids[i].i_pid == i_pid )
+            return &p_stats->p_pids[i];
+    return NULL;
+}
+
+/* Copies the measurements of the whole stream, of every analyzed elementary
+ * stream, and of every other PID on which the monitor measured something */
+static int GetTSStats( demux_t *p_demux, demux_ts_stats_t *p_stats )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const ts_pid_t *p_patpid = GetPID(p_sys, 0);
+    const ts_pat_t *p_pat = p_patpid->type == TYPE_PAT ? p_patpid->u.p_pat : NULL;
+    size_t i_max = 0;
+
+    p_stats->b_etr290 = p_sys->p_etr290 != NULL;
+    if( p_sys->p_etr290 )
+    {
+        ts_etr290_Get( p_sys->p_etr290, -1, p_stats->etr290 );
+        for( int i = 0; i < 8192; i++ )
+            if( ts_etr290_Get( p_sys->p_etr290, i, NULL ) )
+                i_max++;
+    }
+    for( int i=0; p_pat && i< p_pat->programs.i_size; i++ )
+        i_max += p_pat->programs.p_elems[i]->u.p_pmt->e_streams.i_size;
+
+    p_stats->i_pids = 0;
+    p_stats->p_pids = NULL;
+    if( i_max == 0 )
+        return VLC_SUCCESS;
+
+    p_stats->p_pids = vlc_alloc( i_max, sizeof(*p_stats->p_pids) );
+    if( !p_stats->p_pids )
+        return VLC_ENOMEM;
+
+    for( int i=0; p_pat && i< p_pat->programs.i_size; i++ )
+    {
+        const ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+        for( int j=0; j<p_pmt->e_streams.i_size; j++ )
+        {
+            const ts_pid_t *espid = p_pmt->e_streams.p_elems[j];
+            const ts_stream_t *p_pes = espid->u.p_stream;
+
+            if( FindPIDStats( p_stats, espid->i_pid ) ) /* shared */
+                continue;
+
+            demux_ts_pid_stats_t *p_pid = &p_stats->p_pids[p_stats->i_pids++];
+            memset( p_pid, 0, sizeof(*p_pid) );
+            p_pid->i_pid = espid->i_pid;
+            p_pid->i_program = p_pmt->i_number;
+            p_pid->b_analysis = true;
+            p_pid->i_stream_id = p_pes->analysis.i_stream_id;
+            p_pid->i_packets = p_pes->analysis.i_packets;
+            p_pid->i_scrambled = p_pes->analysis.i_scrambled;
+            p_pid->i_pes = p_pes->analysis.i_pes;
+            p_pid->i_cc_errors = p_pes->analysis.i_cc_errors;
+            p_pid->i_bitrate = p_pes->analysis.i_bitrate;
+            p_pid->i_pts = p_pes->analysis.i_pts;
+            p_pid->b_pcr_offset = p_pes->analysis.b_pcr_offset;
+            p_pid->i_pcr_offset = p_pes->analysis.i_pcr_offset;
+            p_pid->b_etr290 = p_sys->p_etr290 &&
+                ts_etr290_Get( p_sys->p_etr290, espid->i_pid, p_pid->etr290 );
+        }
+    }
+
+    for( int i = 0; p_sys->p_etr290 && i < 8192; i++ )
+    {
+        if( !ts_etr290_Get( p_sys->p_etr290, i, NULL ) ||
+            FindPIDStats( p_stats, i ) )
+            continue;
+
+        demux_ts_pid_stats_t *p_pid = &p_stats->p_pids[p_stats->i_pids++];
+        memset( p_pid, 0, sizeof(*p_pid) );
+        p_pid->i_pid = i;
+        p_pid->i_program = PIDProgram( p_sys, i );
+        p_pid->i_pts = -1;
+        p_pid->b_etr290 = true;
+        ts_etr290_Get( p_sys->p_etr290, i, p_pid->etr290 );
+    }
+
+    qsort( p_stats->p_pids, p_stats->i_pids, sizeof(*p_stats->p_pids),
+           ComparePIDStats );
+    return VLC_SUCCESS;
+}
+
 static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, int *pi_skip )
 {
     const uint8_t *p = p_pkt->p_buffer;
@@ -2466,10 +2852,10 @@ static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pk
                 if(p[5] == 0x82 && !strncmp((const char *)&p[7], "VLC_STILLFRAME", 14))
                     p_pkt->i_flags |= BLOCK_FLAG_DISCONTINUITY;
             }
-#if 0
-            if( p[5]&0x40 )
-                msg_Dbg( p_demux, "random access indicator (pid=%d) ", pid->i_pid );
-#endif
+            /* random access indicator at the start of a PES: the decoding
+             * can start from there (key frame) */
+            if( (p[5]&0x40) && (p[1]&0x40) )
+                p_pkt->i_flags |= BLOCK_FLAG_TYPE_I;
         }
     }
 
@@ -2507,6 +2893,10 @@ static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pk
             {
                 msg_Warn( p_demux, "discontinuity received 0x%x instead of 0x%x (pid=%d)",
                           i_cc, ( pid->i_cc + 1 )&0x0f, pid->i_pid );
+                if( pid->type == TYPE_STREAM )
+                    pid->u.p_stream->analysis.i_cc_errors++;
+                if( p_demux->p_sys->p_etr290 )
+                    ts_etr290_CCError( p_demux->p_sys->p_etr290, pid->i_pid );
 
                 pid->i_cc = i_cc;
                 pid->i_dup = 0;
@@ -2572,21 +2962,10 @@ static bool block_Split( block_t **pp_block, block_t **pp_remain, size_t i_offse
 
 static uint8_t *FindNextPESHeader( uint8_t *p_buf, size_t i_buffer )
 {
-    const uint8_t *p_end = &p_buf[i_buffer];
-    unsigned i_bitflow = 0;
-    for( ; p_buf != p_end; p_buf++ )
-    {
-        i_bitflow <<= 1;
-        if( !*p_buf )
-        {
-            i_bitflow |= 1;
-        }
-        else if( *p_buf == 0x01 && (i_bitflow & 0x06) == 0x06 ) /* >= two zero prefixed 1 */
-        {
-            return p_buf - 2;
-        }
-    }
-    return NULL;
+    /* Returns a sync code followed by the stream id and PES length */
+    if( i_buffer < 6 )
+        return NULL;
+    return (uint8_t *) startcode_FindAnnexB( p_buf, &p_buf[i_buffer - 2] );
 }
 
 static const uint8_t pes_sync[] = { 0, 0, 1 };
@@ -2669,7 +3048,7 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, size
             else
             {
                 /* Need to find sync code */
-                uint8_t *p_buf = FindNextPESHeader( p_pkt->p_buffer, p_pkt->i_buffer - 3 );
+                uint8_t *p_buf = FindNextPESHeader( p_pkt->p_buffer, p_pkt->i_buffer );
                 if( p_buf == NULL )
                 {
                     /* no first sync code */
@@ -24,6 +24,7 @@
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct ts_etr290_t ts_etr290_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
@@ -47,6 +48,7 @@ typedef struct
 struct demux_sys_t
 {
     stream_t   *stream;
+    block_t    *p_readahead; /* packets read from the stream, not demuxed yet */
     bool        b_canseek;
     bool        b_canfastseek;
     vlc_mutex_t     csa_lock;
@@ -102,6 +104,17 @@ struct demux_sys_t
     bool        b_access_control;
     bool        b_end_preparse;
 
+    /* PES header only analysis of the unselected ES */
+    struct
+    {
+        bool    b_enabled;
+        bool    b_info; /* also published in the media information */
+        mtime_t i_next_report;
+    } analysis;
+
+    /* ETR 290 measurements, or NULL */
+    ts_etr290_t *p_etr290;
+
     /* */
     time_t      i_network_time;
     time_t      i_network_time_update; /* for network time interpolation */
@@ -0,0 +1,518 @@
+/*****************************************************************************
+ * ts_etr290.c: ETR 290 priority 1 and 2 measurements
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_input.h>
+
+#ifndef _DVBPSI_DVBPSI_H_
+ #include <dvbpsi/dvbpsi.h>
+#endif
+
+#include "ts_pid.h"
+#include "ts_streams.h"
+#include "ts_streams_private.h"
+#include "ts.h"
+#include "ts_etr290.h"
+
+#define ETR290_PSI_INTERVAL   (CLOCK_FREQ / 2)      /* 1.3 and 1.5 */
+#define ETR290_PID_INTERVAL   (CLOCK_FREQ * 5)      /* 1.6, user defined */
+#define ETR290_PCR_INTERVAL   (CLOCK_FREQ / 10)     /* 2.3a */
+#define ETR290_PCR_GAP        (27000000 / 10)       /* 2.3b, 27MHz */
+#define ETR290_PCR_ACCURACY   13.5                  /* 2.4, 500ns at 27MHz */
+#define ETR290_PTS_INTERVAL   (CLOCK_FREQ * 7 / 10) /* 2.5 */
+#define ETR290_CHECK_INTERVAL (CLOCK_FREQ / 10)
+#define ETR290_CLOCK_TIMEOUT  27000000              /* 27MHz, re-election */
+#define ETR290_WINDOW         CLOCK_FREQ
+
+#define PCR_WRAP (INT64_C(300) << 33)
+
+typedef struct
+{
+    mtime_t  i_seen;       /* last packet */
+    mtime_t  i_section;    /* last PAT/PMT section */
+    mtime_t  i_pcr_date;   /* last PCR */
+    mtime_t  i_pts_date;   /* last PTS */
+    int64_t  i_pcr;        /* last PCR value (27MHz), or -1 */
+    uint64_t i_pcr_packet; /* multiplex packet index of the last PCR */
+    /* Constant rate reference for the PCR accuracy */
+    uint64_t i_pcr_ref_packet;
+    int64_t  i_pcr_span;
+    int64_t  i_pcr_silence; /* time since the last time base PCR (27MHz) */
+
+    uint32_t window[DEMUX_ETR290_COUNT];
+    demux_etr290_counter_t counters[DEMUX_ETR290_COUNT];
+} ts_etr290_pid_t;
+
+struct ts_etr290_t
+{
+    int      i_clock_pid;  /* time base, -1 until a PCR has been seen */
+    int64_t  i_clock;      /* 27MHz */
+    uint64_t i_clock_packet; /* multiplex packet index of the last clock PCR */
+    mtime_t  i_now;
+    mtime_t  i_next_check;
+    mtime_t  i_next_window;
+    uint64_t i_packets;
+    bool     b_cat;
+    bool     b_pcr_accuracy;
+
+    uint32_t crc[256];
+
+    uint32_t window[DEMUX_ETR290_COUNT];
+    demux_etr290_counter_t counters[DEMUX_ETR290_COUNT];
+
+    ts_etr290_pid_t *pids[8192];
+};
+
+static const char *const ppsz_indicators[DEMUX_ETR290_COUNT] =
+{
+    N_("TS sync loss"),
+    N_("Sync byte error"),
+    N_("PAT error"),
+    N_("Continuity count error"),
+    N_("PMT error"),
+    N_("PID error"),
+    N_("Transport error"),
+    N_("CRC error"),
+    N_("PCR repetition error"),
+    N_("PCR discontinuity indicator error"),
+    N_("PCR accuracy error"),
+    N_("PTS error"),
+    N_("CAT error"),
+};
+
+static void CounterInit( demux_etr290_counter_t *p_counters )
+{
+    for( int i = 0; i < DEMUX_ETR290_COUNT; i++ )
+    {
+        p_counters[i].i_count = 0;
+        p_counters[i].i_window = 0;
+        p_counters[i].i_last = -1;
+    }
+}
+
+ts_etr290_t * ts_etr290_New( bool b_pcr_accuracy )
+{
+    ts_etr290_t *p_mon = calloc( 1, sizeof(*p_mon) );
+    if( !p_mon )
+        return NULL;
+
+    p_mon->i_clock_pid = -1;
+    p_mon->b_pcr_accuracy = b_pcr_accuracy;
+    CounterInit( p_mon->counters );
+
+    /* CRC_32 of ISO/IEC 13818-1 Annex B */
+    for( uint32_t i = 0; i < 256; i++ )
+    {
+        uint32_t k = i << 24;
+        for( int j = 0; j < 8; j++ )
+            k = (k << 1) ^ ((k & 0x80000000) ? 0x04c11db7 : 0);
+        p_mon->crc[i] = k;
+    }
+
+    return p_mon;
+}
+
+void ts_etr290_Delete( ts_etr290_t *p_mon )
+{
+    for( int i = 0; i < 8192; i++ )
+        free( p_mon->pids[i] );
+    free( p_mon );
+}
+
+static ts_etr290_pid_t * GetState( ts_etr290_t *p_mon, uint16_t i_pid )
+{
+    ts_etr290_pid_t *p_state = p_mon->pids[i_pid];
+    if( likely(p_state) )
+        return p_state;
+
+    p_state = malloc( sizeof(*p_state) );
+    if( !p_state )
+        return NULL;
+
+    p_state->i_seen = -1;
+    p_state->i_section = -1;
+    p_state->i_pcr_date = -1;
+    p_state->i_pts_date = -1;
+    p_state->i_pcr = -1;
+    p_state->i_pcr_packet = 0;
+    p_state->i_pcr_ref_packet = 0;
+    p_state->i_pcr_span = 0;
+    p_state->i_pcr_silence = 0;
+    memset( p_state->window, 0, sizeof(p_state->window) );
+    CounterInit( p_state->counters );
+
+    p_mon->pids[i_pid] = p_state;
+    return p_state;
+}
+
+static void Raise( ts_etr290_t *p_mon, ts_etr290_pid_t *p_state,
+                   enum demux_etr290_indicator i )
+{
+    p_mon->counters[i].i_count++;
+    p_mon->counters[i].i_last = p_mon->i_now;
+    p_mon->window[i]++;
+    if( p_state )
+    {
+        p_state->counters[i].i_count++;
+        p_state->counters[i].i_last = p_mon->i_now;
+        p_state->window[i]++;
+    }
+}
+
+void ts_etr290_SyncLoss( ts_etr290_t *p_mon )
+{
+    Raise( p_mon, NULL, DEMUX_ETR290_TS_SYNC_LOSS );
+    Raise( p_mon, NULL, DEMUX_ETR290_SYNC_BYTE_ERROR );
+}
+
+void ts_etr290_TransportError( ts_etr290_t *p_mon, uint16_t i_pid )
+{
+    p_mon->i_packets++;
+    Raise( p_mon, GetState( p_mon, i_pid ), DEMUX_ETR290_TRANSPORT_ERROR );
+}
+
+void ts_etr290_CCError( ts_etr290_t *p_mon, uint16_t i_pid )
+{
+    Raise( p_mon, GetState( p_mon, i_pid ), DEMUX_ETR290_CC_ERROR );
+}
+
+void ts_etr290_PTS( ts_etr290_t *p_mon, uint16_t i_pid )
+{
+    ts_etr290_pid_t *p_state = GetState( p_mon, i_pid );
+    if( p_state )
+        p_state->i_pts_date = p_mon->i_now;
+}
+
+static void ElectClock( ts_etr290_t *p_mon, uint16_t i_pid )
+{
+    /* The PCR values of the PIDs are unrelated: continue from now */
+    p_mon->i_clock_pid = i_pid;
+    p_mon->i_clock = p_mon->i_now * 27;
+    p_mon->i_clock_packet = p_mon->i_packets;
+}
+
+/* Advances the time base with the PCR of its PID. The PCR of the other PIDs
+ * measure how long the time base PID has been silent, and replace it when
+ * it has been for too long. */
+static void Clock( ts_etr290_t *p_mon, ts_etr290_pid_t *p_state,
+                   uint16_t i_pid, int64_t i_delta )
+{
+    if( i_pid == p_mon->i_clock_pid )
+    {
+        p_mon->i_clock += i_delta;
+        p_mon->i_clock_packet = p_mon->i_packets;
+        if( p_mon->i_now < p_mon->i_clock / 27 )
+            p_mon->i_now = p_mon->i_clock / 27;
+        return;
+    }
+
+    if( p_state->i_pcr_packet < p_mon->i_clock_packet )
+        p_state->i_pcr_silence = 0;
+    else
+        p_state->i_pcr_silence += i_delta;
+
+    if( p_state->i_pcr_silence > ETR290_CLOCK_TIMEOUT )
+        ElectClock( p_mon, i_pid );
+}
+
+/* Extrapolates the time base from the multiplex rate since the last PCR,
+ * so that it keeps running if the PCR stop */
+static void Extrapolate( ts_etr290_t *p_mon )
+{
+    if( p_mon->i_clock_pid < 0 )
+        return;
+
+    const ts_etr290_pid_t *p_clock = p_mon->pids[p_mon->i_clock_pid];
+    const uint64_t i_span_packets = p_clock->i_pcr_packet
+                                  - p_clock->i_pcr_ref_packet;
+    if( p_clock->i_pcr_span <= 0 || i_span_packets == 0 )
+        return;
+
+    const double f_ticks = (double) p_clock->i_pcr_span / i_span_packets;
+    const mtime_t i_now = ( p_mon->i_clock + (int64_t)( f_ticks *
+                            ( p_mon->i_packets - p_mon->i_clock_packet ) ) ) / 27;
+    if( p_mon->i_now < i_now )
+        p_mon->i_now = i_now;
+}
+
+static void PCR( ts_etr290_t *p_mon, ts_etr290_pid_t *p_state,
+                 uint16_t i_pid, const uint8_t *p )
+{
+    const bool b_discontinuity = p[5] & 0x80;
+    const int64_t i_pcr = ( ( (int64_t)p[6] << 25 ) |
+                            ( (int64_t)p[7] << 17 ) |
+                            ( (int64_t)p[8] << 9 ) |
+                            ( (int64_t)p[9] << 1 ) |
+                            ( (int64_t)p[10] >> 7 ) ) * 300 +
+                          ( ( (p[10] & 0x01) << 8 ) | p[11] );
+
+    bool b_clock = false;
+    bool b_restart = true;
+    if( p_state->i_pcr >= 0 && !b_discontinuity )
+    {
+        const int64_t i_delta = ( i_pcr - p_state->i_pcr + PCR_WRAP ) % PCR_WRAP;
+
+        /* Keep the time base running over sparse PCR, but not over jumps */
+        if( i_delta <= 27000000 )
+        {
+            Clock( p_mon, p_state, i_pid, i_delta );
+            b_clock = true;
+        }
+
+        if( i_delta > ETR290_PCR_GAP )
+        {
+            Raise( p_mon, p_state, DEMUX_ETR290_PCR_DISCONTINUITY_ERROR );
+        }
+        else
+        {
+            /* Compare with the PCR expected at a constant multiplex rate */
+            if( p_mon->b_pcr_accuracy && p_state->i_pcr_span > 0 )
+            {
+                double f_ticks = (double) p_state->i_pcr_span /
+                                 ( p_state->i_pcr_packet - p_state->i_pcr_ref_packet );
+                double f_error = i_delta - f_ticks *
+                                 ( p_mon->i_packets - p_state->i_pcr_packet );
+                if( f_error > ETR290_PCR_ACCURACY || f_error < -ETR290_PCR_ACCURACY )
+                    Raise( p_mon, p_state, DEMUX_ETR290_PCR_ACCURACY_ERROR );
+            }
+            p_state->i_pcr_span += i_delta;
+            b_restart = false;
+        }
+    }
+
+    /* First PCR, or jump of the time base */
+    if( !b_clock && ( p_mon->i_clock_pid < 0 || i_pid == p_mon->i_clock_pid ) )
+        ElectClock( p_mon, i_pid );
+
+    if( b_restart )
+    {
+        p_state->i_pcr_span = 0;
+        p_state->i_pcr_ref_packet = p_mon->i_packets;
+    }
+    p_state->i_pcr = i_pcr;
+    p_state->i_pcr_packet = p_mon->i_packets;
+    p_state->i_pcr_date = p_mon->i_now;
+}
+
+static uint32_t CRC32( const uint32_t *p_table, const uint8_t *p, size_t i_size )
+{
+    uint32_t i_crc = 0xffffffff;
+    for( size_t i = 0; i < i_size; i++ )
+        i_crc = (i_crc << 8) ^ p_table[(i_crc >> 24) ^ p[i]];
+    return i_crc;
+}
+
+void ts_etr290_Packet( ts_etr290_t *p_mon, const ts_pid_t *pid, const uint8_t *p )
+{
+    ts_etr290_pid_t *p_state = GetState( p_mon, pid->i_pid );
+
+    p_mon->i_packets++;
+    Extrapolate( p_mon );
+    if( unlikely(!p_state) )
+        return;
+
+    unsigned i_payload = 4;
+    if( p[3] & 0x20 )
+    {
+        i_payload += 1 + p[4];
+        if( p[4] >= 7 && (p[5] & 0x10) )
+            PCR( p_mon, p_state, pid->i_pid, p );
+    }
+    p_state->i_seen = p_mon->i_now;
+
+    if( p[3] & 0xc0 )
+    {
+        if( pid->i_pid == 0 )
+            Raise( p_mon, p_state, DEMUX_ETR290_PAT_ERROR );
+        else if( pid->type == TYPE_PMT )
+            Raise( p_mon, p_state, DEMUX_ETR290_PMT_ERROR );
+        if( !p_mon->b_cat )
+            Raise( p_mon, p_state, DEMUX_ETR290_CAT_ERROR );
+        return;
+    }
+
+    /* Only look at the first section starting in the packet */
+    if( (p[1] & 0x40) == 0 || (p[3] & 0x10) == 0 || i_payload >= 188 )
+        return;
+    const unsigned i_section = i_payload + 1 + p[i_payload];
+    if( i_section + 3 > 188 )
+        return;
+    const uint8_t *p_section = &p[i_section];
+
+    if( pid->i_pid == 0 )
+    {
+        if( p_section[0] != 0x00 )
+            Raise( p_mon, p_state, DEMUX_ETR290_PAT_ERROR );
+        else
+            p_state->i_section = p_mon->i_now;
+    }
+    else if( pid->i_pid == 1 )
+    {
+        if( p_section[0] != 0x01 )
+            Raise( p_mon, p_state, DEMUX_ETR290_CAT_ERROR );
+        else
+            p_mon->b_cat = true;
+    }
+    else if( pid->type == TYPE_PMT )
+    {
+        if( p_section[0] == 0x02 )
+            p_state->i_section = p_mon->i_now;
+    }
+    else if( pid->type != TYPE_SI && pid->type != TYPE_PSIP )
+        return;
+
+    /* CRC_32, unless the section spans several packets */
+    const unsigned i_length = ( (p_section[1] & 0x0f) << 8 ) | p_section[2];
+    if( p_section[0] == 0xff || (p_section[1] & 0x80) == 0 /* no CRC */ ||
+        i_length < 4 || i_section + 3 + i_length > 188 )
+        return;
+    if( CRC32( p_mon->crc, p_section, 3 + i_length ) != 0 )
+        Raise( p_mon, p_state, DEMUX_ETR290_CRC_ERROR );
+}
+
+/* Returns true, and restarts the interval, if the date is older than it */
+static bool Timeout( const ts_etr290_t *p_mon, mtime_t *pi_date,
+                     mtime_t i_interval, bool b_start )
+{
+    if( *pi_date < 0 )
+    {
+        if( b_start )
+            *pi_date = p_mon->i_now;
+        return false;
+    }
+    if( p_mon->i_now - *pi_date <= i_interval )
+        return false;
+    *pi_date = p_mon->i_now;
+    return true;
+}
+
+static void Rotate( uint32_t *p_window, demux_etr290_counter_t *p_counters )
+{
+    for( int i = 0; i < DEMUX_ETR290_COUNT; i++ )
+    {
+        p_counters[i].i_window = p_window[i];
+        p_window[i] = 0;
+    }
+}
+
+void ts_etr290_Check( demux_t *p_demux, ts_etr290_t *p_mon )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_mon->i_clock_pid < 0 || p_mon->i_now < p_mon->i_next_check )
+        return;
+    p_mon->i_next_check = p_mon->i_now + ETR290_CHECK_INTERVAL;
+
+    ts_pid_t *patpid = GetPID(p_sys, 0);
+    ts_etr290_pid_t *p_state = GetState( p_mon, 0 );
+    if( p_state && Timeout( p_mon, &p_state->i_section, ETR290_PSI_INTERVAL, true ) )
+        Raise( p_mon, p_state, DEMUX_ETR290_PAT_ERROR );
+
+    if( patpid->type == TYPE_PAT )
+    {
+        const ts_pat_t *p_pat = patpid->u.p_pat;
+        for( int i = 0; i < p_pat->programs.i_size; i++ )
+        {
+            const ts_pid_t *pmtpid = p_pat->programs.p_elems[i];
+            const ts_pmt_t *p_pmt = pmtpid->u.p_pmt;
+
+            p_state = GetState( p_mon, pmtpid->i_pid );
+            if( p_state && Timeout( p_mon, &p_state->i_section, ETR290_PSI_INTERVAL, true ) )
+                Raise( p_mon, p_state, DEMUX_ETR290_PMT_ERROR );
+
+            for( int j = 0; j < p_pmt->e_streams.i_size; j++ )
+            {
+                p_state = GetState( p_mon, p_pmt->e_streams.p_elems[j]->i_pid );
+                if( !p_state )
+                    continue;
+                if( Timeout( p_mon, &p_state->i_seen, ETR290_PID_INTERVAL, true ) )
+                    Raise( p_mon, p_state, DEMUX_ETR290_PID_ERROR );
+                if( Timeout( p_mon, &p_state->i_pts_date, ETR290_PTS_INTERVAL, false ) )
+                    Raise( p_mon, p_state, DEMUX_ETR290_PTS_ERROR );
+            }
+
+            if( p_pmt->i_pid_pcr > 0 && p_pmt->i_pid_pcr < 0x1FFF && !p_pmt->pcr.b_disable )
+            {
+                p_state = GetState( p_mon, p_pmt->i_pid_pcr );
+                if( p_state && Timeout( p_mon, &p_state->i_pcr_date, ETR290_PCR_INTERVAL, true ) )
+                    Raise( p_mon, p_state, DEMUX_ETR290_PCR_REPETITION_ERROR );
+            }
+        }
+    }
+
+    if( p_mon->i_now >= p_mon->i_next_window )
+    {
+        p_mon->i_next_window = p_mon->i_now + ETR290_WINDOW;
+        Rotate( p_mon->window, p_mon->counters );
+        for( int i = 0; i < 8192; i++ )
+            if( p_mon->pids[i] )
+                Rotate( p_mon->pids[i]->window, p_mon->pids[i]->counters );
+    }
+}
+
+bool ts_etr290_Get( const ts_etr290_t *p_mon, int i_pid,
+                    demux_etr290_counter_t *p_counters )
+{
+    const demux_etr290_counter_t *p_src = p_mon->counters;
+    if( i_pid >= 0 )
+    {
+        if( i_pid >= 8192 || !p_mon->pids[i_pid] )
+            return false;
+        p_src = p_mon->pids[i_pid]->counters;
+    }
+    if( p_counters )
+        memcpy( p_counters, p_src, sizeof(p_mon->counters) );
+    return true;
+}
+
+static void ReportCounters( const ts_etr290_t *p_mon, input_item_t *p_item,
+                            const char *psz_cat,
+                            const demux_etr290_counter_t *p_counters, bool b_all )
+{
+    for( int i = 0; i < DEMUX_ETR290_COUNT; i++ )
+    {
+        if( !b_all && p_counters[i].i_count == 0 )
+            continue;
+        if( i == DEMUX_ETR290_PCR_ACCURACY_ERROR && !p_mon->b_pcr_accuracy )
+            continue;
+        input_item_AddInfo( p_item, psz_cat, vlc_gettext( ppsz_indicators[i] ),
+                            "%"PRIu64" (%"PRIu32"/s)",
+                            p_counters[i].i_count, p_counters[i].i_window );
+    }
+}
+
+void ts_etr290_Report( const ts_etr290_t *p_mon, input_item_t *p_item )
+{
+    ReportCounters( p_mon, p_item, _("ETR 290"), p_mon->counters, true );
+
+    for( int i = 0; i < 8192; i++ )
+    {
+        if( !p_mon->pids[i] )
+            continue;
+
+        char psz_cat[20];
+        snprintf( psz_cat, sizeof(psz_cat), "TS PID %d", i );
+        ReportCounters( p_mon, p_item, psz_cat, p_mon->pids[i]->counters,
+                        false );
+    }
+}
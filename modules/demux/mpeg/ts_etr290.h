@@ -0,0 +1,50 @@
+/*****************************************************************************
+ * ts_etr290.h: ETR 290 priority 1 and 2 measurements
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+#ifndef VLC_TS_ETR290_H
+#define VLC_TS_ETR290_H
+
+/* The monitor time base is the PCR of a PCR carrying PID, so that the timing
+ * indicators are also meaningful when reading from files. It is
+ * extrapolated from the multiplex rate between PCRs, and another PID is
+ * elected if the PCRs of the current one stop. */
+
+typedef struct ts_etr290_t ts_etr290_t;
+
+/* The PCR accuracy is measured against the packet rate, which is
+ * meaningless if the access filters the PIDs */
+ts_etr290_t * ts_etr290_New( bool b_pcr_accuracy );
+void ts_etr290_Delete( ts_etr290_t * );
+
+/* Events from the demuxer */
+void ts_etr290_SyncLoss( ts_etr290_t * );
+void ts_etr290_TransportError( ts_etr290_t *, uint16_t i_pid );
+void ts_etr290_Packet( ts_etr290_t *, const ts_pid_t *, const uint8_t *p_pkt );
+void ts_etr290_CCError( ts_etr290_t *, uint16_t i_pid );
+void ts_etr290_PTS( ts_etr290_t *, uint16_t i_pid );
+
+/* Timeouts based indicators, to be called after each packet */
+void ts_etr290_Check( demux_t *, ts_etr290_t * );
+
+/* Copies the counters of the whole stream (pid -1) or of a PID, if not NULL,
+ * and returns false if nothing was measured on that PID */
+bool ts_etr290_Get( const ts_etr290_t *, int i_pid, demux_etr290_counter_t * );
+
+void ts_etr290_Report( const ts_etr290_t *, input_item_t * );
+
+#endif
@@ -313,7 +313,8 @@ int UpdateHWFilter( demux_sys_t *p_sys, ts_pid_t *p_pid )
         return VLC_EGENERIC;
 
     return vlc_stream_Control( p_sys->stream, STREAM_SET_PRIVATE_ID_STATE,
-                           p_pid->i_pid, !!(p_pid->i_flags & FLAG_FILTERED) );
+                           p_pid->i_pid,
+                               !!(p_pid->i_flags & (FLAG_FILTERED|FLAG_ANALYZED)) );
 }
 
 int SetPIDFilter( demux_sys_t *p_sys, ts_pid_t *p_pid, bool b_selected )
@@ -321,7 +322,7 @@ int SetPIDFilter( demux_sys_t *p_sys, ts_pid_t *p_pid, bool b_selected )
     if( b_selected )
         p_pid->i_flags |= FLAG_FILTERED;
     else
-        p_pid->i_flags &= ~FLAG_FILTERED;
+        p_pid->i_flags &= ~(FLAG_FILTERED|FLAG_ANALYZED);
 
     return UpdateHWFilter( p_sys, p_pid );
 }
@@ -42,7 +42,8 @@ enum
     FLAGS_NONE = 0,
     FLAG_SEEN  = 1,
     FLAG_SCRAMBLED = 2,
-    FLAG_FILTERED = 4
+    FLAG_FILTERED = 4,
+    FLAG_ANALYZED = 8, /* received for PES header analysis only */
 };
 
 #define SEEN(x) ((x)->i_flags & FLAG_SEEN)
@@ -1389,6 +1389,13 @@ static void PMTParseEsIso639( demux_t *p_demux, ts_es_t *p_es,
     }
 }
 
+static void SetupSCTE35Sections( demux_t *p_demux, ts_stream_t *p_pes )
+{
+    ts_sections_processor_Add( p_demux, &p_pes->p_sections_proc,
+                               SCTE35_TABLE_ID, 0x00,
+                               SCTE35_Section_Callback, p_pes );
+}
+
 static void PIDFillFormat( demux_t *p_demux, ts_stream_t *p_pes,
                            int i_stream_type, ts_transport_type_t *p_datatype )
 {
@@ -1441,6 +1448,13 @@ static void PIDFillFormat( demux_t *p_demux, ts_stream_t *p_pes,
         ts_sections_processor_Add( p_demux, &p_pes->p_sections_proc, 0xC6, 0x00,
                                    SCTE27_Section_Callback, p_pes );
         break;
+    case 0x86:  /* SCTE-35 splice information (data) */
+        /* Like subtitles without language, it is only selected on request,
+         * such as --sout-all. The sections processor is only added once the
+         * registrations did not change the meaning of the type. */
+        es_format_Change( fmt, SPU_ES, VLC_CODEC_SCTE_35 );
+        *p_datatype = TS_TRANSPORT_SECTIONS;
+        break;
     case 0x84:  /* SDDS (audio) */
         es_format_Change( fmt, AUDIO_ES, VLC_CODEC_SDDS );
         break;
@@ -1552,6 +1566,9 @@ static void FillPESFromDvbpsiES( demux_t *p_demux,
             /* LPCM (audio) */
             PMTSetupEs0x83( p_dvbpsipmt, p_pes->p_es, p_dvbpsies->i_pid );
             break;
+        case 0x86:
+            SetupSCTE35Sections( p_demux, p_pes );
+            break;
         case 0xa0:
             PMTSetupEs0xA0( p_demux, p_pes->p_es, p_dvbpsies );
             break;
@@ -2100,6 +2117,8 @@ int UserPmt( demux_t *p_demux, const char *psz_fmt )
             {
                 const int i_stream_type = strtol( psz_opt, NULL, 0 );
                 PIDFillFormat( p_demux, pid->u.p_stream, i_stream_type, &pid->u.p_stream->transport );
+                if( i_stream_type == 0x86 )
+                    SetupSCTE35Sections( p_demux, pid->u.p_stream );
             }
 
             fmt->i_group = i_number;
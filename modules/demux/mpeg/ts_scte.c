@@ -119,3 +119,53 @@ void SCTE27_Section_Callback( demux_t *p_demux,
     else
         block_Release( p_content );
 }
+
+void SCTE35_Section_Callback( demux_t *p_demux,
+                              const uint8_t *p_sectiondata, size_t i_sectiondata,
+                              const uint8_t *p_payloaddata, size_t i_payloaddata,
+                              void *p_pes_cb_data )
+{
+    VLC_UNUSED(p_payloaddata); VLC_UNUSED(i_payloaddata);
+    ts_stream_t *p_pes = (ts_stream_t *) p_pes_cb_data;
+    assert( p_pes->p_es->fmt.i_codec == VLC_CODEC_SCTE_35 );
+    ts_pmt_t *p_pmt = p_pes->p_es->p_program;
+
+    if( !p_pes->p_es->id || p_pmt->pcr.i_current <= VLC_TS_INVALID )
+        return;
+
+    scte35_splice_t splice;
+    if( !scte35_Parse( p_sectiondata, i_sectiondata, &splice ) )
+    {
+        msg_Dbg( p_demux, "ignoring SCTE-35 command 0x%"PRIx8, splice.i_command );
+        return;
+    }
+
+    block_t *p_content = block_Alloc( i_sectiondata );
+    if( unlikely(!p_content) )
+        return;
+    memcpy( p_content->p_buffer, p_sectiondata, i_sectiondata );
+
+    /* Same time base as the PES timestamps */
+    p_content->i_dts = FROM_SCALE(TimeStampWrapAround( p_pmt->pcr.i_first,
+                                                       p_pmt->pcr.i_current ));
+    if( splice.b_immediate )
+    {
+        p_content->i_pts = p_content->i_dts;
+    }
+    else
+    {
+        p_content->i_pts = FROM_SCALE(TimeStampWrapAround( p_pmt->pcr.i_first,
+                                                           splice.i_pts ));
+        if( p_pmt->pcr.i_pcroffset > 0 )
+            p_content->i_pts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
+    }
+    if( splice.i_duration > 0 )
+        p_content->i_length = FROM_SCALE_NZ(splice.i_duration);
+
+    msg_Dbg( p_demux, "SCTE-35 splice %s event %"PRIu32" at %"PRId64
+             " (in %"PRId64"ms)",
+             splice.i_type == SCTE35_SPLICE_OUT ? "out" : "in", splice.i_event_id,
+             p_content->i_pts, (p_content->i_pts - p_content->i_dts) / 1000 );
+
+    es_out_Send( p_demux->out, p_pes->p_es->id, p_content );
+}
@@ -292,6 +292,10 @@ ts_stream_t *ts_stream_New( demux_t *p_demux, ts_pmt_t *p_program )
     pes->p_proc = NULL;
     pes->prepcr.p_head = NULL;
     pes->prepcr.pp_last = &pes->prepcr.p_head;
+    memset( &pes->analysis, 0, sizeof(pes->analysis) );
+    pes->analysis.i_pts = -1;
+    pes->analysis.i_dts = -1;
+    pes->analysis.i_report_pcr = -1;
 
     return pes;
 }
@@ -137,6 +137,24 @@ struct ts_stream_t
         block_t *p_head;
         block_t **pp_last;
     } prepcr;
+
+    /* PES header analysis (ts-pes-analysis) */
+    struct
+    {
+        uint64_t i_packets;
+        uint64_t i_scrambled;
+        uint32_t i_cc_errors;
+        uint32_t i_pes;
+        uint8_t  i_stream_id;
+        bool     b_pcr_offset;
+        mtime_t  i_pts; /* last PES timestamps, 90kHz */
+        mtime_t  i_dts;
+        mtime_t  i_pcr_offset; /* last PTS minus program PCR, 90kHz */
+        /* bitrate over the last report period */
+        uint64_t i_report_packets;
+        mtime_t  i_report_pcr;
+        uint32_t i_bitrate;
+    } analysis;
 };
 
 typedef struct ts_si_context_t ts_si_context_t;
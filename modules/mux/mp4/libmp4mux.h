@@ -24,13 +24,13 @@
 #include <vlc_es.h>
 #include <vlc_boxes.h>
 
+/* Kept free of padding, as there is one per sample for the whole file */
 typedef struct
 {
     uint64_t i_pos;
-    int      i_size;
-
     mtime_t  i_pts_dts;
     mtime_t  i_length;
+    int      i_size;
     unsigned int i_flags;
 } mp4mux_entry_t;
 
@@ -53,6 +53,20 @@
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
 
+#define MOOVRESERVE_TEXT N_("Reserve index space (seconds)")
+#define MOOVRESERVE_LONGTEXT N_(\
+    "Reserve space for the index of a file of the given duration at its " \
+    "start, so that \"Fast Start\" files do not need to be rewritten when " \
+    "closed. If the index does not fit, the data is moved as usual. " \
+    "0 disables it.")
+
+#define CHUNK_TEXT N_("Chunk duration (ms)")
+#define CHUNK_LONGTEXT N_(\
+    "Write small fragments (CMAF chunks) of the given duration, for low " \
+    "latency chunked delivery. Key frames always start a new chunk, and " \
+    "only those chunks are flagged as stream start points. 0 writes full " \
+    "fragments.")
+
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
 static int  OpenFrag   (vlc_object_t *);
@@ -69,6 +83,9 @@ vlc_module_begin ()
     add_bool(SOUT_CFG_PREFIX "faststart", true,
               FASTSTART_TEXT, FASTSTART_LONGTEXT,
               true)
+    add_integer(SOUT_CFG_PREFIX "moov-reserve", 0,
+                MOOVRESERVE_TEXT, MOOVRESERVE_LONGTEXT, true)
+        change_integer_range(0, 86400)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -79,6 +96,8 @@ add_submodule ()
     set_subcategory(SUBCAT_SOUT_MUX)
     set_shortname("MP4 Frag")
     add_shortcut("mp4frag", "mp4stream")
+    add_integer(SOUT_CFG_PREFIX "chunk", 0, CHUNK_TEXT, CHUNK_LONGTEXT, true)
+        change_integer_range(0, 1500)
     set_capability("sout mux", 0)
     set_callbacks(OpenFrag, CloseFrag)
 
@@ -88,7 +107,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "moov-reserve", "chunk", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -163,6 +182,8 @@ struct sout_mux_sys_t
 
     uint64_t i_mdat_pos;
     uint64_t i_pos;
+    uint64_t i_reserve_pos; /* of the free box reserved for the moov */
+    uint64_t i_reserve;
     mtime_t  i_read_duration;
     mtime_t  i_start_dts;
 
@@ -172,17 +193,47 @@ struct sout_mux_sys_t
 
     /* mp4frag */
     bool           b_fragmented;
+    bool           b_chunked;
+    mtime_t        i_fragment_length;
     mtime_t        i_written_duration;
     uint32_t       i_mfhd_sequence;
 };
 
 static void box_send(sout_mux_t *p_mux,  bo_t *box);
 static bo_t *BuildMoov(sout_mux_t *p_mux);
+static bool MoveData(sout_mux_t *, uint64_t, uint64_t, uint64_t);
 
 static block_t *ConvertSUBT(block_t *);
 static bool CreateCurrentEdit(mp4_stream_t *, mtime_t, bool);
 static void DebugEdits(sout_mux_t *, const mp4_stream_t *);
 
+/* Upper bound of the moov size for the given duration: the sample tables
+ * take at most 28 bytes per sample (stsz, stts, ctts and 64-bits stco) */
+static uint64_t EstimateMoovSize(const sout_mux_sys_t *p_sys, unsigned i_duration)
+{
+    uint64_t i_size = 4096;
+
+    for (unsigned i = 0; i < p_sys->i_nb_streams; i++) {
+        const es_format_t *p_fmt = &p_sys->pp_streams[i]->mux.fmt;
+        unsigned i_rate; /* samples per second */
+
+        switch (p_fmt->i_cat) {
+        case VIDEO_ES:
+            i_rate = (p_fmt->video.i_frame_rate + p_fmt->video.i_frame_rate_base - 1)
+                   / p_fmt->video.i_frame_rate_base;
+            break;
+        case AUDIO_ES:
+            i_rate = (p_fmt->audio.i_rate + 1023) / 1024;
+            break;
+        default:
+            i_rate = 2;
+            break;
+        }
+        i_size += 1024 + (uint64_t)i_rate * i_duration * 28;
+    }
+    return i_size;
+}
+
 static int WriteSlowStartHeader(sout_mux_t *p_mux)
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
@@ -209,6 +260,25 @@ static int WriteSlowStartHeader(sout_mux_t *p_mux)
         box_send(p_mux, box);
     }
 
+    unsigned i_duration = var_GetInteger(p_mux, SOUT_CFG_PREFIX "moov-reserve");
+    if (p_sys->b_fast_start && i_duration > 0) {
+        uint64_t i_size = EstimateMoovSize(p_sys, i_duration);
+        block_t *p_free = block_Alloc(i_size);
+        if (!p_free)
+            return VLC_ENOMEM;
+
+        SetDWBE(p_free->p_buffer, i_size);
+        memcpy(&p_free->p_buffer[4], "free", 4);
+        memset(&p_free->p_buffer[8], 0, i_size - 8);
+
+        msg_Dbg(p_mux, "reserving %"PRIu64" bytes for the moov", i_size);
+        p_sys->i_reserve_pos = p_sys->i_pos;
+        p_sys->i_reserve = i_size;
+        p_sys->i_pos += i_size;
+        p_sys->i_mdat_pos = p_sys->i_pos;
+        sout_AccessOutWrite(p_mux->p_access, p_free);
+    }
+
     /* Now add mdat header */
     box = box_new("mdat");
     if(!box)
@@ -246,8 +316,11 @@ static int Open(vlc_object_t *p_this)
     p_sys->i_nb_streams = 0;
     p_sys->pp_streams   = NULL;
     p_sys->i_mdat_pos   = 0;
+    p_sys->i_reserve_pos = 0;
+    p_sys->i_reserve    = 0;
     p_sys->b_mov        = p_mux->psz_mux && !strcmp(p_mux->psz_mux, "mov");
     p_sys->b_3gp        = p_mux->psz_mux && !strcmp(p_mux->psz_mux, "3gp");
+    p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
     p_sys->i_read_duration   = 0;
     p_sys->i_start_dts = VLC_TS_INVALID;
     p_sys->b_fragmented = false;
@@ -295,59 +368,65 @@ static void Close(vlc_object_t *p_this)
     bo_t *moov = BuildMoov(p_mux);
 
     /* Check we need to create "fast start" files */
-    p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
-    while (p_sys->b_fast_start && moov && moov->b) {
-        /* Move data to the end of the file so we can fit the moov header
-         * at the start */
-        int64_t i_size = p_sys->i_pos - p_sys->i_mdat_pos;
-        int i_moov_size = moov->b->i_buffer;
-
-        while (i_size > 0) {
-            int64_t i_chunk = __MIN(32768, i_size);
-            block_t *p_buf = block_Alloc(i_chunk);
-            sout_AccessOutSeek(p_mux->p_access,
-                                p_sys->i_mdat_pos + i_size - i_chunk);
-            if (sout_AccessOutRead(p_mux->p_access, p_buf) < i_chunk) {
-                msg_Warn(p_this, "read() not supported by access output, "
-                          "won't create a fast start file");
-                p_sys->b_fast_start = false;
-                block_Release(p_buf);
-                break;
+    if (p_sys->b_fast_start && moov && moov->b) {
+        const uint64_t i_moov_size = moov->b->i_buffer;
+        uint64_t i_shift;
+
+        /* The moov goes in the reserved space, if any, followed by a free
+         * box for the remainder. Otherwise the data is moved to make room. */
+        if (i_moov_size == p_sys->i_reserve || i_moov_size + 8 <= p_sys->i_reserve)
+            i_shift = 0;
+        else if (i_moov_size > p_sys->i_reserve)
+            i_shift = i_moov_size - p_sys->i_reserve;
+        else /* no room for the free box header */
+            i_shift = i_moov_size + 8 - p_sys->i_reserve;
+
+        if (i_shift > 0 && p_sys->i_reserve > 0)
+            msg_Warn(p_this, "moov of %"PRIu64" bytes does not fit in the "
+                     "reserved space, moving the data", i_moov_size);
+
+        if (i_shift > 0 && !MoveData(p_mux, p_sys->i_mdat_pos,
+                                     p_sys->i_pos - p_sys->i_mdat_pos, i_shift)) {
+            msg_Warn(p_this, "read() not supported by access output, "
+                      "won't create a fast start file");
+        } else {
+            /* Update pos pointers */
+            i_moov_pos = p_sys->i_reserve > 0 ? p_sys->i_reserve_pos
+                                              : p_sys->i_mdat_pos;
+            p_sys->i_mdat_pos += i_shift;
+
+            /* Fix-up samples to chunks table in MOOV header */
+            for (unsigned int i_trak = 0; i_shift > 0 && i_trak < p_sys->i_nb_streams; i_trak++) {
+                mp4_stream_t *p_stream = p_sys->pp_streams[i_trak];
+                unsigned i_written = 0;
+                for (unsigned i = 0; i < p_stream->mux.i_entry_count; ) {
+                    mp4mux_entry_t *entry = p_stream->mux.entry;
+                    if (b_stco64)
+                        bo_set_64be(moov, p_stream->mux.i_stco_pos + i_written++ * 8, entry[i].i_pos + i_shift);
+                    else
+                        bo_set_32be(moov, p_stream->mux.i_stco_pos + i_written++ * 4, entry[i].i_pos + i_shift);
+
+                    for (; i < p_stream->mux.i_entry_count; i++)
+                        if (i >= p_stream->mux.i_entry_count - 1 ||
+                            entry[i].i_pos + entry[i].i_size != entry[i+1].i_pos) {
+                            i++;
+                            break;
+                        }
+                }
             }
-            sout_AccessOutSeek(p_mux->p_access, p_sys->i_mdat_pos + i_size +
-                                i_moov_size - i_chunk);
-            sout_AccessOutWrite(p_mux->p_access, p_buf);
-            i_size -= i_chunk;
-        }
-
-        if (!p_sys->b_fast_start)
-            break;
 
-        /* Update pos pointers */
-        i_moov_pos = p_sys->i_mdat_pos;
-        p_sys->i_mdat_pos += moov->b->i_buffer;
-
-        /* Fix-up samples to chunks table in MOOV header */
-        for (unsigned int i_trak = 0; i_trak < p_sys->i_nb_streams; i_trak++) {
-            mp4_stream_t *p_stream = p_sys->pp_streams[i_trak];
-            unsigned i_written = 0;
-            for (unsigned i = 0; i < p_stream->mux.i_entry_count; ) {
-                mp4mux_entry_t *entry = p_stream->mux.entry;
-                if (b_stco64)
-                    bo_set_64be(moov, p_stream->mux.i_stco_pos + i_written++ * 8, entry[i].i_pos + p_sys->i_mdat_pos - i_moov_pos);
-                else
-                    bo_set_32be(moov, p_stream->mux.i_stco_pos + i_written++ * 4, entry[i].i_pos + p_sys->i_mdat_pos - i_moov_pos);
-
-                for (; i < p_stream->mux.i_entry_count; i++)
-                    if (i >= p_stream->mux.i_entry_count - 1 ||
-                        entry[i].i_pos + entry[i].i_size != entry[i+1].i_pos) {
-                        i++;
-                        break;
-                    }
+            /* Turn the rest of the reserved space into a free box */
+            const uint64_t i_free = p_sys->i_reserve + i_shift - i_moov_size;
+            if (i_free > 0) {
+                bo_t free_box;
+                if (bo_init(&free_box, 8)) {
+                    bo_add_32be  (&free_box, i_free);
+                    bo_add_fourcc(&free_box, "free");
+                    sout_AccessOutSeek(p_mux->p_access, i_moov_pos + i_moov_size);
+                    sout_AccessOutWrite(p_mux->p_access, free_box.b);
+                }
             }
         }
-
-        p_sys->b_fast_start = false;
     }
 
     /* Write MOOV header */
@@ -800,6 +879,30 @@ static void box_send(sout_mux_t *p_mux,  bo_t *box)
     free(box);
 }
 
+#define MOVE_CHUNK_SIZE (4 * 1024 * 1024)
+
+/* Moves i_size bytes at i_pos i_shift bytes forward, starting from the end */
+static bool MoveData(sout_mux_t *p_mux, uint64_t i_pos, uint64_t i_size,
+                     uint64_t i_shift)
+{
+    while (i_size > 0) {
+        size_t i_chunk = __MIN(MOVE_CHUNK_SIZE, i_size);
+        block_t *p_buf = block_Alloc(i_chunk);
+        if (!p_buf)
+            return false;
+
+        sout_AccessOutSeek(p_mux->p_access, i_pos + i_size - i_chunk);
+        if (sout_AccessOutRead(p_mux->p_access, p_buf) < (ssize_t)i_chunk) {
+            block_Release(p_buf);
+            return false;
+        }
+        sout_AccessOutSeek(p_mux->p_access, i_pos + i_size + i_shift - i_chunk);
+        sout_AccessOutWrite(p_mux->p_access, p_buf);
+        i_size -= i_chunk;
+    }
+    return true;
+}
+
 /***************************************************************************
     MP4 Live submodule
 ****************************************************************************/
@@ -869,6 +972,7 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
 
     bo_t            *moof, *mfhd;
     size_t           i_fixupoffset = 0;
+    bool             b_start_point = true;
 
     *pi_mdat_total_size = 0;
 
@@ -968,7 +1072,10 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
             uint32_t i_trun_flags = 0x0;
 
             if (p_stream->b_hasiframes && !(p_stream->read.p_first->p_block->i_flags & BLOCK_FLAG_TYPE_I))
+            {
                 i_trun_flags |= MP4_TRUN_FIRST_FLAGS;
+                b_start_point = false;
+            }
 
             if (!b_allsamelength ||
                 ( !(i_tfhd_flags & MP4_TFHD_DFLT_SAMPLE_DURATION) && p_stream->mux.i_trex_default_length == 0 ))
@@ -997,7 +1104,8 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
             mp4_fragentry_t *p_entry = p_stream->read.p_first;
             while(p_entry)
             {
-                if ( i_barrier_time && i_run_time + p_entry->p_block->i_length > i_barrier_time )
+                if ( i_barrier_time && i_entry_count > 0 &&
+                     i_run_time + p_entry->p_block->i_length > i_barrier_time )
                     break;
                 i_entry_count++;
                 i_run_time += p_entry->p_block->i_length;
@@ -1072,26 +1180,37 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
         bo_set_32be(moof, i_fixupoffset, moof->b->i_buffer + 8);
     }
 
-    /* set iframe flag, so the streaming server always starts from moof */
-    moof->b->i_flags |= BLOCK_FLAG_TYPE_I;
+    /* set iframe flag, so the streaming server always starts from moof.
+     * Chunks are only valid start points if they start with key frames. */
+    if (b_start_point || !p_sys->b_chunked)
+        moof->b->i_flags |= BLOCK_FLAG_TYPE_I;
 
     return moof;
 }
 
-static void WriteFragmentMDAT(sout_mux_t *p_mux, size_t i_total_size)
+/* Writes the moof, the mdat header and the samples in a single chain, with
+ * no copy of the samples */
+static void WriteFragmentMDAT(sout_mux_t *p_mux, block_t *p_moof, size_t i_total_size)
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
+    block_t **pp_last = &p_moof->p_next;
+
+    p_sys->i_pos += p_moof->i_buffer;
 
     /* Now add mdat header */
     bo_t *mdat = box_new("mdat");
     if(!mdat)
+    {
+        block_Release(p_moof);
         return;
+    }
     /* force update of real size */
     assert(mdat->b->i_buffer==8);
     box_fix(mdat, mdat->b->i_buffer + i_total_size);
     p_sys->i_pos += mdat->b->i_buffer;
     /* only write header */
-    sout_AccessOutWrite(p_mux->p_access, mdat->b);
+    *pp_last = mdat->b;
+    pp_last = &mdat->b->p_next;
     free(mdat);
     /* Header and its size are written and good, now write content */
     for (unsigned int i_trak = 0; i_trak < p_sys->i_nb_streams; i_trak++)
@@ -1105,7 +1224,8 @@ static void WriteFragmentMDAT(sout_mux_t *p_mux, size_t i_total_size)
             p_stream->i_written_duration += p_entry->p_block->i_length;
 
             p_entry->p_block->i_flags &= ~BLOCK_FLAG_TYPE_I; // clear flag for http stream
-            sout_AccessOutWrite(p_mux->p_access, p_entry->p_block);
+            *pp_last = p_entry->p_block;
+            pp_last = &p_entry->p_block->p_next;
 
             p_stream->towrite.p_first = p_entry->p_next;
             free(p_entry);
@@ -1113,6 +1233,8 @@ static void WriteFragmentMDAT(sout_mux_t *p_mux, size_t i_total_size)
                 p_stream->towrite.p_last = NULL;
         }
     }
+
+    sout_AccessOutWrite(p_mux->p_access, p_moof);
 }
 
 static bo_t *GetMfraBox(sout_mux_t *p_mux)
@@ -1202,6 +1324,8 @@ static int OpenFrag(vlc_object_t *p_this)
     if (!p_sys)
         return VLC_ENOMEM;
 
+    config_ChainParse(p_mux, SOUT_CFG_PREFIX, ppsz_sout_options, p_mux->p_cfg);
+
     p_mux->p_sys = (sout_mux_sys_t *) p_sys;
     p_mux->pf_control   = Control;
     p_mux->pf_addstream = AddStream;
@@ -1223,9 +1347,19 @@ static int OpenFrag(vlc_object_t *p_this)
 
     p_sys->b_header_sent = false;
     p_sys->b_fragmented  = true;
+    p_sys->b_chunked     = false;
+    p_sys->i_fragment_length = FRAGMENT_LENGTH;
     p_sys->i_start_dts = VLC_TS_INVALID;
     p_sys->i_mfhd_sequence = 1;
 
+    int64_t i_chunk = var_GetInteger(p_mux, SOUT_CFG_PREFIX "chunk");
+    if (i_chunk > 0)
+    {
+        p_sys->b_chunked = true;
+        p_sys->i_fragment_length = i_chunk * 1000;
+        msg_Dbg(p_mux, "writing chunks of %"PRId64" ms", i_chunk);
+    }
+
     return VLC_SUCCESS;
 }
 
@@ -1233,7 +1367,7 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
     bo_t *moof = NULL;
-    mtime_t i_barrier_time = p_sys->i_written_duration + FRAGMENT_LENGTH;
+    mtime_t i_barrier_time = p_sys->i_written_duration + p_sys->i_fragment_length;
     size_t i_mdat_size = 0;
     bool b_has_samples = false;
 
@@ -1279,12 +1413,11 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 
     if (moof)
     {
+        block_t *p_moof = moof->b;
+        free(moof);
+
         msg_Dbg(p_mux, "writing moof @ %"PRId64, p_sys->i_pos);
-        p_sys->i_pos += moof->b->i_buffer;
-        assert(moof->b->i_flags & BLOCK_FLAG_TYPE_I); /* http sout */
-        box_send(p_mux, moof);
-        msg_Dbg(p_mux, "writing mdat @ %"PRId64, p_sys->i_pos);
-        WriteFragmentMDAT(p_mux, i_mdat_size);
+        WriteFragmentMDAT(p_mux, p_moof, i_mdat_size);
 
         /* update iframe point */
         for (unsigned int i = 0; i < p_sys->i_nb_streams; i++)
@@ -1446,7 +1579,7 @@ static int MuxFrag(sout_mux_t *p_mux)
         p_stream->p_held_entry = NULL;
 
         if (p_stream->b_hasiframes && (p_heldblock->i_flags & BLOCK_FLAG_TYPE_I) &&
-            p_stream->mux.i_read_duration - p_sys->i_written_duration < FRAGMENT_LENGTH)
+            p_stream->mux.i_read_duration - p_sys->i_written_duration < p_sys->i_fragment_length)
         {
             /* Flag the last iframe time, we'll use it as boundary so it will start
                next fragment */
@@ -1495,7 +1628,7 @@ static int MuxFrag(sout_mux_t *p_mux)
     p_sys->i_written_duration = i_min_written_duration;
 
     /* we have prerolled enough to know all streams, and have enough date to create a fragment */
-    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= FRAGMENT_LENGTH)
+    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= p_sys->i_fragment_length)
         WriteFragments(p_mux, false);
 
     return VLC_SUCCESS;
@@ -419,6 +419,19 @@ static inline size_t Write_AnnexA_String( uint8_t *p_dest, const char *p_src )
     }
 }
 
+static bool PMTHasRegistration( const dvbpsi_pmt_t *p_pmt,
+                                const uint8_t format[4] )
+{
+    for( const dvbpsi_descriptor_t *p_dr = p_pmt->p_first_descriptor;
+         p_dr != NULL; p_dr = p_dr->p_next )
+    {
+        if( p_dr->i_tag == 0x05 && p_dr->i_length >= 4 &&
+            !memcmp( p_dr->p_data, format, 4 ) )
+            return true;
+    }
+    return false;
+}
+
 void BuildPMT( dvbpsi_t *p_dvbpsi, vlc_object_t *p_object,
                ts_mux_standard standard,
                void *p_opaque, PEStoTSCallback pf_callback,
@@ -614,6 +627,15 @@ void BuildPMT( dvbpsi_t *p_dvbpsi, vlc_object_t *p_object,
             /* "registration" descriptor : "Opus" */
             dvbpsi_pmt_es_descriptor_add( p_es, 0x05, 4, format );
         }
+        else if( p_stream->fmt->i_codec == VLC_CODEC_SCTE_35 )
+        {
+            /* SCTE-35 requires the "CUEI" registration in the program loop,
+             * once whatever the number of splice information streams */
+            uint8_t format[4] = { 'C', 'U', 'E', 'I' };
+            dvbpsi_pmt_t *p_prog = &dvbpmt[p_stream->i_mapped_prog];
+            if( !PMTHasRegistration( p_prog, format ) )
+                dvbpsi_pmt_descriptor_add( p_prog, 0x05, 4, format );
+        }
         else if( p_stream->fmt->i_codec == VLC_CODEC_TELETEXT )
         {
             if( p_stream->fmt->i_extra )
@@ -868,6 +890,14 @@ int FillPMTESParams( ts_mux_standard standard, const es_format_t *fmt,
         pes->i_stream_id = 0xbd; /* FIXME */
         break;
 
+    /* DATA */
+
+    case VLC_CODEC_SCTE_35:
+        /* sent as sections, not PES */
+        ts->i_stream_type = 0x86;
+        pes->i_stream_id = 0xfc;
+        break;
+
     default:
         return VLC_EGENERIC;
     }
@@ -63,6 +63,7 @@
 #include "tables.h"
 
 #include "../../codec/jpeg2000.h"
+#include "../../codec/scte35.h"
 
 /*
  * TODO:
@@ -159,6 +160,14 @@ static const char *const ts_standards_list_text[] =
 #define BMAX_TEXT N_( "Maximum B (deprecated)")
 #define BMAX_LONGTEXT N_( "This setting is deprecated and not used anymore")
 
+#define MUXRATE_TEXT N_("Constant mux rate (bits/s)")
+#define MUXRATE_LONGTEXT N_("Output a constant bitrate stream, padded with " \
+  "null packets, at the given rate. The packets are scheduled so that the " \
+  "transport and main buffers of the decoder model (T-STD) do not " \
+  "overflow, and the PCRs match the position of their packet in the " \
+  "stream. The rate must exceed the peak bitrate of the elementary " \
+  "streams over the shaping delay. 0 disables it.")
+
 #define DTS_TEXT N_("DTS delay (ms)")
 #define DTS_LONGTEXT N_("Delay the DTS (decoding time " \
   "stamps) and PTS (presentation timestamps) of the data in the " \
@@ -196,6 +205,8 @@ static const char *const ts_standards_list_text[] =
 
 #define BLOCK_FLAG_NO_KEYFRAME (1 << BLOCK_FLAG_PRIVATE_SHIFT) /* This is not a key frame for bitrate shaping */
 
+#define MAX_SPLICES 8    /* Pending SCTE-35 splice points */
+
 vlc_module_begin ()
     set_description( N_("TS muxer (libdvbpsi)") )
     set_shortname( "MPEG-TS")
@@ -228,6 +239,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "pcr", 70, PCR_TEXT, PCR_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "bmin", 0, BMIN_TEXT, BMIN_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "bmax", 0, BMAX_TEXT, BMAX_LONGTEXT, true)
+    add_integer( SOUT_CFG_PREFIX "muxrate", 0, MUXRATE_TEXT, MUXRATE_LONGTEXT, true)
+        change_integer_range( 0, INT64_C(1) << 32 )
     add_integer( SOUT_CFG_PREFIX "dts-delay", 400, DTS_TEXT, DTS_LONGTEXT, true)
 
     add_bool( SOUT_CFG_PREFIX "crypt-audio", true, ACRYPT_TEXT, ACRYPT_LONGTEXT, true)
@@ -249,7 +262,7 @@ static const char *const ppsz_sout_options[] = {
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "bmin", "bmax", "use-key-frames",
     "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
-    "muxpmt", "program-pmt", "alignment",
+    "muxpmt", "program-pmt", "alignment", "muxrate",
     NULL
 };
 
@@ -333,11 +346,46 @@ typedef struct
 
 } pes_state_t;
 
+/* Transport buffer (TB) of the T-STD model, ISO/IEC 13818-1 2.4.2.3 */
+#define TSTD_TB_SIZE 512
+
+typedef struct
+{
+    double          f_fullness; /* bytes */
+    double          f_peak;     /* since the last report */
+    int64_t         i_rate;     /* leak rate in bits/s */
+    int64_t         i_date;     /* of the last update, in 27 MHz units */
+} tstd_buffer_t;
+
+/* Main buffer of the T-STD model: MB and EB merged for the video, B for the
+ * audio. The data is removed one access unit at a time, at its decoding
+ * time. It is counted in whole TS packets, which errs on the safe side. */
+#define TSTD_AU_MAX 256
+
+typedef struct
+{
+    int64_t         i_size;      /* bytes, 0 if not modeled */
+    int64_t         i_fullness;  /* bytes sent and not decoded yet */
+    int64_t         i_peak;      /* since the last report */
+    unsigned        i_underflow; /* packets sent after their decoding time */
+
+    /* Access units not decoded yet */
+    struct
+    {
+        int64_t     i_date;      /* decoding time, in 27 MHz units */
+        int64_t     i_bytes;
+    } au[TSTD_AU_MAX];
+    unsigned        i_au_first;
+    unsigned        i_au_count;
+} tstd_main_buffer_t;
+
 typedef struct
 {
     tsmux_stream_t  ts;
     pesmux_stream_t pes;
     pes_state_t  state;
+    tstd_buffer_t tb;
+    tstd_main_buffer_t b;
 } sout_input_sys_t;
 
 struct sout_mux_sys_t
@@ -367,6 +415,12 @@ struct sout_mux_sys_t
     sdt_psi_t       sdt;
     ts_mux_standard standard;
 
+    /* TS packets of the current PAT, and of the current PMTs and SDT.
+     * They are only rebuilt when the tables change, the repetitions are
+     * copies with updated continuity counters. */
+    block_t         *p_pat_cache;
+    block_t         *p_pmt_cache;
+
     /* for TS building */
     int64_t         i_bitrate_min;
     int64_t         i_bitrate_max;
@@ -381,6 +435,29 @@ struct sout_mux_sys_t
 
     mtime_t         i_pcr;  /* last PCR emited */
 
+    /* SCTE-35 splice points not reached yet, the first video keyframe at
+     * or after each of them starts with PAT/PMT and is flagged */
+    struct
+    {
+        mtime_t     i_date;
+        uint32_t    i_flag; /* BLOCK_FLAG_SPLICE_* */
+    } splices[MAX_SPLICES];
+    unsigned        i_splices;
+
+    /* constant mux rate, 0 if disabled */
+    int64_t         i_muxrate;
+    struct
+    {
+        int64_t     i_clock;     /* date of the next packet, in 27 MHz units */
+        int64_t     i_step;      /* duration of a packet, in 27 MHz units */
+        int64_t     i_step_rem;  /* ... and its remainder, over i_muxrate */
+        int64_t     i_frac;
+        int64_t     i_report;
+        unsigned    i_packets;   /* since the last report */
+        unsigned    i_stuffing;
+        unsigned    i_late;
+    } cbr;
+
     csa_t           *csa;
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
@@ -481,7 +558,10 @@ static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
+static void TSDateCBR   ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                          mtime_t i_pcr_length, mtime_t i_pcr_dts );
 static void TSSetPCR( block_t *p_ts, mtime_t i_dts );
+static void TSSetPCR27( block_t *p_ts, int64_t i_pcr );
 
 static csa_t *csaSetup( vlc_object_t *p_this )
 {
@@ -735,6 +815,16 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    p_sys->i_muxrate = var_GetInteger( p_mux, SOUT_CFG_PREFIX "muxrate" );
+    if( p_sys->i_muxrate > 0 )
+    {
+        /* 188 bytes at i_muxrate, exactly */
+        p_sys->cbr.i_step = INT64_C(188 * 8) * 27000000 / p_sys->i_muxrate;
+        p_sys->cbr.i_step_rem = INT64_C(188 * 8) * 27000000 % p_sys->i_muxrate;
+        msg_Dbg( p_mux, "constant mux rate of %"PRId64" bits/s",
+                 p_sys->i_muxrate );
+    }
+
     p_mux->p_sys        = p_sys;
 
     p_sys->csa = csaSetup(p_this);
@@ -773,6 +863,8 @@ static void Close( vlc_object_t * p_this )
         free( p_sys->sdt.desc[i].psz_provider );
     }
 
+    block_ChainRelease( p_sys->p_pat_cache );
+    block_ChainRelease( p_sys->p_pmt_cache );
     free( p_sys );
 }
 
@@ -973,8 +1065,56 @@ static int AddStream( sout_mux_t *p_mux, sout_input_t *p_input )
     /* Init pes chain */
     BufferChainInit( &p_stream->state.chain_pes );
 
+    /* Transport buffer leak rates of the T-STD. The video one depends on the
+     * profile and level, assume at least MP@ML. The other streams use the
+     * audio (2 Mbit/s) and system (1 Mbit/s) rates. */
+    switch( p_input->p_fmt->i_cat )
+    {
+        case VIDEO_ES:
+            p_stream->tb.i_rate = __MAX( p_input->p_fmt->i_bitrate,
+                                         15000000 ) * INT64_C(6) / 5;
+            break;
+        case AUDIO_ES:
+            p_stream->tb.i_rate = 2000000;
+            break;
+        default:
+            p_stream->tb.i_rate = 1000000;
+            break;
+    }
+
+    /* Main buffer sizes of the T-STD, ISO/IEC 13818-1 2.4.2.7 and 2.4.2.8.
+     * MPEG video gets the VBV buffer of MP@ML and its multiplex buffer; the
+     * other video codecs get 1.2 times the CPB of the H.264 level 4. The
+     * audio gets BSn, and the other streams are not modeled. */
+    switch( p_input->p_fmt->i_cat )
+    {
+        case VIDEO_ES:
+            if( p_input->p_fmt->i_codec == VLC_CODEC_MPGV ||
+                p_input->p_fmt->i_codec == VLC_CODEC_MP2V )
+            {
+                /* BSmux is 4 ms and BSoh 1/750 s at the maximum rate */
+                const int64_t i_rmax = p_stream->tb.i_rate * 5 / 6;
+                p_stream->b.i_size = 1835008 / 8
+                                   + i_rmax / 250 / 8 + i_rmax / 750 / 8;
+            }
+            else
+                p_stream->b.i_size = 30000000 / 8;
+            break;
+        case AUDIO_ES:
+            if( p_input->p_fmt->i_codec == VLC_CODEC_MP4A &&
+                p_input->p_fmt->audio.i_channels > 2 )
+                p_stream->b.i_size = 8976;
+            else
+                p_stream->b.i_size = 3584;
+            break;
+        default:
+            break;
+    }
+
     /* We only change PMT version (PAT isn't changed) */
     p_sys->i_pmt_version_number = ( p_sys->i_pmt_version_number + 1 )%32;
+    block_ChainRelease( p_sys->p_pmt_cache );
+    p_sys->p_pmt_cache = NULL;
 
     /* Update pcr_pid */
     SelectPCRStream( p_mux, NULL );
@@ -1035,10 +1175,12 @@ static void DelStream( sout_mux_t *p_mux, sout_input_t *p_input )
     /* We only change PMT version (PAT isn't changed) */
     p_sys->i_pmt_version_number++;
     p_sys->i_pmt_version_number %= 32;
+    block_ChainRelease( p_sys->p_pmt_cache );
+    p_sys->p_pmt_cache = NULL;
 }
 
 static void SetHeader( sout_buffer_chain_t *c,
-                        int depth )
+                        int depth, uint32_t i_flags )
 {
     block_t *p_ts = BufferChainPeek( c );
     while( depth > 0 )
@@ -1046,7 +1188,68 @@ static void SetHeader( sout_buffer_chain_t *c,
         p_ts = p_ts->p_next;
         depth--;
     }
-    p_ts->i_flags |= BLOCK_FLAG_HEADER;
+    p_ts->i_flags |= BLOCK_FLAG_HEADER | i_flags;
+}
+
+/* SCTE-35 sections are sent as is after a pointer_field, with their
+ * pts_adjustment shifted like the PES timestamps. Their splice point is
+ * queued to flag the matching video keyframe. */
+static block_t *Encap_SCTE35( sout_mux_t *p_mux, block_t *p_data )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    scte35_splice_t splice;
+
+    if( !scte35_Parse( p_data->p_buffer, p_data->i_buffer, &splice ) )
+    {
+        block_Release( p_data );
+        return NULL;
+    }
+
+    if( !splice.b_immediate )
+    {
+        const int64_t i_date = ( p_data->i_pts -
+                                 ( p_sys->first_dts - p_sys->i_dts_delay ) ) * 9 / 100;
+        scte35_SetPTSAdjustment( p_data->p_buffer, p_data->i_buffer,
+                                 scte35_get_33bits( &p_data->p_buffer[4] ) +
+                                 i_date - splice.i_pts );
+    }
+
+    if( p_sys->i_splices == MAX_SPLICES )
+    {
+        msg_Warn( p_mux, "too many pending splice points, dropping one" );
+        p_sys->i_splices--;
+        memmove( &p_sys->splices[0], &p_sys->splices[1],
+                 p_sys->i_splices * sizeof(*p_sys->splices) );
+    }
+    p_sys->splices[p_sys->i_splices].i_date = splice.b_immediate ? p_data->i_dts
+                                                                 : p_data->i_pts;
+    p_sys->splices[p_sys->i_splices].i_flag =
+        splice.i_type == SCTE35_SPLICE_OUT ? BLOCK_FLAG_SPLICE_OUT
+                                           : BLOCK_FLAG_SPLICE_IN;
+    p_sys->i_splices++;
+
+    msg_Dbg( p_mux, "splice %s point at %"PRId64,
+             splice.i_type == SCTE35_SPLICE_OUT ? "out" : "in",
+             p_sys->splices[p_sys->i_splices - 1].i_date );
+
+    p_data = block_Realloc( p_data, 1, p_data->i_buffer );
+    if( p_data )
+        p_data->p_buffer[0] = 0x00; /* pointer_field */
+    return p_data;
+}
+
+/* Returns the splice flags of a video keyframe, and consumes the splice
+ * points it reaches */
+static uint32_t GetSplice( sout_mux_sys_t *p_sys, mtime_t i_date )
+{
+    uint32_t i_flags = 0;
+    unsigned i = 0;
+    while( i < p_sys->i_splices && p_sys->splices[i].i_date <= i_date )
+        i_flags = p_sys->splices[i++].i_flag;
+    p_sys->i_splices -= i;
+    memmove( &p_sys->splices[0], &p_sys->splices[i],
+             p_sys->i_splices * sizeof(*p_sys->splices) );
+    return i_flags;
 }
 
 static block_t *Pack_Opus(block_t *p_data)
@@ -1339,8 +1542,16 @@ static bool MuxStreams(sout_mux_t *p_mux )
         int i_header_size = 0;
         int i_max_pes_size = 0;
         int b_data_alignment = 0;
+        bool b_section = false;
         if( p_input->p_fmt->i_cat == SPU_ES ) switch (p_input->p_fmt->i_codec)
         {
+        case VLC_CODEC_SCTE_35:
+            p_data = Encap_SCTE35( p_mux, p_data );
+            if( !p_data )
+                continue;
+            b_section = true;
+            break;
+
         case VLC_CODEC_SUBT:
             /* Prepend header */
             p_data = block_Realloc( p_data, 2, p_data->i_buffer );
@@ -1427,9 +1638,10 @@ static bool MuxStreams(sout_mux_t *p_mux )
             i_max_pes_size = INT_MAX;
         }
 
-        EStoPES ( &p_data, p_input->p_fmt, p_stream->pes.i_stream_id,
-                       1, b_data_alignment, i_header_size,
-                       i_max_pes_size, p_sys->first_dts - p_sys->i_dts_delay );
+        if( !b_section )
+            EStoPES ( &p_data, p_input->p_fmt, p_stream->pes.i_stream_id,
+                           1, b_data_alignment, i_header_size,
+                           i_max_pes_size, p_sys->first_dts - p_sys->i_dts_delay );
 
         BufferChainAppend( &p_stream->state.chain_pes, p_data );
 
@@ -1517,6 +1729,18 @@ static bool MuxStreams(sout_mux_t *p_mux )
         p_stream = (sout_input_sys_t*)p_mux->pp_inputs[i_stream]->p_sys;
         sout_input_t *p_input = p_mux->pp_inputs[i_stream];
 
+        /* Keyframe splice point, from the PES timestamp */
+        uint32_t i_splice = 0;
+        if( p_sys->i_splices && p_input->p_fmt->i_cat == VIDEO_ES &&
+            p_stream->state.i_pes_used == 0 )
+        {
+            const block_t *p_pes = p_stream->state.chain_pes.p_first;
+            if( (p_pes->i_flags & BLOCK_FLAG_TYPE_I) &&
+               !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME) )
+                i_splice = GetSplice( p_sys, p_pes->i_pts > VLC_TS_INVALID ?
+                                             p_pes->i_pts : p_pes->i_dts );
+        }
+
         /* do we need to issue pcr */
         bool b_pcr = false;
         if( p_stream == p_pcr_stream &&
@@ -1539,9 +1763,10 @@ static bool MuxStreams(sout_mux_t *p_mux )
         i_packet_pos++;
 
         /* Write PAT/PMT before every keyframe if use-key-frames is enabled,
+         * and before splice points,
          * this helps to do segmenting with livehttp-output so it can cut segment
          * and start new one with pat,pmt,keyframe*/
-        if( ( p_sys->b_use_key_frames ) &&
+        if( ( p_sys->b_use_key_frames || i_splice ) &&
             ( p_input->p_fmt->i_cat == VIDEO_ES ) &&
             ( p_ts->i_flags & BLOCK_FLAG_TYPE_I ) )
         {
@@ -1550,10 +1775,10 @@ static bool MuxStreams(sout_mux_t *p_mux )
                 int startcount = chain_ts.i_depth;
                 GetPAT( p_mux, &chain_ts );
                 GetPMT( p_mux, &chain_ts );
-                SetHeader( &chain_ts, startcount );
+                SetHeader( &chain_ts, startcount, i_splice );
                 i_packet_count += (chain_ts.i_depth - startcount );
             } else {
-                SetHeader( &chain_ts, 0); //We just inserted pat/pmt,so just flag it instead of adding new one
+                SetHeader( &chain_ts, 0, i_splice ); //We just inserted pat/pmt,so just flag it instead of adding new one
             }
         }
         pat_was_previous = false;
@@ -1563,7 +1788,10 @@ static bool MuxStreams(sout_mux_t *p_mux )
     }
 
     /* 4: date and send */
-    TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    if( p_sys->i_muxrate > 0 )
+        TSDateCBR( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    else
+        TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
     return false;
 }
 
@@ -1804,6 +2032,250 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     }
 }
 
+/*
+ * Constant mux rate
+ *
+ * The packets are sent at fixed intervals, on a 27 MHz clock. A packet is
+ * only sent if it fits in the transport and main buffers of its stream: the
+ * buffers of the other packets of the look ahead window may have room. Null
+ * packets fill the slots where nothing can be sent.
+ */
+#define CBR_LOOKAHEAD 32
+
+static sout_input_sys_t *GetInputByPID( sout_mux_t *p_mux, uint16_t i_pid )
+{
+    for (int i = 0; i < p_mux->i_nb_inputs; i++ )
+    {
+        sout_input_sys_t *p_stream = (sout_input_sys_t*)p_mux->pp_inputs[i]->p_sys;
+        if( p_stream->ts.i_pid == i_pid )
+            return p_stream;
+    }
+    return NULL; /* PSI, not modeled */
+}
+
+/* Leaks the transport buffer up to i_date, and tells if a packet fits */
+static bool TSTDHasRoom( tstd_buffer_t *p_tb, int64_t i_date )
+{
+    if( i_date > p_tb->i_date )
+    {
+        p_tb->f_fullness -= (double)p_tb->i_rate * ( i_date - p_tb->i_date )
+                            / ( 8 * 27000000. );
+        if( p_tb->f_fullness < 0. )
+            p_tb->f_fullness = 0.;
+        p_tb->i_date = i_date;
+    }
+    return p_tb->f_fullness + 188 <= TSTD_TB_SIZE;
+}
+
+/* Removes the access units decoded up to i_date from the main buffer, and
+ * tells if a packet fits */
+static bool TSTDMainHasRoom( tstd_main_buffer_t *p_b, int64_t i_date )
+{
+    while( p_b->i_au_count > 0 && p_b->au[p_b->i_au_first].i_date <= i_date )
+    {
+        p_b->i_fullness -= p_b->au[p_b->i_au_first].i_bytes;
+        p_b->i_au_first = ( p_b->i_au_first + 1 ) % TSTD_AU_MAX;
+        p_b->i_au_count--;
+    }
+    return p_b->i_size == 0 || p_b->i_fullness + 188 <= p_b->i_size;
+}
+
+/* Adds a packet of the access unit decoded at i_decode to the main buffer.
+ * The data entering the transport buffer is accounted for in the main
+ * buffer right away, which errs on the safe side too. */
+static void TSTDMainAdd( tstd_main_buffer_t *p_b, int64_t i_date,
+                         int64_t i_decode )
+{
+    if( p_b->i_size == 0 )
+        return;
+
+    if( i_decode <= i_date )
+    {
+        p_b->i_underflow++;
+        return;
+    }
+
+    p_b->i_fullness += 188;
+    if( p_b->i_fullness > p_b->i_peak )
+        p_b->i_peak = p_b->i_fullness;
+
+    /* Once the queue is full, the packets are removed with the last access
+     * unit, later than they should */
+    unsigned i_last = ( p_b->i_au_first + p_b->i_au_count - 1 ) % TSTD_AU_MAX;
+    if( p_b->i_au_count > 0 && ( p_b->au[i_last].i_date == i_decode ||
+                                 p_b->i_au_count == TSTD_AU_MAX ) )
+    {
+        p_b->au[i_last].i_bytes += 188;
+        return;
+    }
+
+    i_last = ( p_b->i_au_first + p_b->i_au_count ) % TSTD_AU_MAX;
+    p_b->au[i_last].i_date = i_decode;
+    p_b->au[i_last].i_bytes = 188;
+    p_b->i_au_count++;
+}
+
+static block_t *TSNull( void )
+{
+    block_t *p_ts = block_Alloc( 188 );
+    if( likely(p_ts != NULL) )
+    {
+        p_ts->p_buffer[0] = 0x47;
+        p_ts->p_buffer[1] = 0x1f; /* PID 0x1fff */
+        p_ts->p_buffer[2] = 0xff;
+        p_ts->p_buffer[3] = 0x10;
+        memset( &p_ts->p_buffer[4], 0xff, 184 );
+    }
+    return p_ts;
+}
+
+static void TSReportCBR( sout_mux_t *p_mux )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+
+    if( p_sys->cbr.i_late > 0 )
+        msg_Warn( p_mux, "mux rate too low, %u packets sent late",
+                  p_sys->cbr.i_late );
+    msg_Dbg( p_mux, "%u packets sent, %u%% of null packets",
+             p_sys->cbr.i_packets,
+             100 * p_sys->cbr.i_stuffing / __MAX( p_sys->cbr.i_packets, 1 ) );
+
+    for (int i = 0; i < p_mux->i_nb_inputs; i++ )
+    {
+        sout_input_sys_t *p_stream = (sout_input_sys_t*)p_mux->pp_inputs[i]->p_sys;
+
+        msg_Dbg( p_mux, "pid=%d transport buffer peak %.0f/%d bytes",
+                 p_stream->ts.i_pid, p_stream->tb.f_peak, TSTD_TB_SIZE );
+        p_stream->tb.f_peak = p_stream->tb.f_fullness;
+
+        if( p_stream->b.i_size == 0 )
+            continue;
+        msg_Dbg( p_mux, "pid=%d main buffer peak %"PRId64"/%"PRId64" bytes",
+                 p_stream->ts.i_pid, p_stream->b.i_peak, p_stream->b.i_size );
+        if( p_stream->b.i_underflow > 0 )
+            msg_Warn( p_mux, "pid=%d main buffer underflow, %u packets "
+                      "sent after their decoding time", p_stream->ts.i_pid,
+                      p_stream->b.i_underflow );
+        p_stream->b.i_peak = p_stream->b.i_fullness;
+        p_stream->b.i_underflow = 0;
+    }
+
+    p_sys->cbr.i_report = p_sys->cbr.i_clock;
+    p_sys->cbr.i_packets = 0;
+    p_sys->cbr.i_stuffing = 0;
+    p_sys->cbr.i_late = 0;
+}
+
+static void TSDateCBR( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                       mtime_t i_pcr_length, mtime_t i_pcr_dts )
+{
+    sout_mux_sys_t  *p_sys = p_mux->p_sys;
+    const int64_t   i_start = INT64_C(27) * i_pcr_dts;
+    const int64_t   i_end = INT64_C(27) * ( i_pcr_dts + i_pcr_length );
+
+    block_t          *pp_window[CBR_LOOKAHEAD];
+    sout_input_sys_t *pp_stream[CBR_LOOKAHEAD];
+    int              i_window = 0;
+
+    /* Resynchronize after a long gap, or if the packets are sent so late
+     * that the decoder buffers would underflow */
+    if( p_sys->cbr.i_clock == 0 ||
+        i_start - p_sys->cbr.i_clock > INT64_C(27) * CLOCK_FREQ ||
+        p_sys->cbr.i_clock - i_start > INT64_C(27) * p_sys->i_dts_delay )
+    {
+        if( p_sys->cbr.i_clock != 0 )
+            msg_Warn( p_mux, "resetting the mux rate clock (%"PRId64" us)",
+                      ( p_sys->cbr.i_clock - i_start ) / 27 );
+        p_sys->cbr.i_clock = i_start;
+        p_sys->cbr.i_frac = 0;
+        p_sys->cbr.i_report = i_start;
+    }
+
+    for (;;)
+    {
+        while( i_window < CBR_LOOKAHEAD && p_chain_ts->i_depth > 0 )
+        {
+            block_t *p_ts = BufferChainGet( p_chain_ts );
+
+            pp_window[i_window] = p_ts;
+            pp_stream[i_window] = GetInputByPID( p_mux,
+                ( ( p_ts->p_buffer[1] & 0x1f ) << 8 ) | p_ts->p_buffer[2] );
+            i_window++;
+        }
+
+        const int64_t i_clock = p_sys->cbr.i_clock;
+        if( i_window == 0 && i_clock >= i_end )
+            break;
+
+        /* Nothing is sent before the start of the slice. The packets of a
+         * given PID keep their order, as they share the same buffer. */
+        block_t *p_ts = NULL;
+        for (int i = 0; i_clock >= i_start && i < i_window; i++ )
+        {
+            sout_input_sys_t *p_stream = pp_stream[i];
+
+            if( p_stream != NULL )
+            {
+                if( !TSTDHasRoom( &p_stream->tb, i_clock ) ||
+                    !TSTDMainHasRoom( &p_stream->b, i_clock ) )
+                    continue;
+                p_stream->tb.f_fullness += 188;
+                if( p_stream->tb.f_fullness > p_stream->tb.f_peak )
+                    p_stream->tb.f_peak = p_stream->tb.f_fullness;
+                if( pp_window[i]->i_dts > VLC_TS_INVALID )
+                    TSTDMainAdd( &p_stream->b, i_clock, INT64_C(27) *
+                                 ( pp_window[i]->i_dts + p_sys->i_dts_delay ) );
+            }
+
+            p_ts = pp_window[i];
+            i_window--;
+            memmove( &pp_window[i], &pp_window[i + 1],
+                     ( i_window - i ) * sizeof( *pp_window ) );
+            memmove( &pp_stream[i], &pp_stream[i + 1],
+                     ( i_window - i ) * sizeof( *pp_stream ) );
+            break;
+        }
+
+        if( p_ts == NULL )
+        {
+            p_ts = TSNull();
+            p_sys->cbr.i_stuffing++;
+        }
+        else if( i_clock >= i_end )
+            p_sys->cbr.i_late++;
+        p_sys->cbr.i_packets++;
+
+        if( likely(p_ts != NULL) )
+        {
+            if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
+                TSSetPCR27( p_ts, i_clock - INT64_C(27) * p_sys->first_dts );
+            if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
+            {
+                vlc_mutex_lock( &p_sys->csa_lock );
+                csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
+                vlc_mutex_unlock( &p_sys->csa_lock );
+            }
+
+            /* latency */
+            p_ts->i_dts    = i_clock / 27 + p_sys->i_shaping_delay * 3 / 2;
+            p_ts->i_length = p_sys->cbr.i_step / 27;
+
+            sout_AccessOutWrite( p_mux->p_access, p_ts );
+        }
+
+        p_sys->cbr.i_clock += p_sys->cbr.i_step;
+        p_sys->cbr.i_frac += p_sys->cbr.i_step_rem;
+        if( p_sys->cbr.i_frac >= p_sys->i_muxrate )
+        {
+            p_sys->cbr.i_frac -= p_sys->i_muxrate;
+            p_sys->cbr.i_clock++;
+        }
+
+        if( p_sys->cbr.i_clock - p_sys->cbr.i_report >= INT64_C(27000000) )
+            TSReportCBR( p_mux );
+    }
+}
+
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
                        bool b_pcr )
 {
@@ -1909,54 +2381,122 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
 
 static void TSSetPCR( block_t *p_ts, mtime_t i_dts )
 {
-    mtime_t i_pcr = 9 * i_dts / 100;
-
-    p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
-    p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
-    p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
-    p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
-    p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    /* we don't set PCR extension */
+    TSSetPCR27( p_ts, 9 * i_dts / 100 * 300 );
+}
+
+/* i_pcr is in 27 MHz units */
+static void TSSetPCR27( block_t *p_ts, int64_t i_pcr )
+{
+    const int64_t i_base = i_pcr / 300;
+    const int i_ext = i_pcr % 300;
+
+    p_ts->p_buffer[6]  = ( i_base >> 25 )&0xff;
+    p_ts->p_buffer[7]  = ( i_base >> 17 )&0xff;
+    p_ts->p_buffer[8]  = ( i_base >> 9  )&0xff;
+    p_ts->p_buffer[9]  = ( i_base >> 1  )&0xff;
+    p_ts->p_buffer[10] = ( ( i_base << 7 )&0x80 ) | 0x7e | ( i_ext >> 8 );
+    p_ts->p_buffer[11] = i_ext & 0xff;
+}
+
+static tsmux_stream_t *GetPSIStream( sout_mux_sys_t *p_sys, uint16_t i_pid )
+{
+    if( i_pid == p_sys->pat.i_pid )
+        return &p_sys->pat;
+    if( i_pid == p_sys->sdt.ts.i_pid )
+        return &p_sys->sdt.ts;
+    for( unsigned i = 0; i < p_sys->i_num_pmt; i++ )
+        if( i_pid == p_sys->pmt[i].i_pid )
+            return &p_sys->pmt[i];
+    return NULL;
+}
+
+/* Appends a copy of the cached PSI packets, with the continuity counters
+ * of their PID */
+static void CopyPSI( sout_mux_sys_t *p_sys, sout_buffer_chain_t *c,
+                     block_t *p_cache )
+{
+    for( ; p_cache != NULL; p_cache = p_cache->p_next )
+    {
+        block_t *p_ts = block_Duplicate( p_cache );
+        if( unlikely(p_ts == NULL) )
+            return;
+
+        const uint16_t i_pid = ( ( p_ts->p_buffer[1] & 0x1f ) << 8 )
+                             | p_ts->p_buffer[2];
+        tsmux_stream_t *p_psi = GetPSIStream( p_sys, i_pid );
+        if( likely(p_psi != NULL) )
+        {
+            p_ts->p_buffer[3] = ( p_ts->p_buffer[3] & 0xf0 )
+                              | p_psi->i_continuity_counter;
+            p_psi->i_continuity_counter = ( p_psi->i_continuity_counter + 1 )%16;
+        }
+        BufferChainAppend( c, p_ts );
+    }
 }
 
-void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
 {
     sout_mux_sys_t       *p_sys = p_mux->p_sys;
 
-    BuildPAT( p_sys->p_dvbpsi,
-              c, (PEStoTSCallback)BufferChainAppend,
-              p_sys->i_tsid, p_sys->i_pat_version_number,
-              &p_sys->pat,
-              p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number );
+    if( p_sys->p_pat_cache == NULL )
+    {
+        /* The continuity counters are set by CopyPSI() */
+        tsmux_stream_t pat = p_sys->pat;
+        sout_buffer_chain_t cache;
+
+        BufferChainInit( &cache );
+        BuildPAT( p_sys->p_dvbpsi,
+                  &cache, (PEStoTSCallback)BufferChainAppend,
+                  p_sys->i_tsid, p_sys->i_pat_version_number,
+                  &pat,
+                  p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number );
+        p_sys->p_pat_cache = cache.p_first;
+    }
+
+    CopyPSI( p_sys, c, p_sys->p_pat_cache );
 }
 
 static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
-    pes_mapped_stream_t mappeds[p_mux->i_nb_inputs];
 
-    for (int i_stream = 0; i_stream < p_mux->i_nb_inputs; i_stream++ )
+    if( p_sys->p_pmt_cache == NULL )
     {
-        sout_input_t *p_input = p_mux->pp_inputs[i_stream];
-        sout_input_sys_t *p_stream = (sout_input_sys_t*)p_input->p_sys;
+        pes_mapped_stream_t mappeds[p_mux->i_nb_inputs];
 
-        int i_pidinput = p_input->p_fmt->i_id;
-        pmt_map_t *p_usepid = bsearch( &i_pidinput, p_sys->pmtmap,
-                                       p_sys->i_pmtslots, sizeof(pmt_map_t), intcompare );
+        for (int i_stream = 0; i_stream < p_mux->i_nb_inputs; i_stream++ )
+        {
+            sout_input_t *p_input = p_mux->pp_inputs[i_stream];
+            sout_input_sys_t *p_stream = (sout_input_sys_t*)p_input->p_sys;
+
+            int i_pidinput = p_input->p_fmt->i_id;
+            pmt_map_t *p_usepid = bsearch( &i_pidinput, p_sys->pmtmap,
+                                           p_sys->i_pmtslots, sizeof(pmt_map_t), intcompare );
+
+            /* If there's an error somewhere, dump it to the first pmt */
+            mappeds[i_stream].i_mapped_prog = p_usepid ? p_usepid->i_prog : 0;
+            mappeds[i_stream].fmt = p_input->p_fmt;
+            mappeds[i_stream].pes = &p_stream->pes;
+            mappeds[i_stream].ts = &p_stream->ts;
+        }
 
-        /* If there's an error somewhere, dump it to the first pmt */
-        mappeds[i_stream].i_mapped_prog = p_usepid ? p_usepid->i_prog : 0;
-        mappeds[i_stream].fmt = p_input->p_fmt;
-        mappeds[i_stream].pes = &p_stream->pes;
-        mappeds[i_stream].ts = &p_stream->ts;
+        /* The continuity counters are set by CopyPSI() */
+        tsmux_stream_t pmt[MAX_PMT];
+        sdt_psi_t sdt = p_sys->sdt;
+        sout_buffer_chain_t cache;
+
+        memcpy( pmt, p_sys->pmt, sizeof(pmt) );
+        BufferChainInit( &cache );
+        BuildPMT( p_sys->p_dvbpsi, VLC_OBJECT(p_mux), p_sys->standard,
+                  &cache, (PEStoTSCallback)BufferChainAppend,
+                  p_sys->i_tsid, p_sys->i_pmt_version_number,
+                  ((sout_input_sys_t *)p_sys->p_pcr_input->p_sys)->ts.i_pid,
+                  &sdt,
+                  p_sys->i_num_pmt, pmt, p_sys->i_pmt_program_number,
+                  p_mux->i_nb_inputs, mappeds );
+        p_sys->p_pmt_cache = cache.p_first;
     }
 
-    BuildPMT( p_sys->p_dvbpsi, VLC_OBJECT(p_mux), p_sys->standard,
-              c, (PEStoTSCallback)BufferChainAppend,
-              p_sys->i_tsid, p_sys->i_pmt_version_number,
-              ((sout_input_sys_t *)p_sys->p_pcr_input->p_sys)->ts.i_pid,
-              &p_sys->sdt,
-              p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number,
-              p_mux->i_nb_inputs, mappeds );
+    CopyPSI( p_sys, c, p_sys->p_pmt_cache );
 }
@@ -187,6 +187,21 @@ static void StorePPS( decoder_sys_t *p_sys, uint8_t i_id,
     p_sys->pps[i_id].p_pps = p_pps;
 }
 
+/* Repeated in-band parameter sets are compared instead of being decoded
+ * again, as broadcasters usually send them along every IDR */
+static bool IsSameXPS( const block_t *p_stored,
+                       const uint8_t *p_buffer, size_t i_buffer )
+{
+    if( p_stored == NULL )
+        return false;
+
+    const uint8_t *p_stripped = p_stored->p_buffer;
+    size_t i_stripped = p_stored->i_buffer;
+    hxxx_strip_AnnexB_startcode( &p_stripped, &i_stripped );
+
+    return i_stripped == i_buffer && !memcmp( p_stripped, p_buffer, i_buffer );
+}
+
 static void ActivateSets( decoder_t *p_dec, const h264_sequence_parameter_set_t *p_sps,
                                             const h264_picture_parameter_set_t *p_pps )
 {
@@ -1034,6 +1049,14 @@ static void PutSPS( decoder_t *p_dec, block_t *p_frag )
         return;
     }
 
+    uint8_t i_id;
+    if( h264_get_xps_id( p_buffer, i_buffer, &i_id ) &&
+        IsSameXPS( p_sys->sps[i_id].p_block, p_buffer, i_buffer ) )
+    {
+        block_Release( p_frag );
+        return;
+    }
+
     h264_sequence_parameter_set_t *p_sps = h264_decode_sps( p_buffer, i_buffer, true );
     if( !p_sps )
     {
@@ -1061,6 +1084,14 @@ static void PutPPS( decoder_t *p_dec, block_t *p_frag )
         return;
     }
 
+    uint8_t i_id;
+    if( h264_get_xps_id( p_buffer, i_buffer, &i_id ) &&
+        IsSameXPS( p_sys->pps[i_id].p_block, p_buffer, i_buffer ) )
+    {
+        block_Release( p_frag );
+        return;
+    }
+
     h264_picture_parameter_set_t *p_pps = h264_decode_pps( p_buffer, i_buffer, true );
     if( !p_pps )
     {
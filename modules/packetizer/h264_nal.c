@@ -632,6 +632,40 @@ static bool h264_parse_picture_parameter_set_rbsp( bs_t *p_bs,
         return p_h264type; \
     }
 
+/* Shortcut for retrieving sps/pps id without a full decode */
+bool h264_get_xps_id( const uint8_t *p_buf, size_t i_buf, uint8_t *pi_id )
+{
+    if( i_buf < 2 )
+        return false;
+
+    const uint8_t i_nal_type = p_buf[0] & 0x1f;
+    bs_t bs;
+    bs_init( &bs, &p_buf[1], i_buf - 1 );
+    unsigned i_bitflow = 0;
+    bs.p_fwpriv = &i_bitflow;
+    bs.pf_forward = hxxx_bsfw_ep3b_to_rbsp;  /* Does the emulated 3bytes conversion to rbsp */
+
+    uint32_t i_id;
+    if( i_nal_type == H264_NAL_SPS )
+    {
+        bs_skip( &bs, 24 ); /* profile, constraint flags, level */
+        i_id = bs_read_ue( &bs );
+        if( i_id > H264_SPS_ID_MAX )
+            return false;
+    }
+    else if( i_nal_type == H264_NAL_PPS )
+    {
+        i_id = bs_read_ue( &bs );
+        if( i_id > H264_PPS_ID_MAX )
+            return false;
+    }
+    else
+        return false;
+
+    *pi_id = i_id;
+    return true;
+}
+
 IMPL_h264_generic_decode( h264_decode_sps, h264_sequence_parameter_set_t,
                           h264_parse_sequence_parameter_set_rbsp, h264_release_sps )
 
@@ -83,6 +83,9 @@ h264_picture_parameter_set_t *  h264_decode_pps( const uint8_t *, size_t, bool )
 void h264_release_sps( h264_sequence_parameter_set_t * );
 void h264_release_pps( h264_picture_parameter_set_t * );
 
+/* Returns the id of a (start code stripped) SPS or PPS NAL */
+bool h264_get_xps_id( const uint8_t *, size_t, uint8_t * );
+
 struct h264_sequence_parameter_set_t
 {
     uint8_t i_id;
@@ -385,6 +385,7 @@ struct sout_stream_id_sys_t
 
     block_fifo_t     *p_fifo;
     int64_t           i_caching;
+    unsigned          i_dropped; /* owned by the sender thread */
 };
 
 /*****************************************************************************
@@ -977,6 +978,7 @@ static sout_stream_id_sys_t *Add( sout_stream_t *p_stream,
     id->sinkv = NULL;
     id->rtsp_id = NULL;
     id->p_fifo = NULL;
+    id->i_dropped = 0;
     id->listen.fd = NULL;
 
     id->b_first_packet = true;
@@ -1230,6 +1232,8 @@ static void Del( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
         vlc_cancel( id->thread );
         vlc_join( id->thread, NULL );
         block_FifoRelease( id->p_fifo );
+        if( id->i_dropped > 0 )
+            msg_Warn( p_stream, "%u RTP packets dropped", id->i_dropped );
     }
 
     free( id->rtp_fmt.fmtp );
@@ -1392,41 +1396,144 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
-{
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
+
+/* Maximum number of packets sent at once to each sink */
+#define RTP_BATCH_MAX    64
+/* Packets due within that delay of the first one are sent along with it */
+#define RTP_BATCH_WINDOW (CLOCK_FREQ / 1000)
+
+#ifdef HAVE_SRTP
+static block_t *rtp_protect( sout_stream_id_sys_t *id, block_t *out )
+{
+    /* FIXME: this is awfully inefficient */
+    size_t len = out->i_buffer;
+    out = block_Realloc( out, 0, len + 10 );
+    out->i_buffer = len;
+
+    int canc = vlc_savecancel ();
+    int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+    vlc_restorecancel (canc);
+    if( val )
+    {
+        msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                 vlc_strerror_c(val) );
+        block_Release( out );
+        return NULL;
+    }
+    out->i_buffer = len;
+    return out;
+}
+#endif
+
+/**
+ * Sends packets to a sink.
+ * Like with one send() per packet, a packet is dropped if the socket buffer
+ * is full, or if an ICMP soft error is reported again after a retry. The
+ * following packets are sent nevertheless.
+ * \param dropped incremented by the number of dropped packets
+ * \return false if the sink connection is broken
+ */
+static bool rtp_send_sink( int fd, block_t *const *outv, unsigned outc,
+                           unsigned *dropped )
+{
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgv[RTP_BATCH_MAX];
+    struct iovec iov[RTP_BATCH_MAX];
+
+    for( unsigned i = 0; i < outc; i++ )
+    {
+        iov[i].iov_base = outv[i]->p_buffer;
+        iov[i].iov_len = outv[i]->i_buffer;
+        memset( &msgv[i].msg_hdr, 0, sizeof (msgv[i].msg_hdr) );
+        msgv[i].msg_hdr.msg_iov = &iov[i];
+        msgv[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    struct mmsghdr *msg = msgv;
+    bool retried = false;
+
+    while( outc > 0 )
+    {
+        int val = sendmmsg( fd, msg, outc, 0 );
+        if( val > 0 )
+        {   /* Partial batch: continue after the last sent packet */
+            msg += val;
+            outc -= val;
+            retried = false;
+            continue;
+        }
+
+        if( val == -1
+         && net_errno != EAGAIN && net_errno != EWOULDBLOCK
+         && net_errno != ENOBUFS && net_errno != ENOMEM )
+        {
+            int type;
+            getsockopt( fd, SOL_SOCKET, SO_TYPE,
+                        &type, &(socklen_t){ sizeof(type) });
+            if( type != SOCK_DGRAM )
+                return false; /* Broken connection */
+
+            /* ICMP soft error: ignore and retry */
+            if( !retried )
+            {
+                retried = true;
+                continue;
+            }
+        }
+
+        /* Drop the first packet, and send the following ones */
+        msg++;
+        outc--;
+        (*dropped)++;
+        retried = false;
+    }
+#else
+    for( unsigned i = 0; i < outc; i++ )
+    {
+        const block_t *out = outv[i];
+
+        if( send( fd, out->p_buffer, out->i_buffer, 0 ) != -1 )
+            continue;
+
+        if( net_errno != EAGAIN && net_errno != EWOULDBLOCK
+         && net_errno != ENOBUFS && net_errno != ENOMEM )
+        {
+            int type;
+            getsockopt( fd, SOL_SOCKET, SO_TYPE,
+                        &type, &(socklen_t){ sizeof(type) });
+            if( type != SOCK_DGRAM )
+                return false; /* Broken connection */
+
+            /* ICMP soft error: ignore and retry */
+            if( send( fd, out->p_buffer, out->i_buffer, 0 ) != -1 )
+                continue;
+        }
+        (*dropped)++;
+    }
+#endif
+    return true;
+}
+
+static void* ThreadSend( void *data )
+{
     sout_stream_id_sys_t *id = data;
     unsigned i_caching = id->i_caching;
 
     for (;;)
     {
+        block_t *outv[RTP_BATCH_MAX];
+        unsigned outc = 0;
+
         block_t *out = block_FifoGet( id->p_fifo );
         block_cleanup_push (out);
-
 #ifdef HAVE_SRTP
         if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
-
-            int canc = vlc_savecancel ();
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            vlc_restorecancel (canc);
-            if( val )
-            {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                out = NULL;
-            }
-            else
-                out->i_buffer = len;
-        }
+            out = rtp_protect( id, out );
         if (out)
             mwait (out->i_dts + i_caching);
         vlc_cleanup_pop ();
@@ -1436,10 +1543,35 @@ static void* ThreadSend( void *data )
         mwait (out->i_dts + i_caching);
         vlc_cleanup_pop ();
 #endif
+        outv[outc++] = out;
 
-        ssize_t len = out->i_buffer;
         int canc = vlc_savecancel ();
 
+        /* Batch the following packets which are (nearly) due, as the send
+         * cost is mostly per system call rather than per packet. This
+         * thread is the only consumer of the FIFO, so the shown block is
+         * the one that will be dequeued. */
+        const mtime_t deadline = mdate() + RTP_BATCH_WINDOW - i_caching;
+        while( outc < RTP_BATCH_MAX )
+        {
+            vlc_fifo_Lock( id->p_fifo );
+            bool empty = vlc_fifo_GetCount( id->p_fifo ) == 0;
+            vlc_fifo_Unlock( id->p_fifo );
+            if( empty || block_FifoShow( id->p_fifo )->i_dts > deadline )
+                break;
+
+            block_t *next = block_FifoGet( id->p_fifo );
+#ifdef HAVE_SRTP
+            if( id->srtp )
+            {
+                next = rtp_protect( id, next );
+                if( next == NULL )
+                    continue;
+            }
+#endif
+            outv[outc++] = next;
+        }
+
         vlc_mutex_lock( &id->lock_sink );
         unsigned deadc = 0; /* How many dead sockets? */
         int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
@@ -1449,26 +1581,18 @@ static void* ThreadSend( void *data )
 #ifdef HAVE_SRTP
             if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+                for( unsigned j = 0; j < outc; j++ )
+                    SendRTCP( id->sinkv[i].rtcp, outv[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
+            if( !rtp_send_sink( id->sinkv[i].rtp_fd, outv, outc,
+                                &id->i_dropped ) )
+                deadv[deadc++] = id->sinkv[i].rtp_fd;
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
+        id->i_seq_sent_next = ntohs(((uint16_t *) outv[outc - 1]->p_buffer)[1]) + 1;
         vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+
+        for( unsigned i = 0; i < outc; i++ )
+            block_Release( outv[i] );
 
         for( unsigned i = 0; i < deadc; i++ )
         {
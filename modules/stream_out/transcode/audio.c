@@ -34,6 +34,7 @@
 #include <vlc_input.h>
 #include <vlc_meta.h>
 #include <vlc_modules.h>
+#include <vlc_tracer.h>
 
 static const int pi_channels_maps[9] =
 {
@@ -55,6 +56,19 @@ static const int pi_channels_maps[9] =
      | AOUT_CHAN_LFE,
 };
 
+/* Encodes a buffer, or drains the encoder, tracing the call */
+static block_t *EncodeAudio( encoder_t *p_enc, block_t *p_buffer )
+{
+    vlc_tracer_t *tracer = vlc_tracer_Get( p_enc );
+    mtime_t trace_start = vlc_tracer_Begin( tracer );
+    mtime_t trace_date = p_buffer != NULL ? p_buffer->i_pts : VLC_TS_INVALID;
+
+    block_t *p_block = p_enc->pf_encode_audio( p_enc, p_buffer );
+
+    vlc_tracer_EndDate( tracer, VLC_TRACER_ENCODE, trace_start, trace_date );
+    return p_block;
+}
+
 static int audio_update_format( decoder_t *p_dec )
 {
     sout_stream_id_sys_t *id     = p_dec->p_queue_ctx;
@@ -373,7 +387,7 @@ int transcode_audio_process( sout_stream_t *p_stream,
 
         p_audio_buf->i_dts = p_audio_buf->i_pts;
 
-        block_t *p_block = id->p_encoder->pf_encode_audio( id->p_encoder, p_audio_buf );
+        block_t *p_block = EncodeAudio( id->p_encoder, p_audio_buf );
 
         block_ChainAppend( out, p_block );
         block_Release( p_audio_buf );
@@ -392,7 +406,7 @@ end:
         {
             block_t *p_block;
             do {
-               p_block = id->p_encoder->pf_encode_audio(id->p_encoder, NULL );
+               p_block = EncodeAudio( id->p_encoder, NULL );
                block_ChainAppend( out, p_block );
             } while( p_block );
         }
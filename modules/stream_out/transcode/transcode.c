@@ -76,6 +76,10 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define SPLICE_TEXT N_("Keyframes at splice points")
+#define SPLICE_LONGTEXT N_( \
+    "Encode the pictures at the SCTE-35 splice points of the input as " \
+    "keyframes, so that the output can be segmented on them." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -178,6 +182,8 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT, true )
     add_module_list( SOUT_CFG_PREFIX "vfilter", "video filter",
                      NULL, VFILTER_TEXT, VFILTER_LONGTEXT, false )
+    add_bool( SOUT_CFG_PREFIX "splice-keyframes", true, SPLICE_TEXT,
+              SPLICE_LONGTEXT, true )
 
     set_section( N_("Audio"), NULL )
     add_module( SOUT_CFG_PREFIX "aenc", "encoder", NULL, AENC_TEXT,
@@ -224,7 +230,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "splice-keyframes", NULL
 };
 
 /*****************************************************************************
@@ -368,6 +374,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_threads = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_sys->pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
     p_sys->b_high_priority = var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" );
+    p_sys->b_splice_keyframes = var_GetBool( p_stream, SOUT_CFG_PREFIX "splice-keyframes" );
 
     if( p_sys->i_vcodec )
     {
@@ -529,6 +536,7 @@ static sout_stream_id_sys_t *Add( sout_stream_t *p_stream,
     else if( p_fmt->i_cat == VIDEO_ES && p_sys->i_vcodec )
         success = transcode_video_add(p_stream, p_fmt, id);
     else if( ( p_fmt->i_cat == SPU_ES ) &&
+             ( p_fmt->i_codec != VLC_CODEC_SCTE_35 ) &&
              ( p_sys->i_scodec || p_sys->b_soverlay ) )
         success = transcode_spu_add(p_stream, p_fmt, id);
     else
@@ -544,6 +552,8 @@ static sout_stream_id_sys_t *Add( sout_stream_t *p_stream,
     if(!success)
         goto error;
 
+    if( id->b_transcode && p_fmt->i_cat == VIDEO_ES )
+        p_sys->i_vencoders++;
     return id;
 
 error:
@@ -564,6 +574,9 @@ static void Del( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
         case VIDEO_ES:
             Send( p_stream, id, NULL );
             transcode_video_close( p_stream, id );
+            /* Nothing is left to consume the splice points */
+            if( --p_stream->p_sys->i_vencoders == 0 )
+                p_stream->p_sys->i_splices = 0;
             break;
         case SPU_ES:
             transcode_spu_close( p_stream, id );
@@ -588,6 +601,11 @@ static int Send( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
     if( !id->b_transcode )
     {
+        if( p_buffer && id->p_decoder->fmt_in.i_codec == VLC_CODEC_SCTE_35 &&
+            p_stream->p_sys->b_splice_keyframes &&
+            p_stream->p_sys->i_vencoders > 0 )
+            transcode_video_add_splice( p_stream, p_buffer );
+
         if( id->id )
             return sout_StreamIdSend( p_stream->p_next, id->id, p_buffer );
         else
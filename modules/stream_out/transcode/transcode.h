@@ -14,6 +14,8 @@
 /*100ms is around the limit where people are noticing lipsync issues*/
 #define MASTER_SYNC_MAX_DRIFT 100000
 
+#define MAX_SPLICES 8
+
 struct sout_stream_sys_t
 {
     sout_stream_id_sys_t *id_video;
@@ -54,6 +56,12 @@ struct sout_stream_sys_t
 
     char            *psz_vf2;
 
+    /* SCTE-35 splice points to be encoded as keyframes */
+    bool            b_splice_keyframes;
+    mtime_t         pi_splices[MAX_SPLICES];
+    unsigned        i_splices;
+    unsigned        i_vencoders; /* video ES being encoded */
+
     /* SPU */
     vlc_fourcc_t    i_scodec;   /* codec spu (0 if not transcode) */
     char            *psz_senc;
@@ -150,3 +158,4 @@ int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 bool transcode_video_add    ( sout_stream_t *, const es_format_t *,
                                 sout_stream_id_sys_t *);
+void transcode_video_add_splice( sout_stream_t *, const block_t * );
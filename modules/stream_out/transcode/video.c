@@ -34,10 +34,26 @@
 #include <vlc_meta.h>
 #include <vlc_spu.h>
 #include <vlc_modules.h>
+#include <vlc_tracer.h>
+
+#include "../../codec/scte35.h"
 
 #define ENC_FRAMERATE (25 * 1000)
 #define ENC_FRAMERATE_BASE 1000
 
+/* Encodes a picture, or drains the encoder, tracing the call */
+static block_t *EncodeVideo( encoder_t *p_enc, picture_t *p_pic )
+{
+    vlc_tracer_t *tracer = vlc_tracer_Get( p_enc );
+    mtime_t trace_start = vlc_tracer_Begin( tracer );
+    mtime_t trace_date = p_pic != NULL ? p_pic->date : VLC_TS_INVALID;
+
+    block_t *p_block = p_enc->pf_encode_video( p_enc, p_pic );
+
+    vlc_tracer_EndDate( tracer, VLC_TRACER_ENCODE, trace_start, trace_date );
+    return p_block;
+}
+
 static const video_format_t* video_output_format( sout_stream_id_sys_t *id,
                                                   picture_t *p_pic )
 {
@@ -119,7 +135,7 @@ static void* EncoderThread( void *obj )
         {
             /* release lock while encoding */
             vlc_mutex_unlock( &p_sys->lock_out );
-            p_block = id->p_encoder->pf_encode_video( id->p_encoder, p_pic );
+            p_block = EncodeVideo( id->p_encoder, p_pic );
             picture_Release( p_pic );
             vlc_mutex_lock( &p_sys->lock_out );
 
@@ -134,14 +150,14 @@ static void* EncoderThread( void *obj )
     while( (p_pic = picture_fifo_Pop( p_sys->pp_pics )) != NULL )
     {
         vlc_sem_post( &p_sys->picture_pool_has_room );
-        p_block = id->p_encoder->pf_encode_video( id->p_encoder, p_pic );
+        p_block = EncodeVideo( id->p_encoder, p_pic );
         picture_Release( p_pic );
         block_ChainAppend( &p_sys->p_buffers, p_block );
     }
 
     /*Now flush encoder*/
     do {
-        p_block = id->p_encoder->pf_encode_video(id->p_encoder, NULL );
+        p_block = EncodeVideo( id->p_encoder, NULL );
         block_ChainAppend( &p_sys->p_buffers, p_block );
     } while( p_block );
 
@@ -735,11 +751,24 @@ static void OutputFrame( sout_stream_t *p_stream, picture_t *p_pic, sout_stream_
         }
     }
 
+    /* Request a keyframe at the first picture of each splice point */
+    unsigned i_splices = 0;
+    while( i_splices < p_sys->i_splices &&
+           p_sys->pi_splices[i_splices] <= p_pic->date )
+        i_splices++;
+    if( i_splices > 0 )
+    {
+        p_pic->b_force_keyframe = true;
+        p_sys->i_splices -= i_splices;
+        memmove( &p_sys->pi_splices[0], &p_sys->pi_splices[i_splices],
+                 p_sys->i_splices * sizeof(*p_sys->pi_splices) );
+    }
+
     if( p_sys->i_threads == 0 )
     {
         block_t *p_block;
 
-        p_block = id->p_encoder->pf_encode_video( id->p_encoder, p_pic );
+        p_block = EncodeVideo( id->p_encoder, p_pic );
         block_ChainAppend( out, p_block );
     }
 
@@ -886,7 +915,7 @@ end:
             {
                 block_t *p_block;
                 do {
-                    p_block = id->p_encoder->pf_encode_video(id->p_encoder, NULL );
+                    p_block = EncodeVideo( id->p_encoder, NULL );
                     block_ChainAppend( out, p_block );
                 } while( p_block );
             }
@@ -950,3 +979,23 @@ bool transcode_video_add( sout_stream_t *p_stream, const es_format_t *p_fmt,
     return true;
 }
 
+
+void transcode_video_add_splice( sout_stream_t *p_stream, const block_t *p_block )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    scte35_splice_t splice;
+
+    if( !scte35_Parse( p_block->p_buffer, p_block->i_buffer, &splice ) )
+        return;
+
+    if( p_sys->i_splices == MAX_SPLICES )
+    {
+        msg_Warn( p_stream, "too many pending splice points, dropping one" );
+        p_sys->i_splices--;
+        memmove( &p_sys->pi_splices[0], &p_sys->pi_splices[1],
+                 p_sys->i_splices * sizeof(*p_sys->pi_splices) );
+    }
+    p_sys->pi_splices[p_sys->i_splices++] = p_block->i_pts;
+    msg_Dbg( p_stream, "keyframe requested at splice point %"PRId64,
+             p_block->i_pts );
+}
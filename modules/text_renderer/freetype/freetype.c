@@ -70,6 +70,7 @@
 #include "platform_fonts.h"
 #include "freetype.h"
 #include "text_layout.h"
+#include "glyph_cache.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -115,6 +116,10 @@ static void Destroy( vlc_object_t * );
 #define SHADOW_ANGLE_TEXT N_("Shadow angle")
 #define SHADOW_DISTANCE_TEXT N_("Shadow distance")
 
+#define GLYPH_CACHE_TEXT N_("Glyph cache size (KiB)")
+#define GLYPH_CACHE_LONGTEXT N_("Amount of memory used to keep loaded glyphs " \
+    "for reuse across renderings. 0 disables the cache." )
+
 #define TEXT_DIRECTION_TEXT N_("Text direction")
 #define TEXT_DIRECTION_LONGTEXT N_("Paragraph base direction for the Unicode bi-directional algorithm.")
 
@@ -233,6 +238,9 @@ vlc_module_begin ()
     add_bool( "freetype-yuvp", false, YUVP_TEXT,
               YUVP_LONGTEXT, true )
 
+    add_integer_with_range( "freetype-glyph-cache", 1024, 0, 65536,
+                            GLYPH_CACHE_TEXT, GLYPH_CACHE_LONGTEXT, true )
+
 #ifdef HAVE_FRIBIDI
     add_integer_with_range( "freetype-text-direction", 0, 0, 2, TEXT_DIRECTION_TEXT,
                             TEXT_DIRECTION_LONGTEXT, false )
@@ -1337,6 +1345,10 @@ static int Create( vlc_object_t *p_this )
 
     p_sys->i_scale = 100;
 
+    int i_glyph_cache = var_InheritInteger( p_filter, "freetype-glyph-cache" );
+    if( i_glyph_cache > 0 )
+        p_sys->p_glyph_cache = GlyphCache_New( (size_t)i_glyph_cache * 1024 );
+
     /* default style to apply to uncomplete segmeents styles */
     p_sys->p_default_style = text_style_Create( STYLE_FULLY_SET );
     if(unlikely(!p_sys->p_default_style))
@@ -1459,6 +1471,16 @@ static void Destroy( vlc_object_t *p_this )
     text_style_Delete( p_sys->p_default_style );
     text_style_Delete( p_sys->p_forced_style );
 
+    /* Glyphs, which reference the faces */
+    if( p_sys->p_glyph_cache )
+    {
+        uint64_t i_hits, i_misses;
+        GlyphCache_GetStats( p_sys->p_glyph_cache, &i_hits, &i_misses );
+        msg_Dbg( p_filter, "glyph cache: %"PRIu64" hits, %"PRIu64" misses",
+                 i_hits, i_misses );
+        GlyphCache_Delete( p_sys->p_glyph_cache );
+    }
+
     /* Fonts dicts */
     vlc_dictionary_clear( &p_sys->fallback_map, FreeFamilies, p_filter );
     vlc_dictionary_clear( &p_sys->face_map, FreeFace, p_filter );
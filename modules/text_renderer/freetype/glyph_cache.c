@@ -0,0 +1,249 @@
+/*****************************************************************************
+ * glyph_cache.c : Cache of loaded freetype glyphs
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+
+#include "glyph_cache.h"
+
+#include FT_OUTLINE_H
+
+#define GLYPH_CACHE_BUCKETS 512
+
+typedef struct glyph_cache_entry_t glyph_cache_entry_t;
+struct glyph_cache_entry_t
+{
+    /* Key */
+    FT_Face  p_face;
+    FT_UInt  i_index;
+    int      i_flags;
+    int      i_radius;
+
+    FT_Glyph  p_glyph;
+    FT_Glyph  p_outline;
+    FT_Vector advance;
+    size_t    i_size;
+
+    glyph_cache_entry_t *p_hash_next;
+    glyph_cache_entry_t *p_lru_prev;  /* more recently used */
+    glyph_cache_entry_t *p_lru_next;  /* less recently used */
+};
+
+struct glyph_cache_t
+{
+    glyph_cache_entry_t *pp_buckets[GLYPH_CACHE_BUCKETS];
+    glyph_cache_entry_t *p_lru_first;
+    glyph_cache_entry_t *p_lru_last;
+
+    size_t   i_size;
+    size_t   i_max_size;
+
+    uint64_t i_hits;
+    uint64_t i_misses;
+};
+
+static unsigned Hash( FT_Face p_face, FT_UInt i_index, int i_flags, int i_radius )
+{
+    uintptr_t h = (uintptr_t)p_face >> 4;
+    h = h * 31 + i_index;
+    h = h * 31 + (unsigned)i_flags;
+    h = h * 31 + (unsigned)i_radius;
+    return (h ^ (h >> 9)) % GLYPH_CACHE_BUCKETS;
+}
+
+/* Approximate memory footprint of a glyph */
+static size_t GlyphSize( FT_Glyph p_glyph )
+{
+    if( !p_glyph )
+        return 0;
+
+    switch( p_glyph->format )
+    {
+        case FT_GLYPH_FORMAT_OUTLINE:
+        {
+            const FT_Outline *p_outline = &((FT_OutlineGlyph)p_glyph)->outline;
+            return sizeof(FT_OutlineGlyphRec)
+                 + p_outline->n_points * (sizeof(FT_Vector) + sizeof(char))
+                 + p_outline->n_contours * sizeof(short);
+        }
+        case FT_GLYPH_FORMAT_BITMAP:
+        {
+            const FT_Bitmap *p_bitmap = &((FT_BitmapGlyph)p_glyph)->bitmap;
+            return sizeof(FT_BitmapGlyphRec)
+                 + (size_t)abs( p_bitmap->pitch ) * p_bitmap->rows;
+        }
+        default:
+            return sizeof(FT_GlyphRec);
+    }
+}
+
+static void LRURemove( glyph_cache_t *p_cache, glyph_cache_entry_t *p_entry )
+{
+    if( p_entry->p_lru_prev )
+        p_entry->p_lru_prev->p_lru_next = p_entry->p_lru_next;
+    else
+        p_cache->p_lru_first = p_entry->p_lru_next;
+
+    if( p_entry->p_lru_next )
+        p_entry->p_lru_next->p_lru_prev = p_entry->p_lru_prev;
+    else
+        p_cache->p_lru_last = p_entry->p_lru_prev;
+}
+
+static void LRUPushFront( glyph_cache_t *p_cache, glyph_cache_entry_t *p_entry )
+{
+    p_entry->p_lru_prev = NULL;
+    p_entry->p_lru_next = p_cache->p_lru_first;
+    if( p_cache->p_lru_first )
+        p_cache->p_lru_first->p_lru_prev = p_entry;
+    else
+        p_cache->p_lru_last = p_entry;
+    p_cache->p_lru_first = p_entry;
+}
+
+static void EntryDelete( glyph_cache_t *p_cache, glyph_cache_entry_t *p_entry )
+{
+    glyph_cache_entry_t **pp = &p_cache->pp_buckets[
+        Hash( p_entry->p_face, p_entry->i_index,
+              p_entry->i_flags, p_entry->i_radius ) ];
+    while( *pp != p_entry )
+        pp = &(*pp)->p_hash_next;
+    *pp = p_entry->p_hash_next;
+
+    LRURemove( p_cache, p_entry );
+    p_cache->i_size -= p_entry->i_size;
+
+    FT_Done_Glyph( p_entry->p_glyph );
+    if( p_entry->p_outline )
+        FT_Done_Glyph( p_entry->p_outline );
+    free( p_entry );
+}
+
+glyph_cache_t *GlyphCache_New( size_t i_max_size )
+{
+    glyph_cache_t *p_cache = calloc( 1, sizeof( *p_cache ) );
+    if( p_cache )
+        p_cache->i_max_size = i_max_size;
+    return p_cache;
+}
+
+void GlyphCache_Delete( glyph_cache_t *p_cache )
+{
+    while( p_cache->p_lru_first )
+        EntryDelete( p_cache, p_cache->p_lru_first );
+    free( p_cache );
+}
+
+bool GlyphCache_Get( glyph_cache_t *p_cache, FT_Face p_face,
+                     FT_UInt i_index, int i_flags, int i_radius,
+                     FT_Glyph *pp_glyph, FT_Glyph *pp_outline,
+                     FT_Vector *p_advance )
+{
+    glyph_cache_entry_t *p_entry =
+        p_cache->pp_buckets[ Hash( p_face, i_index, i_flags, i_radius ) ];
+
+    for( ; p_entry; p_entry = p_entry->p_hash_next )
+    {
+        if( p_entry->p_face == p_face && p_entry->i_index == i_index
+         && p_entry->i_flags == i_flags && p_entry->i_radius == i_radius )
+            break;
+    }
+
+    if( !p_entry )
+    {
+        p_cache->i_misses++;
+        return false;
+    }
+
+    *pp_outline = NULL;
+    if( FT_Glyph_Copy( p_entry->p_glyph, pp_glyph ) )
+        return false;
+    if( p_entry->p_outline
+     && FT_Glyph_Copy( p_entry->p_outline, pp_outline ) )
+    {
+        FT_Done_Glyph( *pp_glyph );
+        return false;
+    }
+    *p_advance = p_entry->advance;
+
+    if( p_cache->p_lru_first != p_entry )
+    {
+        LRURemove( p_cache, p_entry );
+        LRUPushFront( p_cache, p_entry );
+    }
+    p_cache->i_hits++;
+    return true;
+}
+
+void GlyphCache_Put( glyph_cache_t *p_cache, FT_Face p_face,
+                     FT_UInt i_index, int i_flags, int i_radius,
+                     FT_Glyph p_glyph, FT_Glyph p_outline,
+                     const FT_Vector *p_advance )
+{
+    const size_t i_size = sizeof(glyph_cache_entry_t)
+                        + GlyphSize( p_glyph ) + GlyphSize( p_outline );
+    if( i_size > p_cache->i_max_size )
+        return;
+
+    glyph_cache_entry_t *p_entry = malloc( sizeof( *p_entry ) );
+    if( unlikely(!p_entry) )
+        return;
+
+    p_entry->p_outline = NULL;
+    if( FT_Glyph_Copy( p_glyph, &p_entry->p_glyph ) )
+    {
+        free( p_entry );
+        return;
+    }
+    if( p_outline && FT_Glyph_Copy( p_outline, &p_entry->p_outline ) )
+    {
+        FT_Done_Glyph( p_entry->p_glyph );
+        free( p_entry );
+        return;
+    }
+
+    while( p_cache->p_lru_last
+        && p_cache->i_size + i_size > p_cache->i_max_size )
+        EntryDelete( p_cache, p_cache->p_lru_last );
+
+    p_entry->p_face   = p_face;
+    p_entry->i_index  = i_index;
+    p_entry->i_flags  = i_flags;
+    p_entry->i_radius = i_radius;
+    p_entry->advance  = *p_advance;
+    p_entry->i_size   = i_size;
+
+    glyph_cache_entry_t **pp_bucket =
+        &p_cache->pp_buckets[ Hash( p_face, i_index, i_flags, i_radius ) ];
+    p_entry->p_hash_next = *pp_bucket;
+    *pp_bucket = p_entry;
+    LRUPushFront( p_cache, p_entry );
+    p_cache->i_size += i_size;
+}
+
+void GlyphCache_GetStats( const glyph_cache_t *p_cache,
+                          uint64_t *pi_hits, uint64_t *pi_misses )
+{
+    *pi_hits = p_cache->i_hits;
+    *pi_misses = p_cache->i_misses;
+}
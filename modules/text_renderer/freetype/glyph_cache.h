@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * glyph_cache.h : Cache of loaded freetype glyphs
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_FREETYPE_GLYPH_CACHE_H
+#define VLC_FREETYPE_GLYPH_CACHE_H
+
+/** \ingroup freetype
+ * @{
+ * \file
+ * Glyph cache
+ *
+ * Loading, hinting, emboldening and stroking a glyph is the most expensive
+ * part of the layout, and tickers or captions render the same glyphs over
+ * and over. The cache keeps the resulting vector glyphs (and their stroked
+ * outlines) in LRU order, and hands out copies of them.
+ *
+ * Faces are owned by the face_map of the module and are sized once for all,
+ * so the face handle identifies both the font and its size.
+ */
+
+#include "freetype.h"
+
+/** Synthesized styles which are part of the cache key */
+#define GLYPH_CACHE_BOLD    0x1
+#define GLYPH_CACHE_ITALIC  0x2
+
+typedef struct glyph_cache_t glyph_cache_t;
+
+/**
+ * Creates a glyph cache using at most about \p i_max_size bytes.
+ */
+glyph_cache_t *GlyphCache_New( size_t i_max_size );
+
+/**
+ * Destroys the cache and all the glyphs it holds.
+ */
+void GlyphCache_Delete( glyph_cache_t *p_cache );
+
+/**
+ * Looks up a glyph.
+ *
+ * \param i_radius the outline stroker radius, or -1 without outline
+ * \param pp_glyph a copy of the glyph [OUT]
+ * \param pp_outline a copy of the stroked outline, if any [OUT]
+ * \param p_advance the advance of the glyph [OUT]
+ * \return true on hit, false if the glyph has to be loaded
+ */
+bool GlyphCache_Get( glyph_cache_t *p_cache, FT_Face p_face,
+                     FT_UInt i_index, int i_flags, int i_radius,
+                     FT_Glyph *pp_glyph, FT_Glyph *pp_outline,
+                     FT_Vector *p_advance );
+
+/**
+ * Stores copies of a freshly loaded glyph, evicting the least recently
+ * used ones if needed.
+ */
+void GlyphCache_Put( glyph_cache_t *p_cache, FT_Face p_face,
+                     FT_UInt i_index, int i_flags, int i_radius,
+                     FT_Glyph p_glyph, FT_Glyph p_outline,
+                     const FT_Vector *p_advance );
+
+/**
+ * Gets the hits and misses counters.
+ */
+void GlyphCache_GetStats( const glyph_cache_t *p_cache,
+                          uint64_t *pi_hits, uint64_t *pi_misses );
+
+/** @} */
+
+#endif
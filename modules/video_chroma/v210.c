@@ -0,0 +1,394 @@
+/*****************************************************************************
+ * v210.c: v210 (10 bits 4:2:2 packed) conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef V210_TEST
+# undef NDEBUG
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "v210.h"
+
+#ifdef HAVE_SSSE3_INTRINSICS
+# include <tmmintrin.h>
+#endif
+
+/*
+ * The samples of a line come in the UYVY order, three per 32-bits word.
+ * The C versions simply follow that order, so that partial groups of 6
+ * pixels at the end of the line are handled the same way as full ones.
+ */
+static void UnpackPlanar_C(uint16_t *y, uint16_t *u, uint16_t *v,
+                           const uint8_t *src, unsigned width)
+{
+    const unsigned count = 2 * width;
+
+    for (unsigned i = 0; i < count; src += 4) {
+        uint32_t word = GetDWLE(src);
+
+        for (unsigned j = 0; j < 3 && i < count; j++, i++, word >>= 10) {
+            const uint16_t sample = word & 0x3FF;
+
+            switch (i & 3) {
+                case 0:  *u++ = sample; break;
+                case 2:  *v++ = sample; break;
+                default: *y++ = sample; break;
+            }
+        }
+    }
+}
+
+static void UnpackUYVY_C(uint8_t *dst, const uint8_t *src, unsigned width)
+{
+    const unsigned count = 2 * width;
+
+    for (unsigned i = 0; i < count; src += 4) {
+        uint32_t word = GetDWLE(src);
+
+        for (unsigned j = 0; j < 3 && i < count; j++, i++, word >>= 10)
+            *dst++ = (word & 0x3FF) >> 2;
+    }
+}
+
+static inline uint32_t Clip10(unsigned sample)
+{
+    return sample < 4 ? 4 : sample > 1019 ? 1019 : sample;
+}
+
+static void PackPlanar_C(uint8_t *dst, const uint16_t *y, const uint16_t *u,
+                         const uint16_t *v, unsigned width)
+{
+    const unsigned count = 2 * width;
+
+    for (unsigned i = 0; i < count; dst += 4) {
+        uint32_t word = 0;
+
+        for (unsigned j = 0; j < 3 && i < count; j++, i++) {
+            unsigned sample;
+
+            switch (i & 3) {
+                case 0:  sample = *u++; break;
+                case 2:  sample = *v++; break;
+                default: sample = *y++; break;
+            }
+            word |= Clip10(sample) << (10 * j);
+        }
+        SetDWLE(dst, word);
+    }
+}
+
+#ifdef HAVE_SSSE3_INTRINSICS
+/*
+ * The SSSE3 versions process one group of 6 pixels (16 bytes of v210) per
+ * iteration. The stores (respectively the loads) of the planar samples
+ * are wider than a group: they overlap with the next group, and may hence
+ * only be used as long as 8 more pixels are available. The rest of the
+ * line is left to the C versions.
+ */
+#define Z (-1) /* zeroing shuffle index */
+
+/* Splits the 4 words of a group into their first, second and third
+ * samples, as 16-bits samples: [a0 a1 a2 a3 b0 b1 b2 b3] and [c0-c3 c0-c3],
+ * i.e. ab = [U0 Y1 V1 Y4 Y0 U1 Y3 V2] and c = [V0 Y2 U2 Y5 ...]. */
+__attribute__ ((__target__ ("ssse3")))
+static inline void Split_SSSE3(const uint8_t *src, __m128i *ab, __m128i *c)
+{
+    const __m128i mask = _mm_set1_epi32(0x3FF);
+    const __m128i words = _mm_loadu_si128((const __m128i *)src);
+    const __m128i a = _mm_and_si128(words, mask);
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(words, 10), mask);
+    const __m128i c32 = _mm_and_si128(_mm_srli_epi32(words, 20), mask);
+
+    *ab = _mm_packs_epi32(a, b);
+    *c = _mm_packs_epi32(c32, c32);
+}
+
+__attribute__ ((__target__ ("ssse3")))
+static void UnpackPlanar_SSSE3(uint16_t *y, uint16_t *u, uint16_t *v,
+                               const uint8_t *src, unsigned width)
+{
+    /* Y = [ab4 ab1 c1 ab6 ab3 c3], U = [ab0 ab5 c2], V = [c0 ab2 ab7] */
+    const __m128i y_ab = _mm_setr_epi8(8, 9, 2, 3, Z, Z, 12, 13, 6, 7,
+                                       Z, Z, Z, Z, Z, Z);
+    const __m128i y_c  = _mm_setr_epi8(Z, Z, Z, Z, 2, 3, Z, Z, Z, Z,
+                                       6, 7, Z, Z, Z, Z);
+    const __m128i u_ab = _mm_setr_epi8(0, 1, 10, 11, Z, Z, Z, Z,
+                                       Z, Z, Z, Z, Z, Z, Z, Z);
+    const __m128i u_c  = _mm_setr_epi8(Z, Z, Z, Z, 4, 5, Z, Z,
+                                       Z, Z, Z, Z, Z, Z, Z, Z);
+    const __m128i v_ab = _mm_setr_epi8(Z, Z, 4, 5, 14, 15, Z, Z,
+                                       Z, Z, Z, Z, Z, Z, Z, Z);
+    const __m128i v_c  = _mm_setr_epi8(0, 1, Z, Z, Z, Z, Z, Z,
+                                       Z, Z, Z, Z, Z, Z, Z, Z);
+    unsigned x = 0;
+
+    for (; x + 8 <= width; x += 6, src += 16, y += 6, u += 3, v += 3) {
+        __m128i ab, c;
+
+        Split_SSSE3(src, &ab, &c);
+        _mm_storeu_si128((__m128i *)y,
+                         _mm_or_si128(_mm_shuffle_epi8(ab, y_ab),
+                                      _mm_shuffle_epi8(c, y_c)));
+        _mm_storel_epi64((__m128i *)u,
+                         _mm_or_si128(_mm_shuffle_epi8(ab, u_ab),
+                                      _mm_shuffle_epi8(c, u_c)));
+        _mm_storel_epi64((__m128i *)v,
+                         _mm_or_si128(_mm_shuffle_epi8(ab, v_ab),
+                                      _mm_shuffle_epi8(c, v_c)));
+    }
+    UnpackPlanar_C(y, u, v, src, width - x);
+}
+
+__attribute__ ((__target__ ("ssse3")))
+static void UnpackUYVY_SSSE3(uint8_t *dst, const uint8_t *src, unsigned width)
+{
+    /* [a0 a1 a2 a3 b0 b1 b2 b3 c0 c1 c2 c3 ...] to [a0 b0 c0 a1 b1 c1 ...] */
+    const __m128i order = _mm_setr_epi8(0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11,
+                                        Z, Z, Z, Z);
+    unsigned x = 0;
+
+    for (; x + 8 <= width; x += 6, src += 16, dst += 12) {
+        __m128i ab, c;
+
+        Split_SSSE3(src, &ab, &c);
+        ab = _mm_srli_epi16(ab, 2);
+        c = _mm_srli_epi16(c, 2);
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_shuffle_epi8(_mm_packus_epi16(ab, c), order));
+    }
+    UnpackUYVY_C(dst, src, width - x);
+}
+
+__attribute__ ((__target__ ("ssse3")))
+static void PackPlanar_SSSE3(uint8_t *dst, const uint16_t *y,
+                             const uint16_t *u, const uint16_t *v,
+                             unsigned width)
+{
+    /* With uv = [U0 U1 U2 U3 V0 V1 V2 V3], the first, second and third
+     * samples of the words are a = [U0 Y1 V1 Y4], b = [Y0 U1 Y3 V2] and
+     * c = [V0 Y2 U2 Y5] */
+    const __m128i a_y  = _mm_setr_epi8(Z, Z, Z, Z, 2, 3, Z, Z,
+                                       Z, Z, Z, Z, 8, 9, Z, Z);
+    const __m128i a_uv = _mm_setr_epi8(0, 1, Z, Z, Z, Z, Z, Z,
+                                       10, 11, Z, Z, Z, Z, Z, Z);
+    const __m128i b_y  = _mm_setr_epi8(0, 1, Z, Z, Z, Z, Z, Z,
+                                       6, 7, Z, Z, Z, Z, Z, Z);
+    const __m128i b_uv = _mm_setr_epi8(Z, Z, Z, Z, 2, 3, Z, Z,
+                                       Z, Z, Z, Z, 12, 13, Z, Z);
+    const __m128i c_y  = _mm_setr_epi8(Z, Z, Z, Z, 4, 5, Z, Z,
+                                       Z, Z, Z, Z, 10, 11, Z, Z);
+    const __m128i c_uv = _mm_setr_epi8(8, 9, Z, Z, Z, Z, Z, Z,
+                                       4, 5, Z, Z, Z, Z, Z, Z);
+    const __m128i min = _mm_set1_epi16(4);
+    const __m128i max = _mm_set1_epi16(1019);
+    unsigned x = 0;
+
+    for (; x + 8 <= width; x += 6, dst += 16, y += 6, u += 3, v += 3) {
+        __m128i ys = _mm_loadu_si128((const __m128i *)y);
+        __m128i uv = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)u),
+                                        _mm_loadl_epi64((const __m128i *)v));
+
+        ys = _mm_min_epi16(_mm_max_epi16(ys, min), max);
+        uv = _mm_min_epi16(_mm_max_epi16(uv, min), max);
+
+        const __m128i a = _mm_or_si128(_mm_shuffle_epi8(ys, a_y),
+                                       _mm_shuffle_epi8(uv, a_uv));
+        const __m128i b = _mm_or_si128(_mm_shuffle_epi8(ys, b_y),
+                                       _mm_shuffle_epi8(uv, b_uv));
+        const __m128i c = _mm_or_si128(_mm_shuffle_epi8(ys, c_y),
+                                       _mm_shuffle_epi8(uv, c_uv));
+
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_or_si128(a, _mm_or_si128(_mm_slli_epi32(b, 10),
+                                                      _mm_slli_epi32(c, 20))));
+    }
+    PackPlanar_C(dst, y, u, v, width - x);
+}
+#undef Z
+#endif
+
+void v210_UnpackPlanar(uint16_t *y, uint16_t *u, uint16_t *v,
+                       const void *src, unsigned width)
+{
+#ifdef HAVE_SSSE3_INTRINSICS
+    if (vlc_CPU_SSSE3()) {
+        UnpackPlanar_SSSE3(y, u, v, src, width);
+        return;
+    }
+#endif
+    UnpackPlanar_C(y, u, v, src, width);
+}
+
+void v210_UnpackUYVY(uint8_t *dst, const void *src, unsigned width)
+{
+#ifdef HAVE_SSSE3_INTRINSICS
+    if (vlc_CPU_SSSE3()) {
+        UnpackUYVY_SSSE3(dst, src, width);
+        return;
+    }
+#endif
+    UnpackUYVY_C(dst, src, width);
+}
+
+void v210_PackPlanar(void *dst, const uint16_t *y, const uint16_t *u,
+                     const uint16_t *v, unsigned width)
+{
+#ifdef HAVE_SSSE3_INTRINSICS
+    if (vlc_CPU_SSSE3()) {
+        PackPlanar_SSSE3(dst, y, u, v, width);
+        return;
+    }
+#endif
+    PackPlanar_C(dst, y, u, v, width);
+}
+
+#ifdef V210_TEST
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const unsigned widths[] = {
+    2, 4, 6, 8, 10, 12, 14, 46, 48, 50, 720, 1280, 1918, 1920, 3840,
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+int main(void)
+{
+    alarm(10);
+    srand(42);
+
+#ifdef HAVE_SSSE3_INTRINSICS
+    const bool simd = vlc_CPU_SSSE3();
+#else
+    const bool simd = false;
+#endif
+    if (!simd)
+        fprintf(stderr, "WARNING: could not test SSSE3\n");
+
+    for (size_t i = 0; i < ARRAY_SIZE(widths); i++) {
+        const unsigned width = widths[i];
+        const size_t size = v210_LineSize(width);
+        uint8_t *line = malloc(size);
+        uint8_t *packed = malloc(size);
+        uint16_t *planes[2][3];
+        uint8_t *uyvy[2];
+        assert(line != NULL && packed != NULL);
+
+        for (size_t j = 0; j < size; j++)
+            line[j] = rand();
+
+        for (unsigned k = 0; k < 2; k++) {
+            /* One extra sample, to catch overflows */
+            for (unsigned p = 0; p < 3; p++) {
+                const unsigned count = p ? width / 2 : width;
+                planes[k][p] = malloc((count + 1) * sizeof (uint16_t));
+                assert(planes[k][p] != NULL);
+                planes[k][p][count] = 0xDEAD;
+            }
+            uyvy[k] = malloc(2 * width + 1);
+            assert(uyvy[k] != NULL);
+            uyvy[k][2 * width] = 0x5A;
+        }
+
+        /* Reference against the dispatched (possibly SIMD) versions */
+        UnpackPlanar_C(planes[0][0], planes[0][1], planes[0][2], line, width);
+        v210_UnpackPlanar(planes[1][0], planes[1][1], planes[1][2], line,
+                          width);
+        for (unsigned p = 0; p < 3; p++) {
+            const unsigned count = p ? width / 2 : width;
+            assert(!memcmp(planes[0][p], planes[1][p],
+                           (count + 1) * sizeof (uint16_t)));
+        }
+
+        UnpackUYVY_C(uyvy[0], line, width);
+        v210_UnpackUYVY(uyvy[1], line, width);
+        assert(!memcmp(uyvy[0], uyvy[1], 2 * width + 1));
+        for (unsigned x = 0; x < width; x++)
+            assert(uyvy[0][2 * x + 1] == planes[0][0][x] >> 2);
+
+        /* Round trip, with the out of range samples clipped */
+        memset(line, 0, size);
+        memset(packed, 0, size);
+        PackPlanar_C(line, planes[0][0], planes[0][1], planes[0][2], width);
+        v210_PackPlanar(packed, planes[0][0], planes[0][1], planes[0][2],
+                        width);
+        assert(!memcmp(line, packed, size));
+
+        UnpackPlanar_C(planes[1][0], planes[1][1], planes[1][2], packed,
+                       width);
+        for (unsigned p = 0; p < 3; p++) {
+            const unsigned count = p ? width / 2 : width;
+            for (unsigned x = 0; x < count; x++)
+                assert(planes[1][p][x] == Clip10(planes[0][p][x]));
+        }
+
+        /* Throughput of a 1080 lines frame */
+        if (width == 1920) {
+            const unsigned lines = 1080;
+            uint64_t start = now_ns();
+            for (unsigned l = 0; l < lines; l++)
+                UnpackPlanar_C(planes[0][0], planes[0][1], planes[0][2],
+                               packed, width);
+            uint64_t c_ns = now_ns() - start;
+
+            start = now_ns();
+            for (unsigned l = 0; l < lines; l++)
+                v210_UnpackPlanar(planes[0][0], planes[0][1], planes[0][2],
+                                  packed, width);
+            uint64_t unpack_ns = now_ns() - start;
+
+            start = now_ns();
+            for (unsigned l = 0; l < lines; l++)
+                v210_PackPlanar(packed, planes[0][0], planes[0][1],
+                                planes[0][2], width);
+            uint64_t pack_ns = now_ns() - start;
+
+            printf("1920x1080 frame: unpack C %"PRIu64" us, unpack %"PRIu64
+                   " us, pack %"PRIu64" us\n", c_ns / 1000, unpack_ns / 1000,
+                   pack_ns / 1000);
+        }
+
+        for (unsigned k = 0; k < 2; k++) {
+            for (unsigned p = 0; p < 3; p++)
+                free(planes[k][p]);
+            free(uyvy[k]);
+        }
+        free(packed);
+        free(line);
+    }
+
+    return 0;
+}
+#endif
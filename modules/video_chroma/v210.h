@@ -0,0 +1,62 @@
+/*****************************************************************************
+ * v210.h: v210 (10 bits 4:2:2 packed) conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_VIDEOCHROMA_V210_H_
+#define VLC_VIDEOCHROMA_V210_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * v210 stores 6 pixels (6 Y, 3 Cb and 3 Cr samples of 10 bits) in four
+ * little endian 32-bits words:
+ *   Cb0 Y0 Cr0 | Y1 Cb1 Y2 | Cr1 Y3 Cb2 | Y4 Cr2 Y5
+ * (the first sample in the lowest bits). Lines are padded to a multiple of
+ * 48 pixels, i.e. 128 bytes.
+ *
+ * The functions below convert one line of width pixels. They do not need
+ * any particular alignment.
+ */
+
+/* Size in bytes of a v210 line */
+static inline size_t v210_LineSize(unsigned width)
+{
+    return ((width + 47) / 48) * 128;
+}
+
+/* Unpacks to 16-bits planar 4:2:2 (I422_10L), e.g. for SDI capture */
+void v210_UnpackPlanar(uint16_t *y, uint16_t *u, uint16_t *v,
+                       const void *src, unsigned width);
+
+/* Unpacks to 8-bits UYVY, dropping the 2 least significant bits */
+void v210_UnpackUYVY(uint8_t *dst, const void *src, unsigned width);
+
+/* Packs from 16-bits planar 4:2:2 (I422_10L), e.g. for SDI output.
+ * The samples are clipped to [4;1019] as the other values are reserved for
+ * the SDI timing references. */
+void v210_PackPlanar(void *dst, const uint16_t *y, const uint16_t *u,
+                     const uint16_t *v, unsigned width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
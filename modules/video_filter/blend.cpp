@@ -32,8 +32,13 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#ifdef HAVE_SSE2_INTRINSICS
+# include <emmintrin.h>
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -60,6 +65,70 @@ void merge(T *dst, unsigned src, unsigned f)
     *dst = div255((255 - f) * (*dst) + src * f);
 }
 
+/* Merges count 8 bits samples from src into dst using the per sample
+ * factors in f. The results are identical to merge(). */
+static void mergeRow_C(uint8_t *dst, const uint8_t *src, const uint8_t *f,
+                       unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        if (f[i] > 0)
+            merge(&dst[i], src[i], f[i]);
+    }
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i mergeRow_SSE2_8(__m128i d, __m128i s, __m128i f)
+{
+    /* (255 - f) * d + f * s is at most 255 * 255 and fits in 16 bits,
+     * so is div255() applied on top of it */
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i c1   = _mm_set1_epi16(1);
+    __m128i v = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(c255, f), d),
+                              _mm_mullo_epi16(f, s));
+    v = _mm_add_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), c1);
+    return _mm_srli_epi16(v, 8);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void mergeRow_SSE2(uint8_t *dst, const uint8_t *src, const uint8_t *f,
+                          unsigned count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unsigned i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const __m128i f8 = _mm_loadu_si128((const __m128i *)&f[i]);
+        /* Fully transparent spans are common (subtitles, logos borders) */
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(f8, zero)) == 0xffff)
+            continue;
+        const __m128i d8 = _mm_loadu_si128((const __m128i *)&dst[i]);
+        const __m128i s8 = _mm_loadu_si128((const __m128i *)&src[i]);
+
+        const __m128i lo = mergeRow_SSE2_8(_mm_unpacklo_epi8(d8, zero),
+                                           _mm_unpacklo_epi8(s8, zero),
+                                           _mm_unpacklo_epi8(f8, zero));
+        const __m128i hi = mergeRow_SSE2_8(_mm_unpackhi_epi8(d8, zero),
+                                           _mm_unpackhi_epi8(s8, zero),
+                                           _mm_unpackhi_epi8(f8, zero));
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packus_epi16(lo, hi));
+    }
+    mergeRow_C(&dst[i], &src[i], &f[i], count - i);
+}
+#endif
+
+static void mergeRow(uint8_t *dst, const uint8_t *src, const uint8_t *f,
+                     unsigned count)
+{
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2()) {
+        mergeRow_SSE2(dst, src, f, count);
+        return;
+    }
+#endif
+    mergeRow_C(dst, src, f, count);
+}
+
 struct CPixel {
     unsigned i, j, k;
     unsigned a;
@@ -120,10 +189,17 @@ public:
     void merge(unsigned dx, const CPixel &spx, unsigned a, bool full)
     {
         ::merge(getPointer(0, dx), spx.i, a);
-        if (full) {
-            ::merge(getPointer(1, dx), spx.j, a);
-            ::merge(getPointer(2, dx), spx.k, a);
-        }
+        if (full)
+            mergeChroma(dx, spx, a);
+    }
+    void mergeChroma(unsigned dx, const CPixel &spx, unsigned a)
+    {
+        ::merge(getPointer(1, dx), spx.j, a);
+        ::merge(getPointer(2, dx), spx.k, a);
+    }
+    pixel *getSamples(unsigned dx) const
+    {
+        return getPointer(0, dx);
     }
     bool isFull(unsigned dx) const
     {
@@ -170,10 +246,17 @@ public:
     void merge(unsigned dx, const CPixel &spx, unsigned a, bool full)
     {
         ::merge(getPointer(0, dx), spx.i, a);
-        if (full) {
-            ::merge(&getPointer(1, dx)[ swap_uv], spx.j, a);
-            ::merge(&getPointer(1, dx)[!swap_uv], spx.k, a);
-        }
+        if (full)
+            mergeChroma(dx, spx, a);
+    }
+    void mergeChroma(unsigned dx, const CPixel &spx, unsigned a)
+    {
+        ::merge(&getPointer(1, dx)[ swap_uv], spx.j, a);
+        ::merge(&getPointer(1, dx)[!swap_uv], spx.k, a);
+    }
+    uint8_t *getSamples(unsigned dx) const
+    {
+        return getPointer(0, dx);
     }
     bool isFull(unsigned dx) const
     {
@@ -265,6 +348,8 @@ private:
 template <unsigned bytes, bool has_alpha>
 class CPictureRGBX : public CPicture {
 public:
+    static const unsigned pixel_size = bytes;
+
     CPictureRGBX(const CPicture &cfg) : CPicture(cfg)
     {
         if (has_alpha) {
@@ -327,6 +412,22 @@ public:
             ::merge(&dst[offset_b], spx.k, a);
         }
     }
+    /* Stores a pixel and its blending factor using the layout of the
+     * picture, so that a whole line can be merged with mergeRow() */
+    void pack(uint8_t *px, uint8_t *f, const CPixel &spx, unsigned a) const
+    {
+        static_assert(!has_alpha, "destination alpha needs a per pixel merge");
+        memset(px, 0, bytes);
+        memset(f, 0, bytes);
+        px[offset_r] = spx.i;
+        px[offset_g] = spx.j;
+        px[offset_b] = spx.k;
+        f[offset_r] = f[offset_g] = f[offset_b] = a;
+    }
+    uint8_t *getSamples(unsigned dx) const
+    {
+        return getPointer(dx);
+    }
     void nextLine()
     {
         y++;
@@ -548,6 +649,99 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
     }
 }
 
+/* Number of pixels converted at once by the row based blending */
+#define BLEND_ROW_SIZE 256
+
+/* Row based blending for 8 bits planar and semi-planar YUV: the source is
+ * converted a line chunk at a time, the luma is merged with mergeRow() and
+ * only the chroma remains merged pixel by pixel. */
+template <class TDst, class TSrc, class TConvert>
+void BlendRows(const CPicture &dst_data, const CPicture &src_data,
+               unsigned width, unsigned height, int alpha)
+{
+    TSrc src(src_data);
+    TDst dst(dst_data);
+    TConvert convert(dst_data.getFormat(), src_data.getFormat());
+
+    uint8_t luma[BLEND_ROW_SIZE];
+    uint8_t u[BLEND_ROW_SIZE];
+    uint8_t v[BLEND_ROW_SIZE];
+    uint8_t f[BLEND_ROW_SIZE];
+
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x0 = 0; x0 < width; x0 += BLEND_ROW_SIZE) {
+            const unsigned count = __MIN(width - x0, BLEND_ROW_SIZE);
+            bool visible = false;
+
+            for (unsigned i = 0; i < count; i++) {
+                CPixel spx;
+
+                src.get(&spx, x0 + i);
+                convert(spx);
+
+                luma[i] = spx.i;
+                u[i]    = spx.j;
+                v[i]    = spx.k;
+                f[i]    = div255(alpha * spx.a);
+                visible |= f[i] > 0;
+            }
+            if (!visible)
+                continue;
+
+            mergeRow(dst.getSamples(x0), luma, f, count);
+
+            for (unsigned i = 0; i < count; i++) {
+                if (f[i] > 0 && dst.isFull(x0 + i)) {
+                    CPixel spx;
+                    spx.j = u[i];
+                    spx.k = v[i];
+                    dst.mergeChroma(x0 + i, spx, f[i]);
+                }
+            }
+        }
+        src.nextLine();
+        dst.nextLine();
+    }
+}
+
+/* Row based blending for packed RGB without alpha: the source is stored in
+ * the destination layout along with the per byte factors, and the whole
+ * line is then merged with mergeRow(). */
+template <class TDst, class TSrc, class TConvert>
+void BlendPackedRows(const CPicture &dst_data, const CPicture &src_data,
+                     unsigned width, unsigned height, int alpha)
+{
+    TSrc src(src_data);
+    TDst dst(dst_data);
+    TConvert convert(dst_data.getFormat(), src_data.getFormat());
+
+    const unsigned size = TDst::pixel_size;
+    uint8_t data[BLEND_ROW_SIZE * TDst::pixel_size];
+    uint8_t f[BLEND_ROW_SIZE * TDst::pixel_size];
+
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x0 = 0; x0 < width; x0 += BLEND_ROW_SIZE) {
+            const unsigned count = __MIN(width - x0, BLEND_ROW_SIZE);
+            bool visible = false;
+
+            for (unsigned i = 0; i < count; i++) {
+                CPixel spx;
+
+                src.get(&spx, x0 + i);
+                convert(spx);
+
+                const unsigned a = div255(alpha * spx.a);
+                dst.pack(&data[i * size], &f[i * size], spx, a);
+                visible |= a > 0;
+            }
+            if (visible)
+                mergeRow(dst.getSamples(x0), data, f, count * size);
+        }
+        src.nextLine();
+        dst.nextLine();
+    }
+}
+
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
@@ -558,6 +752,8 @@ static const struct {
 } blends[] = {
 #undef RGB
 #undef YUV
+#undef RGB_ROWS
+#undef YUV_ROWS
 #define RGB(csp, picture, cvt) \
     { csp, VLC_CODEC_YUVA, Blend<picture, CPictureYUVA, compose<cvt, convertYuv8ToRgb> > }, \
     { csp, VLC_CODEC_RGBA, Blend<picture, CPictureRGBA, compose<cvt, convertNone> > }, \
@@ -566,24 +762,32 @@ static const struct {
     { csp, VLC_CODEC_YUVA, Blend<picture, CPictureYUVA, compose<cvt, convertNone> > }, \
     { csp, VLC_CODEC_RGBA, Blend<picture, CPictureRGBA, compose<cvt, convertRgbToYuv8> > }, \
     { csp, VLC_CODEC_YUVP, Blend<picture, CPictureYUVP, compose<cvt, convertYuvpToYuva8> > }
+#define RGB_ROWS(csp, picture) \
+    { csp, VLC_CODEC_YUVA, BlendPackedRows<picture, CPictureYUVA, convertYuv8ToRgb> }, \
+    { csp, VLC_CODEC_RGBA, BlendPackedRows<picture, CPictureRGBA, convertNone> }, \
+    { csp, VLC_CODEC_YUVP, BlendPackedRows<picture, CPictureYUVP, convertYuvpToRgba> }
+#define YUV_ROWS(csp, picture) \
+    { csp, VLC_CODEC_YUVA, BlendRows<picture, CPictureYUVA, convertNone> }, \
+    { csp, VLC_CODEC_RGBA, BlendRows<picture, CPictureRGBA, convertRgbToYuv8> }, \
+    { csp, VLC_CODEC_YUVP, BlendRows<picture, CPictureYUVP, convertYuvpToYuva8> }
 
     RGB(VLC_CODEC_RGB15,    CPictureRGB16,    convertRgbToRgbSmall),
     RGB(VLC_CODEC_RGB16,    CPictureRGB16,    convertRgbToRgbSmall),
-    RGB(VLC_CODEC_RGB24,    CPictureRGB24,    convertNone),
-    RGB(VLC_CODEC_RGB32,    CPictureRGB32,    convertNone),
+    RGB_ROWS(VLC_CODEC_RGB24, CPictureRGB24),
+    RGB_ROWS(VLC_CODEC_RGB32, CPictureRGB32),
     RGB(VLC_CODEC_RGBA,     CPictureRGBA,     convertNone),
     RGB(VLC_CODEC_BGRA,     CPictureBGRA,     convertNone),
 
-    YUV(VLC_CODEC_YV9,      CPictureYV9,      convertNone),
-    YUV(VLC_CODEC_I410,     CPictureI410_8,   convertNone),
+    YUV_ROWS(VLC_CODEC_YV9,      CPictureYV9),
+    YUV_ROWS(VLC_CODEC_I410,     CPictureI410_8),
 
-    YUV(VLC_CODEC_I411,     CPictureI411_8,   convertNone),
+    YUV_ROWS(VLC_CODEC_I411,     CPictureI411_8),
 
-    YUV(VLC_CODEC_YV12,     CPictureYV12,     convertNone),
-    YUV(VLC_CODEC_NV12,     CPictureNV12,     convertNone),
-    YUV(VLC_CODEC_NV21,     CPictureNV21,     convertNone),
-    YUV(VLC_CODEC_J420,     CPictureI420_8,   convertNone),
-    YUV(VLC_CODEC_I420,     CPictureI420_8,   convertNone),
+    YUV_ROWS(VLC_CODEC_YV12,     CPictureYV12),
+    YUV_ROWS(VLC_CODEC_NV12,     CPictureNV12),
+    YUV_ROWS(VLC_CODEC_NV21,     CPictureNV21),
+    YUV_ROWS(VLC_CODEC_J420,     CPictureI420_8),
+    YUV_ROWS(VLC_CODEC_I420,     CPictureI420_8),
 #ifdef WORDS_BIGENDIAN
     YUV(VLC_CODEC_I420_9B,  CPictureI420_16,  convert8To9Bits),
     YUV(VLC_CODEC_I420_10B, CPictureI420_16,  convert8To10Bits),
@@ -592,8 +796,8 @@ static const struct {
     YUV(VLC_CODEC_I420_10L, CPictureI420_16,  convert8To10Bits),
 #endif
 
-    YUV(VLC_CODEC_J422,     CPictureI422_8,   convertNone),
-    YUV(VLC_CODEC_I422,     CPictureI422_8,   convertNone),
+    YUV_ROWS(VLC_CODEC_J422,     CPictureI422_8),
+    YUV_ROWS(VLC_CODEC_I422,     CPictureI422_8),
 #ifdef WORDS_BIGENDIAN
     YUV(VLC_CODEC_I422_9B,  CPictureI422_16,  convert8To9Bits),
     YUV(VLC_CODEC_I422_10B, CPictureI422_16,  convert8To10Bits),
@@ -602,8 +806,8 @@ static const struct {
     YUV(VLC_CODEC_I422_10L, CPictureI422_16,  convert8To10Bits),
 #endif
 
-    YUV(VLC_CODEC_J444,     CPictureI444_8,   convertNone),
-    YUV(VLC_CODEC_I444,     CPictureI444_8,   convertNone),
+    YUV_ROWS(VLC_CODEC_J444,     CPictureI444_8),
+    YUV_ROWS(VLC_CODEC_I444,     CPictureI444_8),
 #ifdef WORDS_BIGENDIAN
     YUV(VLC_CODEC_I444_9B,  CPictureI444_16,  convert8To9Bits),
     YUV(VLC_CODEC_I444_10B, CPictureI444_16,  convert8To10Bits),
@@ -621,6 +825,8 @@ static const struct {
 
 #undef RGB
 #undef YUV
+#undef RGB_ROWS
+#undef YUV_ROWS
 };
 
 struct filter_sys_t {
@@ -45,6 +45,8 @@
 #include <vlc_aout.h>
 #include <arpa/inet.h>
 
+#include "../video_chroma/v210.h"
+
 #include <DeckLinkAPI.h>
 #include <DeckLinkAPIDispatch.cpp>
 
@@ -776,63 +778,21 @@ static inline void put_le32(uint8_t **p, uint32_t d)
     (*p) += 4;
 }
 
-static inline int clip(int a)
-{
-    if      (a < 4) return 4;
-    else if (a > 1019) return 1019;
-    else               return a;
-}
-
 static void v210_convert(void *frame_bytes, picture_t *pic, int dst_stride)
 {
     int width = pic->format.i_width;
     int height = pic->format.i_height;
-    int line_padding = dst_stride - ((width * 8 + 11) / 12) * 4;
-    int h, w;
+    int line_size = ((width * 8 + 11) / 12) * 4;
     uint8_t *data = (uint8_t*)frame_bytes;
 
-    const uint16_t *y = (const uint16_t*)pic->p[0].p_pixels;
-    const uint16_t *u = (const uint16_t*)pic->p[1].p_pixels;
-    const uint16_t *v = (const uint16_t*)pic->p[2].p_pixels;
-
-#define WRITE_PIXELS(a, b, c)           \
-    do {                                \
-        val =   clip(*a++);             \
-        val |= (clip(*b++) << 10) |     \
-               (clip(*c++) << 20);      \
-        put_le32(&data, val);           \
-    } while (0)
-
-    for (h = 0; h < height; h++) {
-        uint32_t val = 0;
-        for (w = 0; w < width - 5; w += 6) {
-            WRITE_PIXELS(u, y, v);
-            WRITE_PIXELS(y, u, y);
-            WRITE_PIXELS(v, y, u);
-            WRITE_PIXELS(y, v, y);
-        }
-        if (w < width - 1) {
-            WRITE_PIXELS(u, y, v);
-
-            val = clip(*y++);
-            if (w == width - 2)
-                put_le32(&data, val);
-#undef WRITE_PIXELS
-        }
-        if (w < width - 3) {
-            val |= (clip(*u++) << 10) | (clip(*y++) << 20);
-            put_le32(&data, val);
-
-            val = clip(*v++) | (clip(*y++) << 10);
-            put_le32(&data, val);
-        }
-
-        memset(data, 0, line_padding);
-        data += line_padding;
+    for (int h = 0; h < height; h++) {
+        const uint16_t *y = (const uint16_t*)&pic->p[0].p_pixels[h * pic->p[0].i_pitch];
+        const uint16_t *u = (const uint16_t*)&pic->p[1].p_pixels[h * pic->p[1].i_pitch];
+        const uint16_t *v = (const uint16_t*)&pic->p[2].p_pixels[h * pic->p[2].i_pitch];
 
-        y += pic->p[0].i_pitch / 2 - width;
-        u += pic->p[1].i_pitch / 2 - width / 2;
-        v += pic->p[2].i_pitch / 2 - width / 2;
+        v210_PackPlanar(data, y, u, v, width);
+        memset(data + line_size, 0, dst_stride - line_size);
+        data += dst_stride;
     }
 }
 
@@ -37,6 +37,7 @@
 #include <libvlc.h>
 #include "stream.h"
 #include "input_internal.h"
+#include "../misc/tracer.h"
 
 /* Decode URL (which has had its scheme stripped earlier) to a file path. */
 char *get_path(const char *location)
@@ -195,8 +196,14 @@ static block_t *AStreamReadBlock(stream_t *s, bool *restrict eof)
     if (vlc_killed())
         return NULL;
 
+    vlc_tracer_t *tracer = libvlc_tracer(s);
+    mtime_t trace_start = vlc_tracer_Begin(tracer);
+
     block = vlc_stream_ReadBlock(access);
 
+    vlc_tracer_End(tracer, VLC_TRACER_ACCESS_READ, trace_start,
+                   VLC_TS_INVALID);
+
     if (block != NULL && input != NULL)
     {
         uint64_t total;
@@ -223,8 +230,14 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
     if (vlc_killed())
         return -1;
 
+    vlc_tracer_t *tracer = libvlc_tracer(s);
+    mtime_t trace_start = vlc_tracer_Begin(tracer);
+
     ssize_t val = vlc_stream_ReadPartial(access, buf, len);
 
+    vlc_tracer_End(tracer, VLC_TRACER_ACCESS_READ, trace_start,
+                   VLC_TS_INVALID);
+
     if (val > 0 && input != NULL)
     {
         uint64_t total;
@@ -291,7 +304,10 @@ stream_t *stream_AccessNew(vlc_object_t *parent, input_thread_t *input,
     if (access->pf_block != NULL)
     {
         s->pf_block = AStreamReadBlock;
-        cachename = "prefetch,cache_block";
+        if (var_InheritBool(access, "input-block-passthrough"))
+            cachename = NULL; /* blocks are passed by reference */
+        else
+            cachename = "prefetch,cache_block";
     }
     else
     if (access->pf_read != NULL)
@@ -34,6 +34,7 @@
 #include <vlc_input.h>
 #include "clock.h"
 #include <assert.h>
+#include <math.h>
 
 /* TODO:
  * - clean up locking once clock code is stable
@@ -66,6 +67,14 @@
  *
  * It is a very important matter if you want to avoid underflow or overflow
  * in all the FIFOs, but it may be not enough.
+ *
+ * The average only follows the phase of the server clock: when the server
+ * clock runs at a slightly different rate than ours, it lags behind by the
+ * drift accumulated over the averaging window. The optional PLL mode
+ * (--clock-pll) tracks both the phase and the rate of the server clock
+ * with a critically damped second order loop, so that the converted
+ * timestamps follow the server rate smoothly, and it separates the
+ * reception jitter (the residual error) from the clock drift (the rate).
  */
 
 /* i_cr_average : Maximum number of samples used to compute the
@@ -122,6 +131,24 @@ static void    AvgUpdate( average_t *, mtime_t i_value );
 static mtime_t AvgGet( average_t * );
 static void    AvgRescale( average_t *, int i_divider );
 
+/**
+ * This structure holds the state of the clock recovery loop
+ */
+typedef struct
+{
+    bool    b_locked;
+    mtime_t i_system;   /* date of the last update */
+    double  f_phase;    /* estimated drift at i_system */
+    double  f_freq;     /* drift variation per system clock unit */
+    mtime_t i_tau;      /* loop time constant */
+} pll_t;
+static void    PllReset( pll_t * );
+static double  PllUpdate( pll_t *, mtime_t i_system, mtime_t i_value );
+static mtime_t PllGet( const pll_t *, mtime_t i_system );
+
+/* Maximal drift rate tracked by the PLL (500 ppm) */
+#define CR_PLL_MAX_FREQ (0.0005)
+
 /* */
 typedef struct
 {
@@ -157,6 +184,11 @@ struct input_clock_t
     /* Clock drift */
     mtime_t i_next_drift_update;
     average_t drift;
+    bool      b_pll;
+    pll_t     pll;
+
+    /* Reception jitter (mean absolute drift estimation error) */
+    double    f_jitter;
 
     /* Late statistics */
     struct
@@ -184,11 +216,12 @@ static mtime_t ClockStreamToSystem( input_clock_t *, mtime_t i_stream );
 static mtime_t ClockSystemToStream( input_clock_t *, mtime_t i_system );
 
 static mtime_t ClockGetTsOffset( input_clock_t * );
+static mtime_t ClockGetDrift( input_clock_t *, mtime_t i_stream );
 
 /*****************************************************************************
  * input_clock_New: create a new clock
  *****************************************************************************/
-input_clock_t *input_clock_New( int i_rate )
+input_clock_t *input_clock_New( int i_rate, bool b_pll )
 {
     input_clock_t *cl = malloc( sizeof(*cl) );
     if( !cl )
@@ -207,6 +240,10 @@ input_clock_t *input_clock_New( int i_rate )
 
     cl->i_next_drift_update = VLC_TS_INVALID;
     AvgInit( &cl->drift, 10 );
+    cl->b_pll = b_pll;
+    cl->pll.i_tau = 10 * CLOCK_FREQ/5;
+    PllReset( &cl->pll );
+    cl->f_jitter = 0.;
 
     cl->late.i_index = 0;
     for( int i = 0; i < INPUT_CLOCK_LATE_COUNT; i++ )
@@ -272,6 +309,7 @@ void input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
     {
         cl->i_next_drift_update = VLC_TS_INVALID;
         AvgReset( &cl->drift );
+        PllReset( &cl->pll );
 
         /* Feed synchro with a new reference point. */
         cl->b_has_reference = true;
@@ -282,11 +320,22 @@ void input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
 
     /* Compute the drift between the stream clock and the system clock
      * when we don't control the source pace */
-    if( !b_can_pace_control && cl->i_next_drift_update < i_ck_system )
+    if( !b_can_pace_control && cl->b_pll )
+    {
+        const mtime_t i_converted = ClockSystemToStream( cl, i_ck_system );
+        const double f_error = PllUpdate( &cl->pll, i_ck_system,
+                                          i_converted - i_ck_stream );
+
+        cl->f_jitter += ( fabs( f_error ) - cl->f_jitter ) / 16.;
+    }
+    else if( !b_can_pace_control && cl->i_next_drift_update < i_ck_system )
     {
         const mtime_t i_converted = ClockSystemToStream( cl, i_ck_system );
+        const mtime_t i_error = i_converted - i_ck_stream - AvgGet( &cl->drift );
 
         AvgUpdate( &cl->drift, i_converted - i_ck_stream );
+        if( cl->drift.i_count > 1 )
+            cl->f_jitter += ( llabs( i_error ) - cl->f_jitter ) / 16.;
 
         cl->i_next_drift_update = i_ck_system + CLOCK_FREQ/5; /* FIXME why that */
     }
@@ -314,7 +363,7 @@ void input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
 
     /* It does not take the decoder latency into account but it is not really
      * the goal of the clock here */
-    const mtime_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + AvgGet( &cl->drift ) );
+    const mtime_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + ClockGetDrift( cl, i_ck_stream ) );
     const mtime_t i_late = ( i_ck_system - cl->i_pts_delay ) - i_system_expected;
     *pb_late = i_late > 0;
     if( i_late > 0 )
@@ -375,6 +424,7 @@ void input_clock_ChangePause( input_clock_t *cl, bool b_paused, mtime_t i_date )
         {
             cl->ref.i_system += i_duration;
             cl->last.i_system += i_duration;
+            cl->pll.i_system += i_duration;
         }
     }
     cl->i_pause_date = i_date;
@@ -394,7 +444,7 @@ mtime_t input_clock_GetWakeup( input_clock_t *cl )
 
     /* Synchronized, we can wait */
     if( cl->b_has_reference )
-        i_wakeup = ClockStreamToSystem( cl, cl->last.i_stream + AvgGet( &cl->drift ) - cl->i_buffering_duration );
+        i_wakeup = ClockStreamToSystem( cl, cl->last.i_stream + ClockGetDrift( cl, cl->last.i_stream ) - cl->i_buffering_duration );
 
     vlc_mutex_unlock( &cl->lock );
 
@@ -432,7 +482,7 @@ int input_clock_ConvertTS( vlc_object_t *p_object, input_clock_t *cl,
     /* */
     if( *pi_ts0 > VLC_TS_INVALID )
     {
-        *pi_ts0 = ClockStreamToSystem( cl, *pi_ts0 + AvgGet( &cl->drift ) );
+        *pi_ts0 = ClockStreamToSystem( cl, *pi_ts0 + ClockGetDrift( cl, *pi_ts0 ) );
         if( *pi_ts0 > cl->i_ts_max )
             cl->i_ts_max = *pi_ts0;
         *pi_ts0 += i_ts_delay;
@@ -441,7 +491,7 @@ int input_clock_ConvertTS( vlc_object_t *p_object, input_clock_t *cl,
     /* XXX we do not update i_ts_max on purpose */
     if( pi_ts1 && *pi_ts1 > VLC_TS_INVALID )
     {
-        *pi_ts1 = ClockStreamToSystem( cl, *pi_ts1 + AvgGet( &cl->drift ) ) +
+        *pi_ts1 = ClockStreamToSystem( cl, *pi_ts1 + ClockGetDrift( cl, *pi_ts1 ) ) +
                   i_ts_delay;
     }
 
@@ -519,6 +569,7 @@ void input_clock_ChangeSystemOrigin( input_clock_t *cl, bool b_absolute, mtime_t
 
     cl->ref.i_system += i_offset;
     cl->last.i_system += i_offset;
+    cl->pll.i_system += i_offset;
 
     vlc_mutex_unlock( &cl->lock );
 }
@@ -572,6 +623,19 @@ void input_clock_SetJitter( input_clock_t *cl,
 
     if( cl->drift.i_divider != i_cr_average )
         AvgRescale( &cl->drift, i_cr_average );
+    /* Same time constant as the average (sampled every 200ms) */
+    cl->pll.i_tau = i_cr_average * CLOCK_FREQ/5;
+
+    vlc_mutex_unlock( &cl->lock );
+}
+
+void input_clock_GetDriftStats( input_clock_t *cl,
+                                mtime_t *pi_jitter, double *pf_drift )
+{
+    vlc_mutex_lock( &cl->lock );
+
+    *pi_jitter = llround( cl->f_jitter );
+    *pf_drift = cl->b_pll && cl->pll.b_locked ? cl->pll.f_freq * 1e6 : 0.;
 
     vlc_mutex_unlock( &cl->lock );
 }
@@ -631,6 +695,18 @@ static mtime_t ClockGetTsOffset( input_clock_t *cl )
     return cl->i_pts_delay * ( cl->i_rate - INPUT_RATE_DEFAULT ) / INPUT_RATE_DEFAULT;
 }
 
+/**
+ * It returns the drift to apply to a stream timestamp
+ */
+static mtime_t ClockGetDrift( input_clock_t *cl, mtime_t i_stream )
+{
+    if( !cl->b_pll )
+        return AvgGet( &cl->drift );
+
+    /* Extrapolate the drift to the date at which the timestamp is due */
+    return PllGet( &cl->pll, ClockStreamToSystem( cl, i_stream ) );
+}
+
 /*****************************************************************************
  * Long term average helpers
  *****************************************************************************/
@@ -673,3 +749,58 @@ static void AvgRescale( average_t *p_avg, int i_divider )
     p_avg->i_value   = i_tmp / p_avg->i_divider;
     p_avg->i_residue = i_tmp % p_avg->i_divider;
 }
+
+/*****************************************************************************
+ * Clock recovery loop helpers
+ *****************************************************************************/
+static void PllReset( pll_t *p_pll )
+{
+    p_pll->b_locked = false;
+    p_pll->i_system = VLC_TS_INVALID;
+    p_pll->f_phase = 0.;
+    p_pll->f_freq = 0.;
+}
+
+/* Returns the error between the measurement and the prediction */
+static double PllUpdate( pll_t *p_pll, mtime_t i_system, mtime_t i_value )
+{
+    if( !p_pll->b_locked )
+    {
+        p_pll->b_locked = true;
+        p_pll->i_system = i_system;
+        p_pll->f_phase = i_value;
+        p_pll->f_freq = 0.;
+        return 0.;
+    }
+
+    const mtime_t i_dt = __MAX( i_system - p_pll->i_system, 0 );
+    const double f_predicted = p_pll->f_phase + p_pll->f_freq * i_dt;
+    const double f_error = i_value - f_predicted;
+
+    /* Critically damped alpha-beta filter, whose gains depend on the time
+     * elapsed since the previous measurement */
+    const double f_theta = exp( -(double)i_dt / p_pll->i_tau );
+    const double f_alpha = 1. - f_theta * f_theta;
+    const double f_beta = ( 1. - f_theta ) * ( 1. - f_theta );
+
+    p_pll->f_phase = f_predicted + f_alpha * f_error;
+    if( i_dt > 0 )
+    {
+        p_pll->f_freq += f_beta * f_error / i_dt;
+        if( p_pll->f_freq > CR_PLL_MAX_FREQ )
+            p_pll->f_freq = CR_PLL_MAX_FREQ;
+        else if( p_pll->f_freq < -CR_PLL_MAX_FREQ )
+            p_pll->f_freq = -CR_PLL_MAX_FREQ;
+    }
+    p_pll->i_system = i_system;
+
+    return f_error;
+}
+
+static mtime_t PllGet( const pll_t *p_pll, mtime_t i_system )
+{
+    if( !p_pll->b_locked )
+        return 0;
+    return llround( p_pll->f_phase
+                  + p_pll->f_freq * ( i_system - p_pll->i_system ) );
+}
@@ -39,8 +39,11 @@ typedef struct input_clock_t input_clock_t;
 /**
  * This function creates a new input_clock_t.
  * You must use input_clock_Delete to delete it once unused.
+ *
+ * \param b_pll tells if the drift is recovered with a PLL instead of an
+ * average.
  */
-input_clock_t *input_clock_New( int i_rate );
+input_clock_t *input_clock_New( int i_rate, bool b_pll );
 
 /**
  * This function destroys a input_clock_t created by input_clock_New.
@@ -136,4 +139,11 @@ void input_clock_SetJitter( input_clock_t *,
  */
 mtime_t input_clock_GetJitter( input_clock_t * );
 
+/**
+ * This function returns the estimated reception jitter and, in PLL mode,
+ * the drift of the stream clock relative to the system clock (in ppm).
+ */
+void input_clock_GetDriftStats( input_clock_t *, mtime_t *pi_jitter,
+                                double *pf_drift );
+
 #endif
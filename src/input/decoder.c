@@ -53,6 +53,7 @@
 #include "resource.h"
 
 #include "../video_output/vout_control.h"
+#include "../misc/tracer.h"
 
 /*
  * Possibles values set in p_owner->reload atomic
@@ -96,6 +97,10 @@ struct decoder_owner_sys_t
 
     /* fifo */
     block_fifo_t *p_fifo;
+    mtime_t       i_fifo_delay; /* 0 if unbounded (low latency) */
+    bool          b_fifo_resync; /* waiting for a random access point */
+    bool          b_fifo_intra; /* all the blocks are random access points */
+    bool          b_fifo_keyframes; /* the random access points are flagged */
 
     /* Lock for communication with decoder thread */
     vlc_mutex_t lock;
@@ -780,6 +785,8 @@ static void DecoderFixTs( decoder_t *p_dec, mtime_t *pi_ts0, mtime_t *pi_ts1,
         return;
 
     const bool b_ephemere = pi_ts1 && *pi_ts0 == *pi_ts1;
+    const mtime_t i_ts0 = *pi_ts0;
+    const mtime_t i_ts1 = pi_ts1 ? *pi_ts1 : VLC_TS_INVALID;
     int i_rate;
 
     if( *pi_ts0 > VLC_TS_INVALID )
@@ -808,6 +815,14 @@ static void DecoderFixTs( decoder_t *p_dec, mtime_t *pi_ts0, mtime_t *pi_ts1,
     if( !b_ephemere && pi_ts1 && *pi_ts0 == *pi_ts1 )
         *pi_ts1 += 1;
 
+    vlc_tracer_t *tracer = libvlc_tracer( p_dec );
+    if( unlikely(tracer != NULL) )
+    {
+        vlc_tracer_Alias( tracer, *pi_ts0, i_ts0 );
+        if( pi_ts1 )
+            vlc_tracer_Alias( tracer, *pi_ts1, i_ts1 );
+    }
+
     if( pi_duration )
         *pi_duration = ( *pi_duration * i_rate + INPUT_RATE_DEFAULT-1 )
             / INPUT_RATE_DEFAULT;
@@ -1324,12 +1339,24 @@ static int DecoderQueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
     return i_ret;
 }
 
+/* Timestamp identifying the frame of a block in the traces */
+static inline mtime_t DecoderTraceTs( const block_t *p_block )
+{
+    return p_block->i_pts > VLC_TS_INVALID ? p_block->i_pts : p_block->i_dts;
+}
+
 static void DecoderProcess( decoder_t *p_dec, block_t *p_block );
 static void DecoderDecode( decoder_t *p_dec, block_t *p_block )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    vlc_tracer_t *tracer = libvlc_tracer( p_dec );
+    mtime_t trace_start = vlc_tracer_Begin( tracer );
+    mtime_t trace_ts = p_block != NULL ? DecoderTraceTs( p_block )
+                                       : VLC_TS_INVALID;
 
     int ret = p_dec->pf_decode( p_dec, p_block );
+
+    vlc_tracer_End( tracer, VLC_TRACER_DECODE, trace_start, trace_ts );
     switch( ret )
     {
         case VLCDEC_SUCCESS:
@@ -1633,6 +1660,33 @@ static void *DecoderThread( void *p_data )
     vlc_assert_unreachable();
 }
 
+/* Whether all the frames of a codec can be decoded on their own */
+static bool DecoderIsIntraOnly( const es_format_t *fmt )
+{
+    if( fmt->i_cat != VIDEO_ES )
+        return true;
+
+    switch( fmt->i_codec )
+    {
+        case VLC_CODEC_MJPG:
+        case VLC_CODEC_MJPGB:
+        case VLC_CODEC_JPEG:
+        case VLC_CODEC_JPEGLS:
+        case VLC_CODEC_JPEG2000:
+        case VLC_CODEC_PNG:
+        case VLC_CODEC_DV:
+        case VLC_CODEC_DNXHD:
+        case VLC_CODEC_PRORES:
+        case VLC_CODEC_HUFFYUV:
+        case VLC_CODEC_FFVHUFF:
+        case VLC_CODEC_CINEFORM:
+        case VLC_CODEC_V210:
+            return true;
+        default: /* raw video */
+            return vlc_fourcc_GetChromaDescription( fmt->i_codec ) != NULL;
+    }
+}
+
 /**
  * Create a decoder object
  *
@@ -1695,6 +1749,16 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
 
     es_format_Init( &p_owner->fmt, fmt->i_cat, 0 );
 
+    /* In low latency mode, only a short delay may wait for the decoder */
+    p_owner->i_fifo_delay = 0;
+    p_owner->b_fifo_resync = false;
+    p_owner->b_fifo_intra = DecoderIsIntraOnly( fmt );
+    p_owner->b_fifo_keyframes = false;
+    if( ( fmt->i_cat == VIDEO_ES || fmt->i_cat == AUDIO_ES )
+     && p_sout == NULL && var_InheritBool( p_dec, "low-latency" ) )
+        p_owner->i_fifo_delay = INT64_C(1000)
+                              * var_InheritInteger( p_dec, "low-latency-delay" );
+
     /* decoder fifo */
     p_owner->p_fifo = block_FifoNew();
     if( unlikely(p_owner->p_fifo == NULL) )
@@ -2012,6 +2076,102 @@ void input_DecoderDelete( decoder_t *p_dec )
     DeleteDecoder( p_dec );
 }
 
+static mtime_t BlockTime( const block_t *p_block )
+{
+    return p_block->i_dts > VLC_TS_INVALID ? p_block->i_dts : p_block->i_pts;
+}
+
+/* The blocks come from the demuxer: the key frames are flagged, if any, but
+ * not the other frames */
+static bool BlockIsRandomAccess( decoder_owner_sys_t *p_owner,
+                                 const block_t *p_block )
+{
+    if( p_block->i_flags & BLOCK_FLAG_TYPE_I )
+        return true;
+    return p_owner->b_fifo_intra
+        && !(p_block->i_flags & (BLOCK_FLAG_TYPE_P|BLOCK_FLAG_TYPE_B
+                                 |BLOCK_FLAG_TYPE_PB));
+}
+
+/**
+ * Drops the queued blocks older than the low latency delay, and the
+ * following ones up to the next random access point, so that decoding
+ * resumes close to the live edge on a decodable block.
+ * The fifo must be locked.
+ *
+ * \return whether the incoming block must be dropped as well
+ */
+static bool DecoderTrimFifo( decoder_t *p_dec, block_t *p_block )
+{
+    decoder_owner_sys_t *p_owner = p_dec->p_owner;
+
+    if( p_block->i_flags & BLOCK_FLAG_TYPE_I )
+        p_owner->b_fifo_keyframes = true;
+
+    /* If the demuxer does not flag the key frames, the decoding could not
+     * resume cleanly after a trim: keep all the data */
+    if( !p_owner->b_fifo_intra && !p_owner->b_fifo_keyframes )
+        return false;
+
+    if( p_owner->b_fifo_resync )
+    {
+        if( !BlockIsRandomAccess( p_owner, p_block ) )
+            return true;
+        p_owner->b_fifo_resync = false;
+        p_block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        return false;
+    }
+
+    const mtime_t i_live = BlockTime( p_block );
+    if( i_live <= VLC_TS_INVALID || vlc_fifo_IsEmpty( p_owner->p_fifo ) )
+        return false;
+
+    /* Blocks without timestamp go with the previous ones */
+    block_t *p_chain = vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo );
+    bool b_late = false;
+
+    for( const block_t *p = p_chain; p != NULL; p = p->p_next )
+        if( BlockTime( p ) > VLC_TS_INVALID )
+        {
+            b_late = i_live - BlockTime( p ) > p_owner->i_fifo_delay;
+            break;
+        }
+
+    if( !b_late )
+    {
+        vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_chain );
+        return false;
+    }
+
+    size_t i_dropped = 0;
+    while( p_chain != NULL )
+    {
+        const mtime_t i_ts = BlockTime( p_chain );
+        if( i_ts > VLC_TS_INVALID )
+            b_late = i_live - i_ts > p_owner->i_fifo_delay;
+        if( !b_late && BlockIsRandomAccess( p_owner, p_chain ) )
+            break;
+
+        block_t *p_next = p_chain->p_next;
+        block_Release( p_chain );
+        p_chain = p_next;
+        i_dropped++;
+    }
+
+    msg_Warn( p_dec, "low latency: dropping %zu late blocks", i_dropped );
+
+    if( p_chain != NULL )
+    {
+        p_chain->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_chain );
+        return false;
+    }
+
+    /* Nothing decodable left: wait for the next random access point */
+    p_owner->b_fifo_resync = true;
+    return DecoderTrimFifo( p_dec, p_block );
+}
+
 /**
  * Put a block_t in the decoder's fifo.
  * Thread-safe w.r.t. the decoder. May be a cancellation point.
@@ -2036,6 +2196,15 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
             block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
             p_block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
+        else
+        if( p_owner->i_fifo_delay > 0 && !p_owner->b_waiting
+         && DecoderTrimFifo( p_dec, p_block ) )
+        {
+            /* Catch up with the live edge rather than lagging behind */
+            vlc_fifo_Unlock( p_owner->p_fifo );
+            block_Release( p_block );
+            return;
+        }
     }
     else
     if( !p_owner->b_waiting )
@@ -2046,6 +2215,8 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
     }
 
+    vlc_tracer_Mark( libvlc_tracer( p_dec ), VLC_TRACER_DECODER_IN,
+                     DecoderTraceTs( p_block ) );
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
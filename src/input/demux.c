@@ -489,6 +489,7 @@ int demux_vaControlHelper( stream_t *s,
         case DEMUX_NAV_MENU:
         case DEMUX_FILTER_ENABLE:
         case DEMUX_FILTER_DISABLE:
+        case DEMUX_GET_TS_STATS:
             return VLC_EGENERIC;
 
         case DEMUX_SET_TITLE:
@@ -156,6 +156,8 @@ struct es_out_sys_t
     mtime_t     i_pts_jitter;
     int         i_cr_average;
     int         i_rate;
+    bool        b_clock_pll;
+    bool        b_low_latency;
 
     /* */
     bool        b_paused;
@@ -328,6 +330,8 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, int i_rate )
     p_sys->i_pause_date = -1;
 
     p_sys->i_rate = i_rate;
+    p_sys->b_clock_pll = var_InheritBool( p_input, "clock-pll" );
+    p_sys->b_low_latency = var_InheritBool( p_input, "low-latency" );
 
     p_sys->b_buffering = true;
     p_sys->i_preroll_end = -1;
@@ -1091,7 +1095,7 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, int i_group )
     p_pgrm->b_selected = false;
     p_pgrm->b_scrambled = false;
     p_pgrm->p_meta = NULL;
-    p_pgrm->p_clock = input_clock_New( p_sys->i_rate );
+    p_pgrm->p_clock = input_clock_New( p_sys->i_rate, p_sys->b_clock_pll );
     if( !p_pgrm->p_clock )
     {
         free( p_pgrm );
@@ -2286,6 +2290,17 @@ static int EsOutControlLocked( es_out_t *out, int i_query, va_list args )
         return VLC_SUCCESS;
     }
 
+    case ES_OUT_GET_CLOCK_STATS:
+    {
+        mtime_t *pi_jitter = va_arg( args, mtime_t * );
+        double *pf_drift = va_arg( args, double * );
+
+        if( !p_sys->p_pgrm )
+            return VLC_EGENERIC;
+        input_clock_GetDriftStats( p_sys->p_pgrm->p_clock, pi_jitter, pf_drift );
+        return VLC_SUCCESS;
+    }
+
     case ES_OUT_SET_MODE:
     {
         const int i_mode = va_arg( args, int );
@@ -2513,8 +2528,11 @@ static int EsOutControlLocked( es_out_t *out, int i_query, va_list args )
 
                 /* Avoid dangerously high value */
                 const mtime_t i_jitter_max = INT64_C(1000) * var_InheritInteger( p_sys->p_input, "clock-jitter" );
-                if( i_pts_delay > __MIN( i_pts_delay_base + i_jitter_max, INPUT_PTS_DELAY_MAX ) )
+                if( p_sys->b_low_latency
+                 || i_pts_delay > __MIN( i_pts_delay_base + i_jitter_max, INPUT_PTS_DELAY_MAX ) )
                 {
+                    /* In low latency mode, never trade latency for
+                     * smoothness: resynchronize on the live edge instead */
                     msg_Err( p_sys->p_input,
                              "ES_OUT_SET_(GROUP_)PCR  is called too late (jitter of %d ms ignored)",
                              (int)(i_pts_delay - i_pts_delay_base) / 1000 );
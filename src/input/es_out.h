@@ -86,6 +86,9 @@ enum es_out_query_private_e
     /* Get forced group */
     ES_OUT_GET_GROUP_FORCED,                        /* arg1=int * res=cannot fail */
 
+    /* Get the clock statistics of the selected program */
+    ES_OUT_GET_CLOCK_STATS,                         /* arg1=mtime_t *i_jitter arg2=double *f_drift res=can fail */
+
     /* Set End Of Stream */
     ES_OUT_SET_EOS,                                 /* res=cannot fail */
 };
@@ -43,6 +43,7 @@
 #include "item.h"
 #include "resource.h"
 #include "stream.h"
+#include "../misc/tracer.h"
 
 #include <vlc_aout.h>
 #include <vlc_sout.h>
@@ -566,8 +567,16 @@ static void MainLoopDemux( input_thread_t *p_input, bool *pb_changed )
     if( input_priv(p_input)->i_stop > 0 && input_priv(p_input)->i_time >= input_priv(p_input)->i_stop )
         i_ret = VLC_DEMUXER_EOF;
     else
+    {
+        vlc_tracer_t *tracer = libvlc_tracer( p_input );
+        mtime_t trace_start = vlc_tracer_Begin( tracer );
+
         i_ret = demux_Demux( p_demux );
 
+        vlc_tracer_End( tracer, VLC_TRACER_DEMUX, trace_start,
+                        VLC_TS_INVALID );
+    }
+
     i_ret = i_ret > 0 ? VLC_DEMUXER_SUCCESS : ( i_ret < 0 ? VLC_DEMUXER_EGENERIC : VLC_DEMUXER_EOF);
 
     if( i_ret == VLC_DEMUXER_SUCCESS )
@@ -673,6 +682,8 @@ static void MainLoopStatistics( input_thread_t *p_input )
     vlc_mutex_unlock( &input_priv(p_input)->p_item->lock );
 
     stats_ComputeInputStats( p_input, input_priv(p_input)->p_item->p_stats );
+    stats_ComputeDemuxStats( p_input, input_priv(p_input)->master->p_demux,
+                             input_priv(p_input)->p_item->p_stats );
     input_SendEventStatistics( p_input );
 }
 
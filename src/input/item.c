@@ -488,6 +488,7 @@ void input_item_Release( input_item_t *p_item )
     free( p_item->psz_uri );
     if( p_item->p_stats != NULL )
     {
+        stats_ReinitInputStats( p_item->p_stats );
         vlc_mutex_destroy( &p_item->p_stats->lock );
         free( p_item->p_stats );
     }
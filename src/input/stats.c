@@ -25,8 +25,13 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
+#include <vlc_demux.h>
 #include "input/input_internal.h"
+#include "input/es_out.h"
+#include "stream_output/stream_output.h"
 
 /**
  * Create a statistics counter
@@ -85,6 +90,19 @@ void stats_ComputeInputStats(input_thread_t *input, input_stats_t *st)
     if (!libvlc_stats(input))
         return;
 
+    mtime_t i_clock_jitter = 0;
+    double f_clock_drift = 0.;
+    es_out_Control(priv->p_es_out_display, ES_OUT_GET_CLOCK_STATS,
+                   &i_clock_jitter, &f_clock_drift);
+
+    size_t i_queue_depth = 0, i_queue_max = 0;
+    uint64_t i_queue_dropped = 0;
+#ifdef ENABLE_SOUT
+    if (priv->p_sout != NULL)
+        sout_GetQueueStats(priv->p_sout, &i_queue_depth, &i_queue_max,
+                           &i_queue_dropped);
+#endif
+
     vlc_mutex_lock(&priv->counters.counters_lock);
     vlc_mutex_lock(&st->lock);
 
@@ -97,6 +115,10 @@ void stats_ComputeInputStats(input_thread_t *input, input_stats_t *st)
     st->i_demux_corrupted = stats_GetTotal(priv->counters.p_demux_corrupted);
     st->i_demux_discontinuity = stats_GetTotal(priv->counters.p_demux_discontinuity);
 
+    /* Clock */
+    st->i_clock_jitter = i_clock_jitter;
+    st->f_clock_drift = f_clock_drift;
+
     /* Decoders */
     st->i_decoded_video = stats_GetTotal(priv->counters.p_decoded_video);
     st->i_decoded_audio = stats_GetTotal(priv->counters.p_decoded_audio);
@@ -108,6 +130,9 @@ void stats_ComputeInputStats(input_thread_t *input, input_stats_t *st)
         st->i_sent_bytes = stats_GetTotal(priv->counters.p_sout_sent_bytes);
         st->f_send_bitrate = stats_GetRate(priv->counters.p_sout_send_bitrate);
     }
+    st->i_sout_queue_depth = i_queue_depth;
+    st->i_sout_queue_max = i_queue_max;
+    st->i_sout_queue_dropped = i_queue_dropped;
 
     /* Aout */
     st->i_played_abuffers = stats_GetTotal(priv->counters.p_played_abuffers);
@@ -121,19 +146,55 @@ void stats_ComputeInputStats(input_thread_t *input, input_stats_t *st)
     vlc_mutex_unlock(&priv->counters.counters_lock);
 }
 
+static void stats_TSDelete( demux_ts_stats_t *p_ts )
+{
+    if( p_ts != NULL )
+        free( p_ts->p_pids );
+    free( p_ts );
+}
+
+/**
+ * Copies the measurements of the demuxer, if it provides any. This must be
+ * called from the input thread.
+ */
+void stats_ComputeDemuxStats(input_thread_t *input, demux_t *demux,
+                             input_stats_t *st)
+{
+    if (!libvlc_stats(input))
+        return;
+
+    demux_ts_stats_t *ts = malloc(sizeof (*ts));
+    if (ts != NULL && demux_Control(demux, DEMUX_GET_TS_STATS, ts))
+    {
+        free(ts);
+        ts = NULL;
+    }
+
+    vlc_mutex_lock(&st->lock);
+    demux_ts_stats_t *old = st->p_ts;
+    st->p_ts = ts;
+    vlc_mutex_unlock(&st->lock);
+
+    stats_TSDelete(old);
+}
+
 void stats_ReinitInputStats( input_stats_t *p_stats )
 {
     vlc_mutex_lock( &p_stats->lock );
+    stats_TSDelete( p_stats->p_ts );
+    p_stats->p_ts = NULL;
     p_stats->i_read_packets = p_stats->i_read_bytes =
     p_stats->f_input_bitrate = p_stats->f_average_input_bitrate =
     p_stats->i_demux_read_packets = p_stats->i_demux_read_bytes =
     p_stats->f_demux_bitrate = p_stats->f_average_demux_bitrate =
     p_stats->i_demux_corrupted = p_stats->i_demux_discontinuity =
+    p_stats->i_clock_jitter = p_stats->f_clock_drift =
     p_stats->i_displayed_pictures = p_stats->i_lost_pictures =
     p_stats->i_played_abuffers = p_stats->i_lost_abuffers =
     p_stats->i_decoded_video = p_stats->i_decoded_audio =
-    p_stats->i_sent_bytes = p_stats->i_sent_packets = p_stats->f_send_bitrate
-     = 0;
+    p_stats->i_sent_bytes = p_stats->i_sent_packets = p_stats->f_send_bitrate =
+    p_stats->i_sout_queue_depth = p_stats->i_sout_queue_max =
+    p_stats->i_sout_queue_dropped = 0;
     vlc_mutex_unlock( &p_stats->lock );
 }
 
@@ -688,6 +688,9 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
     return s->pf_control(s, cmd, args);
 }
 
+/* Minimum size of the reads passed by reference */
+#define STREAM_BLOCK_SLICE_MIN 1024
+
 /**
  * Read data into a block.
  *
@@ -699,9 +702,47 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
  */
 block_t *vlc_stream_Block( stream_t *s, size_t size )
 {
+    stream_priv_t *priv = (stream_priv_t *)s;
+
     if( unlikely(size > SSIZE_MAX) )
         return NULL;
 
+    /* Block-based stream: pass the data by reference if possible. Small
+     * reads (e.g. packet headers) are copied: a reference costs an allocation
+     * and two atomic operations, which is more than copying a few hundred
+     * bytes. Demuxers of small packets should read several at once, and
+     * slice them (see the TS demuxer). */
+    if( s->pf_block != NULL && priv->peek == NULL
+     && size >= STREAM_BLOCK_SLICE_MIN )
+    {
+        if( priv->block == NULL && !vlc_killed() )
+        {
+            bool eof = false;
+
+            priv->block = s->pf_block( s, &eof );
+            if( priv->block == NULL && eof )
+            {
+                priv->eof = true;
+                return NULL;
+            }
+        }
+
+        if( priv->block != NULL && priv->block->i_buffer >= size )
+        {
+            block_t *block = block_Slice( &priv->block, size );
+            if( likely(block != NULL) )
+            {
+                /* Same properties as a freshly read block */
+                block->i_flags = 0;
+                block->i_nb_samples = 0;
+                block->i_pts = block->i_dts = VLC_TS_INVALID;
+                block->i_length = 0;
+                priv->offset += size;
+                return block;
+            }
+        }
+    }
+
     block_t *block = block_Alloc( size );
     if( unlikely(block == NULL) )
         return NULL;
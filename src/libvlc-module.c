@@ -514,6 +514,13 @@ static const char *const ppsz_pos_descriptions[] =
 #define NETWORK_CACHING_LONGTEXT N_( \
     "Caching value for network resources, in milliseconds." )
 
+#define BLOCK_PASSTHROUGH_TEXT N_("Zero-copy block input")
+#define BLOCK_PASSTHROUGH_LONGTEXT N_( \
+    "Pass the data of block-based inputs (UDP, RTP, SRT...) to the " \
+    "demuxer by reference instead of copying it through the stream cache. " \
+    "Backward seeking within live streams is then limited to the data " \
+    "already probed by the demuxer." )
+
 #define CR_AVERAGE_TEXT N_("Clock reference average counter")
 #define CR_AVERAGE_LONGTEXT N_( \
     "When using the PVR input (or a very irregular source), you should " \
@@ -525,6 +532,26 @@ static const char *const ppsz_pos_descriptions[] =
     "real-time sources. Use this if you experience jerky playback of " \
     "network streams.")
 
+#define CLOCK_PLL_TEXT N_("Clock recovery with a PLL")
+#define CLOCK_PLL_LONGTEXT N_( \
+    "When the pace of the input cannot be controlled (live streams), " \
+    "track the rate of the source clock with a phase-locked loop instead " \
+    "of averaging its offset. This follows long term clock drift without " \
+    "lagging behind, and separates it from the reception jitter." )
+
+#define LOW_LATENCY_TEXT N_("Low latency live mode")
+#define LOW_LATENCY_LONGTEXT N_( \
+    "Keep the latency of live streams bounded: the decoder queues are " \
+    "limited to a short delay, and late data is dropped instead of " \
+    "increasing the input delay. Use together with a low caching value.")
+
+#define LOW_LATENCY_DELAY_TEXT N_("Low latency queue delay (ms)")
+#define LOW_LATENCY_DELAY_LONGTEXT N_( \
+    "Maximum duration of the data waiting in front of each audio and " \
+    "video decoder in low latency mode, measured with the timestamps. " \
+    "Older data is dropped up to the next key frame when this limit is " \
+    "exceeded.")
+
 #define CLOCK_JITTER_TEXT N_("Clock jitter")
 #define CLOCK_JITTER_LONGTEXT N_( \
     "This defines the maximum input delay jitter that the synchronization " \
@@ -710,6 +737,12 @@ static const char *const ppsz_prefres[] = {
 #define SUB_TEXT_SCALE_TEXT N_("Subtitles text scaling factor")
 #define SUB_TEXT_SCALE_LONGTEXT N_("Changes the subtitles size where possible")
 
+#define SUB_PRERENDER_TEXT N_("Render subtitles ahead of time")
+#define SUB_PRERENDER_LONGTEXT N_( \
+    "Lay out and rasterize the text of the subtitles in a separate thread " \
+    "as soon as they are decoded, instead of when they are first " \
+    "displayed. This avoids delaying the video on complex subtitles.")
+
 #define SPU_TEXT N_("Enable sub-pictures")
 #define SPU_LONGTEXT N_( \
     "You can completely disable the sub-picture processing.")
@@ -966,6 +999,26 @@ static const char *const ppsz_prefres[] = {
     "This allow you to configure the initial caching amount for stream output " \
     "muxer. This value should be set in milliseconds." )
 
+#define SOUT_ACCESS_ASYNC_TEXT N_("Asynchronous access output")
+#define SOUT_ACCESS_ASYNC_LONGTEXT N_( \
+    "Write the output data from a dedicated thread, so that a slow " \
+    "destination does not stall the stream output." )
+
+#define SOUT_ACCESS_POLICY_TEXT N_("Asynchronous access output policy")
+#define SOUT_ACCESS_POLICY_LONGTEXT N_( \
+    "What to do when the queue of an asynchronous access output is full: " \
+    "wait for the destination, drop the new data, or close the destination." )
+
+#define SOUT_ACCESS_QUEUE_TEXT N_("Asynchronous access output queue (kB)")
+#define SOUT_ACCESS_QUEUE_LONGTEXT N_( \
+    "Maximum amount of data waiting to be written by an asynchronous " \
+    "access output." )
+
+static const char *const ppsz_sout_access_policies[] = {
+    "block", "drop", "disconnect" };
+static const char *const ppsz_sout_access_policies_text[] = {
+    N_("Block"), N_("Drop"), N_("Disconnect") };
+
 #define PACKETIZER_TEXT N_("Preferred packetizer list")
 #define PACKETIZER_LONGTEXT N_( \
     "This allows you to select the order in which VLC will choose its " \
@@ -1063,6 +1116,14 @@ static const char *const ppsz_prefres[] = {
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
 
+#define TRACE_FILE_TEXT N_("Latency trace file")
+#define TRACE_FILE_LONGTEXT N_( \
+     "Record the time spent by blocks and pictures in the access, demux, " \
+     "decoder, video output, encoder and stream output stages, and write " \
+     "it to this file in the Chrome trace event format when VLC exits. " \
+     "Per-stage histograms of the call durations and of the latencies " \
+     "between the successive stages of a frame are printed in the log.")
+
 #define DAEMON_TEXT N_("Run as daemon process")
 #define DAEMON_LONGTEXT N_( \
      "Runs VLC as a background daemon process.")
@@ -1123,6 +1184,15 @@ static const char *const ppsz_prefres[] = {
 #define PREPARSE_TIMEOUT_LONGTEXT N_( \
     "Maximum time allowed to preparse an item, in milliseconds" )
 
+#define PREPARSE_THREADS_TEXT N_( "Preparsing threads" )
+#define PREPARSE_THREADS_LONGTEXT N_( \
+    "Maximum number of items preparsed concurrently" )
+
+#define PREPARSE_CACHE_TEXT N_( "Cache the preparsed metadata" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Keep the metadata of the preparsed local files in the user cache " \
+    "directory, and reuse it as long as the files are not modified." )
+
 #define METADATA_NETWORK_TEXT N_( "Allow metadata network access" )
 
 static const char *const psz_recursive_list[] = {
@@ -1700,6 +1770,8 @@ vlc_module_begin ()
     add_integer_with_range( "sub-text-scale", 100, 10, 500,
                SUB_TEXT_SCALE_TEXT, SUB_TEXT_SCALE_LONGTEXT, false )
         change_volatile  ()
+    add_bool( "sub-prerender", false, SUB_PRERENDER_TEXT,
+              SUB_PRERENDER_LONGTEXT, true )
     set_section( N_( "Overlays" ) , NULL )
     add_module_list( "sub-source", "sub source", NULL,
                      SUB_SOURCE_TEXT, SUB_SOURCE_LONGTEXT, false )
@@ -1906,6 +1978,9 @@ vlc_module_begin ()
     add_obsolete_integer( "tcp-caching" ) /* 2.0.0 */
     add_obsolete_integer( "udp-caching" ) /* 2.0.0 */
 
+    add_bool( "input-block-passthrough", false, BLOCK_PASSTHROUGH_TEXT,
+              BLOCK_PASSTHROUGH_LONGTEXT, true )
+
     add_integer( "cr-average", 40, CR_AVERAGE_TEXT,
                  CR_AVERAGE_LONGTEXT, true )
     add_integer( "clock-synchro", -1, CLOCK_SYNCHRO_TEXT,
@@ -1914,6 +1989,15 @@ vlc_module_begin ()
     add_integer( "clock-jitter", 5 * CLOCK_FREQ/1000, CLOCK_JITTER_TEXT,
               CLOCK_JITTER_LONGTEXT, true )
         change_safe()
+    add_bool( "clock-pll", false, CLOCK_PLL_TEXT, CLOCK_PLL_LONGTEXT, true )
+        change_safe()
+    add_bool( "low-latency", false, LOW_LATENCY_TEXT,
+              LOW_LATENCY_LONGTEXT, true )
+        change_safe()
+    add_integer_with_range( "low-latency-delay", 200, 10, 10000,
+                            LOW_LATENCY_DELAY_TEXT,
+                            LOW_LATENCY_DELAY_LONGTEXT, true )
+        change_safe()
 
     add_bool( "network-synchronisation", false, NETSYNC_TEXT,
               NETSYNC_LONGTEXT, true )
@@ -1992,6 +2076,15 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_SOUT_ACO )
     add_module( "access_output", "sout access", NULL,
                 ACCESS_OUTPUT_TEXT, ACCESS_OUTPUT_LONGTEXT, true )
+    add_bool( "sout-access-async", false, SOUT_ACCESS_ASYNC_TEXT,
+              SOUT_ACCESS_ASYNC_LONGTEXT, true )
+    add_string( "sout-access-policy", "block", SOUT_ACCESS_POLICY_TEXT,
+                SOUT_ACCESS_POLICY_LONGTEXT, true )
+        change_string_list( ppsz_sout_access_policies,
+                            ppsz_sout_access_policies_text )
+    add_integer( "sout-access-queue-size", 4096, SOUT_ACCESS_QUEUE_TEXT,
+                 SOUT_ACCESS_QUEUE_LONGTEXT, true )
+        change_integer_range( 1, 1024 * 1024 )
     add_integer( "ttl", -1, TTL_TEXT, TTL_LONGTEXT, true )
     add_string( "miface", NULL, MIFACE_TEXT, MIFACE_LONGTEXT, true )
     add_obsolete_string( "miface-addr" ) /* since 2.0.0 */
@@ -2111,6 +2204,11 @@ vlc_module_begin ()
 
     add_integer( "preparse-timeout", 5000, PREPARSE_TIMEOUT_TEXT,
                  PREPARSE_TIMEOUT_LONGTEXT, false )
+    add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
+                 PREPARSE_THREADS_LONGTEXT, true )
+        change_integer_range( 1, 32 )
+    add_bool( "preparse-cache", true, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT, true )
 
     add_obsolete_integer( "album-art" )
     add_bool( "metadata-network-access", false, METADATA_NETWORK_TEXT,
@@ -2161,6 +2259,8 @@ vlc_module_begin ()
               INTERACTION_LONGTEXT, false )
 
     add_bool ( "stats", true, STATS_TEXT, STATS_LONGTEXT, true )
+    add_savefile( "trace-file", NULL, TRACE_FILE_TEXT, TRACE_FILE_LONGTEXT,
+                  true )
 
     set_subcategory( SUBCAT_INTERFACE_MAIN )
     add_module_cat( "intf", SUBCAT_INTERFACE_MAIN, NULL, INTF_TEXT,
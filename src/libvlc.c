@@ -66,6 +66,7 @@
 #include "libvlc.h"
 #include "playlist/playlist_internal.h"
 #include "misc/variables.h"
+#include "misc/tracer.h"
 
 #include <vlc_vlm.h>
 
@@ -230,6 +231,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
 
     priv->b_stats = var_InheritBool( p_libvlc, "stats" );
+    priv->tracer = vlc_tracer_Create( VLC_OBJECT(p_libvlc) );
 
     /*
      * Initialize hotkey handling
@@ -418,6 +420,9 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalActionsClean( p_libvlc );
 
+    if( priv->tracer != NULL )
+        vlc_tracer_Destroy( priv->tracer );
+
     /* Save the configuration */
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
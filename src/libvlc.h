@@ -189,6 +189,7 @@ typedef struct libvlc_priv_t
     struct playlist_t *playlist; ///< Playlist for interfaces
     struct playlist_preparser_t *parser; ///< Input item meta data handler
     vlc_actions_t *actions; ///< Hotkeys handler
+    struct vlc_tracer *tracer; ///< Latency tracer (or NULL)
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -262,6 +263,7 @@ void stats_Update (counter_t *, uint64_t, uint64_t *);
 void stats_CounterClean (counter_t * );
 
 void stats_ComputeInputStats(input_thread_t*, input_stats_t*);
+void stats_ComputeDemuxStats(input_thread_t*, demux_t*, input_stats_t*);
 void stats_ReinitInputStats(input_stats_t *);
 
 #endif
@@ -34,18 +34,25 @@ struct bg_queued_item {
     int timeout; /**< timeout duration in microseconds */
 };
 
+struct bg_thread {
+    struct background_worker* worker;
+
+    bool probe_request; /**< true if a probe is requested */
+    vlc_cond_t worker_wait; /**< wait for probe request or cancelation */
+    mtime_t deadline; /**< deadline of the current task */
+    void* id; /**< id of the current task */
+    bool active; /**< true if the thread is running */
+};
+
 struct background_worker {
     void* owner;
     struct background_worker_config conf;
 
     vlc_mutex_t lock; /**< acquire to inspect members that follow */
     struct {
-        bool probe_request; /**< true if a probe is requested */
         vlc_cond_t wait; /**< wait for update in terms of head */
-        vlc_cond_t worker_wait; /**< wait for probe request or cancelation */
-        mtime_t deadline; /**< deadline of the current task */
-        void* id; /**< id of the current task */
-        bool active; /**< true if there is an active thread */
+        struct bg_thread* threads; /**< conf.max_threads slots */
+        unsigned idle; /**< number of threads waiting for entities */
     } head;
 
     struct {
@@ -56,7 +63,8 @@ struct background_worker {
 
 static void* Thread( void* data )
 {
-    struct background_worker* worker = data;
+    struct bg_thread* th = data;
+    struct background_worker* worker = th->worker;
 
     for( ;; )
     {
@@ -74,36 +82,38 @@ static void* Thread( void* data )
                 vlc_array_remove( &worker->tail.data, 0 );
             }
 
-            if( worker->head.deadline == VLC_TS_0 && item == NULL )
-                worker->head.active = false;
-            worker->head.id = item ? item->id : NULL;
+            if( th->deadline == VLC_TS_0 && item == NULL )
+                th->active = false;
+            th->id = item ? item->id : NULL;
             vlc_cond_broadcast( &worker->head.wait );
 
             if( item )
             {
                 if( item->timeout > 0 )
-                    worker->head.deadline = mdate() + item->timeout * 1000;
+                    th->deadline = mdate() + item->timeout * 1000;
                 else
-                    worker->head.deadline = INT64_MAX;
+                    th->deadline = INT64_MAX;
             }
-            else if( worker->head.deadline != VLC_TS_0 )
+            else if( th->deadline != VLC_TS_0 )
             {
                 /* Wait 1 seconds for new inputs before terminating */
                 mtime_t deadline = mdate() + INT64_C(1000000);
+                worker->head.idle++;
                 int ret = vlc_cond_timedwait( &worker->tail.wait,
                                               &worker->lock, deadline );
+                worker->head.idle--;
                 if( ret != 0 )
                 {
                     /* Timeout: if there is still no items, the thread will be
                      * terminated at next loop iteration (active = false). */
-                    worker->head.deadline = VLC_TS_0;
+                    th->deadline = VLC_TS_0;
                 }
                 continue;
             }
             break;
         }
 
-        if( !worker->head.active )
+        if( !th->active )
         {
             vlc_mutex_unlock( &worker->lock );
             break;
@@ -123,8 +133,8 @@ static void* Thread( void* data )
         {
             vlc_mutex_lock( &worker->lock );
 
-            bool const b_timeout = worker->head.deadline <= mdate();
-            worker->head.probe_request = false;
+            bool const b_timeout = th->deadline <= mdate();
+            th->probe_request = false;
 
             vlc_mutex_unlock( &worker->lock );
 
@@ -138,11 +148,11 @@ static void* Thread( void* data )
             }
 
             vlc_mutex_lock( &worker->lock );
-            if( worker->head.probe_request == false &&
-                worker->head.deadline > mdate() )
+            if( th->probe_request == false &&
+                th->deadline > mdate() )
             {
-                vlc_cond_timedwait( &worker->head.worker_wait, &worker->lock,
-                                     worker->head.deadline );
+                vlc_cond_timedwait( &th->worker_wait, &worker->lock,
+                                     th->deadline );
             }
             vlc_mutex_unlock( &worker->lock );
         }
@@ -151,6 +161,19 @@ static void* Thread( void* data )
     return NULL;
 }
 
+static bool BackgroundWorkerIsRunning( struct background_worker* worker,
+                                       void* id )
+{
+    for( int i = 0; i < worker->conf.max_threads; ++i )
+    {
+        struct bg_thread* th = &worker->head.threads[i];
+
+        if( ( id == NULL && th->active ) || ( id != NULL && th->id == id ) )
+            return true;
+    }
+    return false;
+}
+
 static void BackgroundWorkerCancel( struct background_worker* worker, void* id)
 {
     vlc_mutex_lock( &worker->lock );
@@ -170,12 +193,19 @@ static void BackgroundWorkerCancel( struct background_worker* worker, void* id)
         ++i;
     }
 
-    while( ( id == NULL && worker->head.active )
-        || ( id != NULL && worker->head.id == id ) )
+    while( BackgroundWorkerIsRunning( worker, id ) )
     {
-        worker->head.deadline = VLC_TS_0;
-        vlc_cond_signal( &worker->head.worker_wait );
-        vlc_cond_signal( &worker->tail.wait );
+        for( int i = 0; i < worker->conf.max_threads; ++i )
+        {
+            struct bg_thread* th = &worker->head.threads[i];
+
+            if( ( id == NULL && th->active ) || ( id != NULL && th->id == id ) )
+            {
+                th->deadline = VLC_TS_0;
+                vlc_cond_signal( &th->worker_wait );
+            }
+        }
+        vlc_cond_broadcast( &worker->tail.wait );
         vlc_cond_wait( &worker->head.wait, &worker->lock );
     }
     vlc_mutex_unlock( &worker->lock );
@@ -190,14 +220,31 @@ struct background_worker* background_worker_New( void* owner,
         return NULL;
 
     worker->conf = *conf;
+    if( worker->conf.max_threads < 1 )
+        worker->conf.max_threads = 1;
     worker->owner = owner;
-    worker->head.id = NULL;
-    worker->head.active = false;
-    worker->head.deadline = VLC_TS_INVALID;
+    worker->head.idle = 0;
+    worker->head.threads = malloc( worker->conf.max_threads
+                                   * sizeof( *worker->head.threads ) );
+    if( unlikely( !worker->head.threads ) )
+    {
+        free( worker );
+        return NULL;
+    }
+
+    for( int i = 0; i < worker->conf.max_threads; ++i )
+    {
+        struct bg_thread* th = &worker->head.threads[i];
+
+        th->worker = worker;
+        th->id = NULL;
+        th->active = false;
+        th->deadline = VLC_TS_INVALID;
+        vlc_cond_init( &th->worker_wait );
+    }
 
     vlc_mutex_init( &worker->lock );
     vlc_cond_init( &worker->head.wait );
-    vlc_cond_init( &worker->head.worker_wait );
 
     vlc_array_init( &worker->tail.data );
     vlc_cond_init( &worker->tail.wait );
@@ -205,6 +252,37 @@ struct background_worker* background_worker_New( void* owner,
     return worker;
 }
 
+/* Starts a new thread if all the running ones are busy, must be called with
+ * the lock held. Returns true if at least one thread is running. */
+static bool BackgroundWorkerSpawn( struct background_worker* worker )
+{
+    struct bg_thread* slot = NULL;
+    bool running = false;
+
+    for( int i = 0; i < worker->conf.max_threads; ++i )
+    {
+        struct bg_thread* th = &worker->head.threads[i];
+
+        if( th->active )
+            running = true;
+        else if( slot == NULL )
+            slot = th;
+    }
+
+    if( slot != NULL &&
+        vlc_array_count( &worker->tail.data ) > worker->head.idle )
+    {
+        slot->probe_request = false;
+        slot->deadline = VLC_TS_INVALID;
+        slot->id = NULL;
+        slot->active =
+            !vlc_clone_detach( NULL, Thread, slot, VLC_THREAD_PRIORITY_LOW );
+        running |= slot->active;
+    }
+
+    return running;
+}
+
 int background_worker_Push( struct background_worker* worker, void* entity,
                         void* id, int timeout )
 {
@@ -222,24 +300,24 @@ int background_worker_Push( struct background_worker* worker, void* entity,
     vlc_cond_signal( &worker->tail.wait );
     if( i_ret != 0 )
     {
+        vlc_mutex_unlock( &worker->lock );
         free( item );
         return VLC_EGENERIC;
     }
 
-    if( worker->head.active == false )
+    if( !BackgroundWorkerSpawn( worker ) )
     {
-        worker->head.probe_request = false;
-        worker->head.active =
-            !vlc_clone_detach( NULL, Thread, worker, VLC_THREAD_PRIORITY_LOW );
+        vlc_array_remove( &worker->tail.data,
+                          vlc_array_count( &worker->tail.data ) - 1 );
+        vlc_mutex_unlock( &worker->lock );
+        free( item );
+        return VLC_EGENERIC;
     }
 
-    if( worker->head.active )
-        worker->conf.pf_hold( item->entity );
-
-    int ret = worker->head.active ? VLC_SUCCESS : VLC_EGENERIC;
+    worker->conf.pf_hold( item->entity );
     vlc_mutex_unlock( &worker->lock );
 
-    return ret;
+    return VLC_SUCCESS;
 }
 
 void background_worker_Cancel( struct background_worker* worker, void* id )
@@ -250,8 +328,14 @@ void background_worker_Cancel( struct background_worker* worker, void* id )
 void background_worker_RequestProbe( struct background_worker* worker )
 {
     vlc_mutex_lock( &worker->lock );
-    worker->head.probe_request = true;
-    vlc_cond_signal( &worker->head.worker_wait );
+    /* The caller does not know which thread runs the task: wake them all */
+    for( int i = 0; i < worker->conf.max_threads; ++i )
+    {
+        struct bg_thread* th = &worker->head.threads[i];
+
+        th->probe_request = true;
+        vlc_cond_signal( &th->worker_wait );
+    }
     vlc_mutex_unlock( &worker->lock );
 }
 
@@ -261,7 +345,9 @@ void background_worker_Delete( struct background_worker* worker )
     vlc_array_clear( &worker->tail.data );
     vlc_mutex_destroy( &worker->lock );
     vlc_cond_destroy( &worker->head.wait );
-    vlc_cond_destroy( &worker->head.worker_wait );
+    for( int i = 0; i < worker->conf.max_threads; ++i )
+        vlc_cond_destroy( &worker->head.threads[i].worker_wait );
     vlc_cond_destroy( &worker->tail.wait );
+    free( worker->head.threads );
     free( worker );
 }
@@ -29,6 +29,15 @@ struct background_worker_config {
      **/
     mtime_t default_timeout;
 
+    /**
+     * Maximum number of threads
+     *
+     * Up to that many entities are processed concurrently. Threads are only
+     * created when all the running ones are busy, and terminate after having
+     * been idle for a while. Values less than 1 are treated as 1.
+     **/
+    int max_threads;
+
     /**
      * Release an entity
      *
@@ -33,6 +33,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
 #include <vlc_fs.h>
 
 #ifndef NDEBUG
@@ -343,6 +344,147 @@ block_t *block_shm_Alloc (void *addr, size_t length)
 }
 #endif
 
+typedef struct
+{
+    block_t *block; /* underlying storage */
+    atomic_uint refs;
+} block_shared_t;
+
+typedef struct
+{
+    block_t self;
+    block_shared_t *shared;
+} block_slice_t;
+
+static void block_slice_Release (block_t *block)
+{
+    block_slice_t *slice = (block_slice_t *)block;
+    block_shared_t *shared = slice->shared;
+
+    block_Invalidate (block);
+    free (slice);
+
+    if (atomic_fetch_sub (&shared->refs, 1) == 1)
+    {
+        block_Release (shared->block);
+        free (shared);
+    }
+}
+
+static block_t *block_slice_New (block_shared_t *shared,
+                                 uint8_t *buf, size_t length)
+{
+    block_slice_t *slice = malloc (sizeof (*slice));
+    if (unlikely(slice == NULL))
+        return NULL;
+
+    /* The slice cannot grow beyond its own data, so that its siblings
+     * are never overwritten: block_Realloc() will copy as needed. */
+    block_Init (&slice->self, buf, length);
+    slice->self.pf_release = block_slice_Release;
+    slice->shared = shared;
+    atomic_fetch_add (&shared->refs, 1);
+    return &slice->self;
+}
+
+block_t *block_Slice (block_t **pp, size_t offset)
+{
+    block_t *block = *pp;
+
+    block_Check (block);
+    assert (offset <= block->i_buffer);
+
+    if (offset == block->i_buffer)
+    {   /* Nothing left behind: hand the whole block over */
+        *pp = NULL;
+        return block;
+    }
+
+    if (block->pf_release == block_slice_Release)
+    {   /* Already a slice: only the head is new, the tail advances in place */
+        block_t *head = block_slice_New (((block_slice_t *)block)->shared,
+                                         block->p_buffer, offset);
+        if (unlikely(head == NULL))
+            return NULL;
+
+        BlockMetaCopy (head, block);
+        head->p_next = NULL;
+
+        /* The tail must not grow back into the head */
+        block->p_buffer += offset;
+        block->i_buffer -= offset;
+        block->p_start = block->p_buffer;
+        block->i_size = block->i_buffer;
+        block->i_flags = 0;
+        block->i_nb_samples = 0;
+        block->i_pts = block->i_dts = VLC_TS_INVALID;
+        block->i_length = 0;
+        return head;
+    }
+
+    block_shared_t *shared = malloc (sizeof (*shared));
+    if (unlikely(shared == NULL))
+        return NULL;
+    shared->block = block;
+    atomic_init (&shared->refs, 0);
+
+    block_t *head = block_slice_New (shared, block->p_buffer, offset);
+    if (unlikely(head == NULL))
+    {
+        free (shared);
+        return NULL;
+    }
+
+    block_t *tail = block_slice_New (shared, block->p_buffer + offset,
+                                     block->i_buffer - offset);
+    if (unlikely(tail == NULL))
+    {
+        atomic_fetch_add (&shared->refs, 1); /* do not free the original */
+        block_Release (head);
+        free (shared);
+        return NULL;
+    }
+
+    BlockMetaCopy (head, block);
+    head->p_next = NULL;
+    *pp = tail;
+    return head;
+}
+
+block_t *block_Share (block_t **pp)
+{
+    block_t *block = *pp;
+
+    block_Check (block);
+    assert (block->p_next == NULL);
+
+    if (block->pf_release != block_slice_Release)
+    {   /* Turn the original block into a slice of itself */
+        block_shared_t *shared = malloc (sizeof (*shared));
+        if (unlikely(shared == NULL))
+            return NULL;
+        shared->block = block;
+        atomic_init (&shared->refs, 0);
+
+        block_t *self = block_slice_New (shared, block->p_buffer,
+                                         block->i_buffer);
+        if (unlikely(self == NULL))
+        {
+            free (shared);
+            return NULL;
+        }
+        BlockMetaCopy (self, block);
+        *pp = block = self;
+    }
+
+    block_t *copy = block_slice_New (((block_slice_t *)block)->shared,
+                                     block->p_buffer, block->i_buffer);
+    if (unlikely(copy == NULL))
+        return NULL;
+    BlockMetaCopy (copy, block);
+    return copy;
+}
+
 
 #ifdef _WIN32
 # include <io.h>
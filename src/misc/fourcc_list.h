@@ -1602,6 +1602,9 @@ static const staticentry_t p_list_spu[] = {
     B(VLC_CODEC_SCTE_27, "SCTE-27 subtitles"),
         A("SC27"),
 
+    B(VLC_CODEC_SCTE_35, "SCTE-35 splice information"),
+        A("SC35"),
+
     B(VLC_CODEC_CEA608,  "EIA-608 subtitles"),
 
     B(VLC_CODEC_TTML, "TTML subtitles"),
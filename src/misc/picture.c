@@ -133,6 +133,7 @@ void picture_Reset( picture_t *p_picture )
     p_picture->b_progressive = false;
     p_picture->i_nb_fields = 2;
     p_picture->b_top_field_first = false;
+    p_picture->b_force_keyframe = false;
     PictureDestroyContext( p_picture );
 }
 
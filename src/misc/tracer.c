@@ -0,0 +1,402 @@
+/*****************************************************************************
+ * tracer.c: per-frame latency tracing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_fs.h>
+
+#include "tracer.h"
+
+/* Number of events kept per thread, older ones are overwritten */
+#define TRACER_RING_SIZE 16384
+/* Histogram buckets: [0,1[ µs, then [2^(n-1), 2^n[ µs */
+#define TRACER_BUCKETS   32
+/* Hash tables of the frames and of the system dates aliases, colliding
+ * entries are overwritten */
+#define TRACER_HASH_BITS 12
+#define TRACER_HASH_SIZE (1 << TRACER_HASH_BITS)
+
+static const char *const stage_names[VLC_TRACER_STAGE_COUNT] = {
+    [VLC_TRACER_ACCESS_READ] = "access read",
+    [VLC_TRACER_DEMUX]       = "demux",
+    [VLC_TRACER_DECODER_IN]  = "decoder input",
+    [VLC_TRACER_DECODE]      = "decode",
+    [VLC_TRACER_FILTER]      = "video filter",
+    [VLC_TRACER_RENDER]      = "render",
+    [VLC_TRACER_DISPLAY]     = "display",
+    [VLC_TRACER_ENCODE]      = "encode",
+    [VLC_TRACER_MUX]         = "mux",
+    [VLC_TRACER_ACCESS_OUT]  = "access output",
+};
+
+struct vlc_tracer_event
+{
+    mtime_t  start;
+    mtime_t  ts;
+    uint32_t duration;
+    uint32_t thread;
+    uint8_t  stage;
+};
+
+/* Only ever written by its own thread. When the thread exits, the ring is
+ * kept (with its events) for the next thread that records events, so that
+ * the memory use is bounded by the number of threads alive at once. */
+struct vlc_tracer_ring
+{
+    struct vlc_tracer_ring *next;
+    vlc_tracer_t *tracer;
+    bool free;
+    unsigned index; /**< of the current thread */
+    uint64_t count;
+    uint64_t histogram[VLC_TRACER_STAGE_COUNT][TRACER_BUCKETS];
+    struct vlc_tracer_event events[TRACER_RING_SIZE];
+};
+
+struct vlc_tracer
+{
+    vlc_object_t    *obj;
+    char            *path;
+    mtime_t          origin;
+    vlc_threadvar_t  key;
+
+    vlc_mutex_t      lock; /**< protects the rings list */
+    struct vlc_tracer_ring *rings;
+    unsigned         ring_count;
+    /** duration histograms of the recycled rings */
+    uint64_t         histogram[VLC_TRACER_STAGE_COUNT][TRACER_BUCKETS];
+
+    vlc_mutex_t      frames_lock; /**< protects the tables below */
+    /** date of the last hop of each frame, by timestamp */
+    struct
+    {
+        mtime_t ts;
+        mtime_t date;
+    } frames[TRACER_HASH_SIZE];
+    /** timestamps of the system dates, by date */
+    struct
+    {
+        mtime_t date;
+        mtime_t ts;
+    } aliases[TRACER_HASH_SIZE];
+    /** latency histograms from the previous hop of the same frame */
+    uint64_t         latency[VLC_TRACER_STAGE_COUNT][TRACER_BUCKETS];
+};
+
+static void ReleaseRing(void *data)
+{
+    struct vlc_tracer_ring *ring = data;
+    vlc_tracer_t *tracer = ring->tracer;
+
+    vlc_mutex_lock(&tracer->lock);
+    ring->free = true;
+    vlc_mutex_unlock(&tracer->lock);
+}
+
+vlc_tracer_t *vlc_tracer_Create(vlc_object_t *libvlc)
+{
+    char *path = var_InheritString(libvlc, "trace-file");
+    if (path == NULL)
+        return NULL;
+
+    vlc_tracer_t *tracer = calloc(1, sizeof (*tracer));
+    if (unlikely(tracer == NULL))
+    {
+        free(path);
+        return NULL;
+    }
+
+    if (vlc_threadvar_create(&tracer->key, ReleaseRing))
+    {
+        free(tracer);
+        free(path);
+        return NULL;
+    }
+
+    tracer->obj = libvlc;
+    tracer->path = path;
+    tracer->origin = mdate();
+    vlc_mutex_init(&tracer->lock);
+    vlc_mutex_init(&tracer->frames_lock);
+    /* The rings, histograms and tables are zeroed: VLC_TS_INVALID is 0 */
+
+    msg_Dbg(libvlc, "tracing latencies to %s", path);
+    return tracer;
+}
+
+static struct vlc_tracer_ring *GetRing(vlc_tracer_t *tracer)
+{
+    struct vlc_tracer_ring *ring = vlc_threadvar_get(tracer->key);
+    if (likely(ring != NULL))
+        return ring;
+
+    vlc_mutex_lock(&tracer->lock);
+    for (ring = tracer->rings; ring != NULL; ring = ring->next)
+        if (ring->free)
+            break;
+
+    if (ring != NULL)
+    {   /* Recycle the ring of an exited thread, keeping its events */
+        for (unsigned i = 0; i < VLC_TRACER_STAGE_COUNT; i++)
+            for (unsigned j = 0; j < TRACER_BUCKETS; j++)
+                tracer->histogram[i][j] += ring->histogram[i][j];
+        memset(ring->histogram, 0, sizeof (ring->histogram));
+    }
+    else
+    {
+        ring = calloc(1, sizeof (*ring));
+        if (unlikely(ring == NULL))
+        {
+            vlc_mutex_unlock(&tracer->lock);
+            return NULL;
+        }
+        ring->tracer = tracer;
+        ring->next = tracer->rings;
+        tracer->rings = ring;
+    }
+    ring->free = false;
+    ring->index = ++tracer->ring_count;
+    vlc_mutex_unlock(&tracer->lock);
+
+    vlc_threadvar_set(tracer->key, ring);
+    return ring;
+}
+
+static unsigned GetBucket(mtime_t duration)
+{
+    unsigned bucket = 0;
+
+    while (duration > 0 && bucket < TRACER_BUCKETS - 1)
+    {
+        duration >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static size_t Hash(mtime_t value)
+{
+    return ((uint64_t)value * UINT64_C(0x9E3779B97F4A7C15))
+           >> (64 - TRACER_HASH_BITS);
+}
+
+#undef vlc_tracer_Get
+vlc_tracer_t *vlc_tracer_Get(vlc_object_t *obj)
+{
+    return libvlc_tracer(obj);
+}
+
+void vlc_tracer_Alias(vlc_tracer_t *tracer, mtime_t date, mtime_t ts)
+{
+    if (date <= VLC_TS_INVALID || ts <= VLC_TS_INVALID)
+        return;
+
+    size_t h = Hash(date);
+
+    vlc_mutex_lock(&tracer->frames_lock);
+    tracer->aliases[h].date = date;
+    tracer->aliases[h].ts = ts;
+    vlc_mutex_unlock(&tracer->frames_lock);
+}
+
+mtime_t vlc_tracer_Resolve(vlc_tracer_t *tracer, mtime_t date)
+{
+    mtime_t ts = VLC_TS_INVALID;
+
+    if (date <= VLC_TS_INVALID)
+        return ts;
+
+    size_t h = Hash(date);
+
+    vlc_mutex_lock(&tracer->frames_lock);
+    if (tracer->aliases[h].date == date)
+        ts = tracer->aliases[h].ts;
+    vlc_mutex_unlock(&tracer->frames_lock);
+    return ts;
+}
+
+/* Measures the latency from the previous hop of the frame, which starts
+ * anew when it is queued to a decoder */
+static void Hop(vlc_tracer_t *tracer, enum vlc_tracer_stage stage,
+                mtime_t end, mtime_t ts)
+{
+    size_t h = Hash(ts);
+
+    vlc_mutex_lock(&tracer->frames_lock);
+    if (stage != VLC_TRACER_DECODER_IN && tracer->frames[h].ts == ts
+     && end >= tracer->frames[h].date)
+        tracer->latency[stage][GetBucket(end - tracer->frames[h].date)]++;
+    tracer->frames[h].ts = ts;
+    tracer->frames[h].date = end;
+    vlc_mutex_unlock(&tracer->frames_lock);
+}
+
+void vlc_tracer_Record(vlc_tracer_t *tracer, enum vlc_tracer_stage stage,
+                       mtime_t start, mtime_t end, mtime_t ts)
+{
+    struct vlc_tracer_ring *ring = GetRing(tracer);
+    if (unlikely(ring == NULL))
+        return;
+
+    mtime_t duration = end - start;
+    if (duration < 0)
+        duration = 0;
+    else if (duration > UINT32_MAX)
+        duration = UINT32_MAX;
+
+    struct vlc_tracer_event *ev = &ring->events[ring->count % TRACER_RING_SIZE];
+    ev->start = start;
+    ev->ts = ts;
+    ev->duration = duration;
+    ev->thread = ring->index;
+    ev->stage = stage;
+
+    ring->histogram[stage][GetBucket(duration)]++;
+    ring->count++;
+
+    if (ts > VLC_TS_INVALID)
+        Hop(tracer, stage, end, ts);
+}
+
+static void WriteEvents(vlc_tracer_t *tracer, FILE *file)
+{
+    bool first = true;
+
+    fputs("{\"traceEvents\":[", file);
+    for (const struct vlc_tracer_ring *ring = tracer->rings; ring != NULL;
+         ring = ring->next)
+    {
+        uint64_t i = ring->count > TRACER_RING_SIZE
+                   ? ring->count - TRACER_RING_SIZE : 0;
+
+        for (; i < ring->count; i++)
+        {
+            const struct vlc_tracer_event *ev =
+                &ring->events[i % TRACER_RING_SIZE];
+
+            fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"vlc\",\"pid\":1,"
+                    "\"tid\":%u,\"ts\":%"PRId64",", first ? "" : ",",
+                    stage_names[ev->stage], ev->thread,
+                    ev->start - tracer->origin);
+            if (ev->stage == VLC_TRACER_DECODER_IN)
+                fputs("\"ph\":\"i\",\"s\":\"t\"", file);
+            else
+                fprintf(file, "\"ph\":\"X\",\"dur\":%"PRIu32, ev->duration);
+            if (ev->ts > VLC_TS_INVALID)
+                fprintf(file, ",\"args\":{\"ts\":%"PRId64"}", ev->ts);
+            fputc('}', file);
+            first = false;
+        }
+    }
+    fputs("\n]}\n", file);
+}
+
+static mtime_t GetPercentile(const uint64_t *histogram, uint64_t total,
+                             unsigned percent)
+{
+    uint64_t threshold = (total * percent + 99) / 100;
+    uint64_t count = 0;
+
+    for (unsigned i = 0; i < TRACER_BUCKETS; i++)
+    {
+        count += histogram[i];
+        if (count >= threshold)
+            return i ? INT64_C(1) << i : 1; /* upper bound of the bucket */
+    }
+    return INT64_C(1) << (TRACER_BUCKETS - 1);
+}
+
+static void LogHistogram(vlc_tracer_t *tracer, const char *stage,
+                         const char *what, const uint64_t *histogram)
+{
+    uint64_t total = 0;
+
+    for (unsigned i = 0; i < TRACER_BUCKETS; i++)
+        total += histogram[i];
+    if (total == 0)
+        return;
+
+    msg_Info(tracer->obj, "trace: %s %s: %"PRIu64" samples, p50 < %"PRId64
+             " us, p90 < %"PRId64" us, p99 < %"PRId64" us", stage, what,
+             total, GetPercentile(histogram, total, 50),
+             GetPercentile(histogram, total, 90),
+             GetPercentile(histogram, total, 99));
+}
+
+static void LogHistograms(vlc_tracer_t *tracer)
+{
+    for (unsigned stage = 0; stage < VLC_TRACER_STAGE_COUNT; stage++)
+    {
+        uint64_t histogram[TRACER_BUCKETS];
+
+        for (unsigned i = 0; i < TRACER_BUCKETS; i++)
+            histogram[i] = tracer->histogram[stage][i];
+        for (const struct vlc_tracer_ring *ring = tracer->rings; ring != NULL;
+             ring = ring->next)
+            for (unsigned i = 0; i < TRACER_BUCKETS; i++)
+                histogram[i] += ring->histogram[stage][i];
+
+        /* Instant events have no duration */
+        if (stage != VLC_TRACER_DECODER_IN)
+            LogHistogram(tracer, stage_names[stage], "duration", histogram);
+        LogHistogram(tracer, stage_names[stage], "latency from the previous "
+                     "hop", tracer->latency[stage]);
+    }
+}
+
+void vlc_tracer_Destroy(vlc_tracer_t *tracer)
+{
+    LogHistograms(tracer);
+
+    FILE *file = vlc_fopen(tracer->path, "wt");
+    if (file != NULL)
+    {
+        WriteEvents(tracer, file);
+        fclose(file);
+    }
+    else
+        msg_Err(tracer->obj, "cannot write trace file %s: %s", tracer->path,
+                vlc_strerror_c(errno));
+
+    unsigned ring_count = 0;
+    for (struct vlc_tracer_ring *ring = tracer->rings, *next; ring != NULL;
+         ring = next)
+    {
+        next = ring->next;
+        free(ring);
+        ring_count++;
+    }
+    msg_Dbg(tracer->obj, "trace: %u threads traced with %u buffers",
+            tracer->ring_count, ring_count);
+
+    vlc_mutex_destroy(&tracer->frames_lock);
+    vlc_mutex_destroy(&tracer->lock);
+    vlc_threadvar_delete(&tracer->key);
+    free(tracer->path);
+    free(tracer);
+}
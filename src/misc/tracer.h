@@ -0,0 +1,62 @@
+/*****************************************************************************
+ * tracer.h: per-frame latency tracing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_TRACER_H
+#define LIBVLC_TRACER_H 1
+
+#include <vlc_tracer.h>
+#include "libvlc.h"
+
+/**
+ * \addtogroup tracer
+ *
+ * Each thread records its events in its own ring buffer, without any
+ * locking. The ring of an exited thread is reused by the next thread, and
+ * its most recent events are kept until overwritten. When the instance is
+ * destroyed, the events are written to the "trace-file" using the Chrome
+ * trace event format (which Perfetto and chrome://tracing can load), and
+ * the histograms of the call durations and of the hop to hop latencies are
+ * summarized in the log.
+ * @{
+ */
+
+/**
+ * Creates the tracer of an instance, if tracing is enabled.
+ *
+ * \return the tracer or NULL if disabled or on error
+ */
+vlc_tracer_t *vlc_tracer_Create(vlc_object_t *libvlc);
+
+/**
+ * Writes the trace file, logs the histograms and destroys the tracer.
+ *
+ * No events may be recorded concurrently.
+ */
+void vlc_tracer_Destroy(vlc_tracer_t *tracer);
+
+/**
+ * Remembers the demuxer timestamp a system date was converted from.
+ */
+void vlc_tracer_Alias(vlc_tracer_t *tracer, mtime_t date, mtime_t ts);
+
+#define libvlc_tracer(o) (libvlc_priv((VLC_OBJECT(o))->obj.libvlc)->tracer)
+
+/** @} */
+#endif
@@ -230,7 +230,8 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
         LOAD_ARRAY(cfg->list.i, cfg->list_count);
     }
 
-    cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
+    if (cfg->list_count)
+        cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
     for (unsigned i = 0; i < cfg->list_count; i++)
     {
         LOAD_STRING (cfg->list_text[i]);
@@ -301,7 +302,7 @@ static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
     LOAD_IMMEDIATE(module->i_shortcuts);
     if (module->i_shortcuts > MODULE_SHORTCUT_MAX)
         goto error;
-    else
+    else if (module->i_shortcuts > 0)
     {
         module->pp_shortcuts =
             xmalloc (sizeof (*module->pp_shortcuts) * module->i_shortcuts);
@@ -438,7 +439,7 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return 0;
     }
 
-    vlc_plugin_t *cache = NULL;
+    vlc_plugin_t *cache = NULL, **cache_tail = &cache;
 
     while (file->i_buffer > 0)
     {
@@ -454,8 +455,11 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
             goto error;
         }
 
-        plugin->next = cache;
-        cache = plugin;
+        /* Keep the saved (directory scan) order, so that vlc_cache_lookup()
+         * normally finds each plugin at the head of the list. */
+        plugin->next = NULL;
+        *cache_tail = plugin;
+        cache_tail = &plugin->next;
     }
 
     file->p_next = *backingp;
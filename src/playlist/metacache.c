@@ -0,0 +1,440 @@
+/*****************************************************************************
+ * metacache.c: persistent cache of the preparsed metadata
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+#include <vlc_meta.h>
+#include <vlc_es.h>
+#include <vlc_fs.h>
+#include <vlc_url.h>
+#include <vlc_md5.h>
+
+#include "input/item.h"
+#include "metacache.h"
+
+/*
+ * The cache holds one file per item, named after the MD5 hash of its URI,
+ * in the "preparse" directory of the user cache directory. The file is made
+ * of lines of tab-separated fields, with the strings URI-encoded so that
+ * they contain neither tabs nor newlines:
+ *
+ *  vlc-preparse <format> <VLC version> <mtime> <size> <URI>
+ *  name <name>
+ *  duration <microseconds>
+ *  meta <vlc_meta_type_t> <value>
+ *  extra <name> <value>
+ *  info <category> <name> <value>
+ *  es <category> <codec> ... <language> <description>
+ *
+ * The first line identifies the file as it was preparsed: the entry is
+ * ignored, and replaced later on, once the file or VLC has changed.
+ */
+#define METACACHE_MAGIC "vlc-preparse"
+#define METACACHE_FORMAT 1
+
+static void MetaCacheCreateDir( const char *psz_dir )
+{
+    char newdir[strlen( psz_dir ) + 1];
+    strcpy( newdir, psz_dir );
+
+    for( char *psz = newdir + 1; *psz; psz++ )
+    {
+        if( *psz != DIR_SEP_CHAR )
+            continue;
+        *psz = '\0';
+        vlc_mkdir( newdir, 0700 );
+        *psz = DIR_SEP_CHAR;
+    }
+    vlc_mkdir( psz_dir, 0700 );
+}
+
+static char *MetaCacheDir( void )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_dir;
+
+    if( psz_cachedir == NULL
+     || asprintf( &psz_dir, "%s" DIR_SEP "preparse", psz_cachedir ) == -1 )
+        psz_dir = NULL;
+    free( psz_cachedir );
+    return psz_dir;
+}
+
+static char *MetaCacheFile( const char *psz_dir, const char *psz_uri )
+{
+    struct md5_s md5;
+    char *psz_file;
+
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_uri, strlen( psz_uri ) );
+    EndMD5( &md5 );
+
+    char *psz_hash = psz_md5_hash( &md5 );
+    if( psz_hash == NULL
+     || asprintf( &psz_file, "%s" DIR_SEP "%s", psz_dir, psz_hash ) == -1 )
+        psz_file = NULL;
+    free( psz_hash );
+    return psz_file;
+}
+
+/* Only the regular local files are cached: their modification time and
+ * size tell when they have changed */
+static int MetaCacheStat( const char *psz_uri, struct stat *st )
+{
+    char *psz_path = vlc_uri2path( psz_uri );
+    if( psz_path == NULL )
+        return -1;
+
+    int i_ret = vlc_stat( psz_path, st );
+    free( psz_path );
+    if( i_ret == 0 && !S_ISREG( st->st_mode ) )
+        i_ret = -1;
+    return i_ret;
+}
+
+static void PutString( FILE *f, const char *psz )
+{
+    char *psz_enc = vlc_uri_encode( psz ? psz : "" );
+    fprintf( f, "\t%s", psz_enc ? psz_enc : "" );
+    free( psz_enc );
+}
+
+static char *GetString( char **ppsz_line )
+{
+    char *psz = strsep( ppsz_line, "\t" );
+    return psz ? vlc_uri_decode( psz ) : NULL;
+}
+
+static long long GetInteger( char **ppsz_line )
+{
+    char *psz = strsep( ppsz_line, "\t" );
+    return psz ? strtoll( psz, NULL, 10 ) : 0;
+}
+
+static void PutES( FILE *f, const es_format_t *fmt )
+{
+    fprintf( f, "es\t%d\t%"PRIu32"\t%"PRIu32"\t%d\t%d\t%d\t%u",
+             fmt->i_cat, fmt->i_codec, fmt->i_original_fourcc, fmt->i_id,
+             fmt->i_group, fmt->i_priority, fmt->i_bitrate );
+
+    switch( fmt->i_cat )
+    {
+        case AUDIO_ES:
+            fprintf( f, "\t%u\t%u\t%u", fmt->audio.i_rate,
+                     fmt->audio.i_channels, fmt->audio.i_bitspersample );
+            break;
+        case VIDEO_ES:
+            fprintf( f, "\t%u\t%u\t%u\t%u\t%u\t%u\t%u\t%u",
+                     fmt->video.i_width, fmt->video.i_height,
+                     fmt->video.i_visible_width, fmt->video.i_visible_height,
+                     fmt->video.i_sar_num, fmt->video.i_sar_den,
+                     fmt->video.i_frame_rate, fmt->video.i_frame_rate_base );
+            break;
+        default:
+            break;
+    }
+
+    PutString( f, fmt->psz_language );
+    PutString( f, fmt->psz_description );
+    fputc( '\n', f );
+}
+
+static void GetES( input_item_t *p_item, char *psz_line )
+{
+    es_format_t fmt;
+    int i_cat = GetInteger( &psz_line );
+
+    if( i_cat != AUDIO_ES && i_cat != VIDEO_ES && i_cat != SPU_ES
+     && i_cat != DATA_ES )
+        return;
+
+    es_format_Init( &fmt, i_cat, GetInteger( &psz_line ) );
+    fmt.i_original_fourcc = GetInteger( &psz_line );
+    fmt.i_id = GetInteger( &psz_line );
+    fmt.i_group = GetInteger( &psz_line );
+    fmt.i_priority = GetInteger( &psz_line );
+    fmt.i_bitrate = GetInteger( &psz_line );
+
+    switch( i_cat )
+    {
+        case AUDIO_ES:
+            fmt.audio.i_rate = GetInteger( &psz_line );
+            fmt.audio.i_channels = GetInteger( &psz_line );
+            fmt.audio.i_bitspersample = GetInteger( &psz_line );
+            break;
+        case VIDEO_ES:
+            fmt.video.i_width = GetInteger( &psz_line );
+            fmt.video.i_height = GetInteger( &psz_line );
+            fmt.video.i_visible_width = GetInteger( &psz_line );
+            fmt.video.i_visible_height = GetInteger( &psz_line );
+            fmt.video.i_sar_num = GetInteger( &psz_line );
+            fmt.video.i_sar_den = GetInteger( &psz_line );
+            fmt.video.i_frame_rate = GetInteger( &psz_line );
+            fmt.video.i_frame_rate_base = GetInteger( &psz_line );
+            break;
+    }
+
+    const char *psz_language = GetString( &psz_line );
+    const char *psz_description = GetString( &psz_line );
+    if( !EMPTY_STR( psz_language ) )
+        fmt.psz_language = strdup( psz_language );
+    if( !EMPTY_STR( psz_description ) )
+        fmt.psz_description = strdup( psz_description );
+
+    input_item_UpdateTracksInfo( p_item, &fmt );
+    es_format_Clean( &fmt );
+}
+
+static void GetLine( input_item_t *p_item, char *psz_line )
+{
+    const char *psz_key = strsep( &psz_line, "\t" );
+
+    if( !strcmp( psz_key, "name" ) )
+    {
+        const char *psz_name = GetString( &psz_line );
+        if( psz_name )
+            input_item_SetName( p_item, psz_name );
+    }
+    else if( !strcmp( psz_key, "duration" ) )
+        input_item_SetDuration( p_item, GetInteger( &psz_line ) );
+    else if( !strcmp( psz_key, "meta" ) )
+    {
+        long long i_type = GetInteger( &psz_line );
+        const char *psz_value = GetString( &psz_line );
+        if( i_type >= 0 && i_type < VLC_META_TYPE_COUNT && psz_value )
+            input_item_SetMeta( p_item, i_type, psz_value );
+    }
+    else if( !strcmp( psz_key, "extra" ) )
+    {
+        const char *psz_name = GetString( &psz_line );
+        const char *psz_value = GetString( &psz_line );
+        if( psz_name == NULL || psz_value == NULL )
+            return;
+
+        vlc_mutex_lock( &p_item->lock );
+        if( !p_item->p_meta )
+            p_item->p_meta = vlc_meta_New();
+        if( p_item->p_meta )
+            vlc_meta_AddExtra( p_item->p_meta, psz_name, psz_value );
+        vlc_mutex_unlock( &p_item->lock );
+    }
+    else if( !strcmp( psz_key, "info" ) )
+    {
+        const char *psz_cat = GetString( &psz_line );
+        const char *psz_name = GetString( &psz_line );
+        const char *psz_value = GetString( &psz_line );
+        if( psz_cat && psz_name && psz_value )
+            input_item_AddInfo( p_item, psz_cat, psz_name, "%s", psz_value );
+    }
+    else if( !strcmp( psz_key, "es" ) )
+        GetES( p_item, psz_line );
+}
+
+int playlist_LoadMetaCache( vlc_object_t *obj, input_item_t *p_item )
+{
+    char *psz_uri = input_item_GetURI( p_item );
+    char *psz_dir = MetaCacheDir();
+    char *psz_file = NULL;
+    char *psz_line = NULL;
+    size_t i_size = 0;
+    ssize_t i_len;
+    FILE *f = NULL;
+    struct stat st;
+    int i_ret = VLC_EGENERIC;
+
+    if( psz_uri == NULL || psz_dir == NULL
+     || MetaCacheStat( psz_uri, &st ) )
+        goto end;
+
+    psz_file = MetaCacheFile( psz_dir, psz_uri );
+    if( psz_file == NULL || (f = vlc_fopen( psz_file, "rt" )) == NULL )
+        goto end;
+
+    /* Check that the entry matches the file as it is now */
+    if( (i_len = getline( &psz_line, &i_size, f )) <= 0 )
+        goto end;
+    if( psz_line[i_len - 1] == '\n' )
+        psz_line[i_len - 1] = '\0';
+
+    char *psz = psz_line;
+    const char *psz_magic = strsep( &psz, "\t" );
+    if( strcmp( psz_magic, METACACHE_MAGIC )
+     || GetInteger( &psz ) != METACACHE_FORMAT )
+        goto end;
+
+    const char *psz_version = GetString( &psz );
+    if( psz_version == NULL || strcmp( psz_version, PACKAGE_VERSION )
+     || GetInteger( &psz ) != (long long)st.st_mtime
+     || GetInteger( &psz ) != (long long)st.st_size )
+        goto end;
+
+    const char *psz_entry_uri = GetString( &psz );
+    if( psz_entry_uri == NULL || strcmp( psz_entry_uri, psz_uri ) )
+        goto end;
+
+    while( (i_len = getline( &psz_line, &i_size, f )) > 0 )
+    {
+        if( psz_line[i_len - 1] == '\n' )
+            psz_line[i_len - 1] = '\0';
+        GetLine( p_item, psz_line );
+    }
+
+    msg_Dbg( obj, "%s restored from the preparser cache", psz_uri );
+    i_ret = VLC_SUCCESS;
+end:
+    if( f != NULL )
+        fclose( f );
+    free( psz_line );
+    free( psz_file );
+    free( psz_dir );
+    free( psz_uri );
+    return i_ret;
+}
+
+static void PutItem( FILE *f, input_item_t *p_item )
+{
+    fputs( "name", f );
+    PutString( f, p_item->psz_name );
+    fprintf( f, "\nduration\t%"PRId64"\n", p_item->i_duration );
+
+    if( p_item->p_meta )
+    {
+        for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+        {
+            const char *psz_value = vlc_meta_Get( p_item->p_meta, i );
+            if( psz_value == NULL )
+                continue;
+            fprintf( f, "meta\t%d", i );
+            PutString( f, psz_value );
+            fputc( '\n', f );
+        }
+
+        char **ppsz_names = vlc_meta_CopyExtraNames( p_item->p_meta );
+        for( int i = 0; ppsz_names && ppsz_names[i]; i++ )
+        {
+            fputs( "extra", f );
+            PutString( f, ppsz_names[i] );
+            PutString( f, vlc_meta_GetExtra( p_item->p_meta, ppsz_names[i] ) );
+            fputc( '\n', f );
+            free( ppsz_names[i] );
+        }
+        free( ppsz_names );
+    }
+
+    for( int i = 0; i < p_item->i_categories; i++ )
+    {
+        const info_category_t *p_cat = p_item->pp_categories[i];
+
+        for( int j = 0; j < p_cat->i_infos; j++ )
+        {
+            fputs( "info", f );
+            PutString( f, p_cat->psz_name );
+            PutString( f, p_cat->pp_infos[j]->psz_name );
+            PutString( f, p_cat->pp_infos[j]->psz_value );
+            fputc( '\n', f );
+        }
+    }
+
+    for( int i = 0; i < p_item->i_es; i++ )
+        PutES( f, p_item->es[i] );
+}
+
+void playlist_SaveMetaCache( vlc_object_t *obj, input_item_t *p_item )
+{
+    char *psz_uri = input_item_GetURI( p_item );
+    char *psz_dir = NULL;
+    char *psz_file = NULL;
+    char *psz_temp = NULL;
+    struct stat st;
+
+    if( psz_uri == NULL || MetaCacheStat( psz_uri, &st ) )
+        goto end;
+
+    /* Playlists have no tracks: their sub-items are not stored */
+    vlc_mutex_lock( &p_item->lock );
+    bool b_tracks = p_item->i_es > 0;
+    vlc_mutex_unlock( &p_item->lock );
+    if( !b_tracks )
+        goto end;
+
+    psz_dir = MetaCacheDir();
+    if( psz_dir == NULL )
+        goto end;
+    MetaCacheCreateDir( psz_dir );
+
+    psz_file = MetaCacheFile( psz_dir, psz_uri );
+    if( psz_file == NULL
+     || asprintf( &psz_temp, "%s.XXXXXX", psz_file ) == -1 )
+    {
+        psz_temp = NULL;
+        goto end;
+    }
+
+    /* Written aside, then renamed: concurrent readers never see a partial
+     * entry */
+    int fd = vlc_mkstemp( psz_temp );
+    if( fd == -1 )
+    {
+        msg_Warn( obj, "cannot create %s: %s", psz_temp,
+                  vlc_strerror_c(errno) );
+        goto end;
+    }
+    FILE *f = fdopen( fd, "wt" );
+    if( f == NULL )
+    {
+        vlc_close( fd );
+        vlc_unlink( psz_temp );
+        goto end;
+    }
+
+    fprintf( f, METACACHE_MAGIC "\t%d", METACACHE_FORMAT );
+    PutString( f, PACKAGE_VERSION );
+    fprintf( f, "\t%lld\t%lld", (long long)st.st_mtime,
+             (long long)st.st_size );
+    PutString( f, psz_uri );
+    fputc( '\n', f );
+
+    vlc_mutex_lock( &p_item->lock );
+    PutItem( f, p_item );
+    vlc_mutex_unlock( &p_item->lock );
+
+    bool b_error = ferror( f );
+    if( fclose( f ) || b_error || vlc_rename( psz_temp, psz_file ) )
+    {
+        msg_Warn( obj, "cannot write %s: %s", psz_file,
+                  vlc_strerror_c(errno) );
+        vlc_unlink( psz_temp );
+    }
+end:
+    free( psz_temp );
+    free( psz_file );
+    free( psz_dir );
+    free( psz_uri );
+}
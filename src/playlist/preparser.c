@@ -30,12 +30,14 @@
 #include "input/input_internal.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "metacache.h"
 
 struct playlist_preparser_t
 {
     vlc_object_t* owner;
     playlist_fetcher_t* fetcher;
     struct background_worker* worker;
+    bool b_cache;
     atomic_bool deactivated;
 };
 
@@ -50,10 +52,31 @@ static int InputEvent( vlc_object_t* obj, const char* varname,
     return VLC_SUCCESS;
 }
 
+static void PreparserEnded( playlist_preparser_t* preparser,
+                            input_item_t* item, int status )
+{
+    if( preparser->fetcher )
+    {
+        if( !playlist_fetcher_Push( preparser->fetcher, item, 0, status ) )
+            return;
+    }
+
+    input_item_SetPreparsed( item, true );
+    input_item_SignalPreparseEnded( item, status );
+}
+
 static int PreparserOpenInput( void* preparser_, void* item_, void** out )
 {
     playlist_preparser_t* preparser = preparser_;
 
+    if( preparser->b_cache
+     && !playlist_LoadMetaCache( preparser->owner, item_ ) )
+    {
+        /* No input to run: the item is done already */
+        PreparserEnded( preparser, item_, ITEM_PREPARSE_DONE );
+        return VLC_EGENERIC;
+    }
+
     input_thread_t* input = input_CreatePreparser( preparser->owner, item_ );
     if( !input )
     {
@@ -105,14 +128,10 @@ static void PreparserCloseInput( void* preparser_, void* input_ )
     input_Stop( input );
     input_Close( input );
 
-    if( preparser->fetcher )
-    {
-        if( !playlist_fetcher_Push( preparser->fetcher, item, 0, status ) )
-            return;
-    }
+    if( preparser->b_cache && status == ITEM_PREPARSE_DONE )
+        playlist_SaveMetaCache( preparser->owner, item );
 
-    input_item_SetPreparsed( item, true );
-    input_item_SignalPreparseEnded( item, status );
+    PreparserEnded( preparser, item, status );
 }
 
 static void InputItemRelease( void* item ) { input_item_Release( item ); }
@@ -124,6 +143,7 @@ playlist_preparser_t* playlist_preparser_New( vlc_object_t *parent )
 
     struct background_worker_config conf = {
         .default_timeout = var_InheritInteger( parent, "preparse-timeout" ),
+        .max_threads = var_InheritInteger( parent, "preparse-threads" ),
         .pf_start = PreparserOpenInput,
         .pf_probe = PreparserProbeInput,
         .pf_stop = PreparserCloseInput,
@@ -141,6 +161,7 @@ playlist_preparser_t* playlist_preparser_New( vlc_object_t *parent )
     }
 
     preparser->owner = parent;
+    preparser->b_cache = var_InheritBool( parent, "preparse-cache" );
     preparser->fetcher = playlist_fetcher_New( parent );
     atomic_init( &preparser->deactivated, false );
 
@@ -49,6 +49,7 @@
 #include <vlc_modules.h>
 
 #include "input/input_interface.h"
+#include "misc/tracer.h"
 
 #undef DEBUG_BUFFER
 /*****************************************************************************
@@ -73,6 +74,22 @@ static int  mrl_Parse( mrl_t *p_mrl, const char *psz_mrl );
 /* mrl_Clean: clean p_mrl  after a call to mrl_Parse */
 static void mrl_Clean( mrl_t *p_mrl );
 
+struct sout_access_out_private_t;
+
+typedef struct
+{
+    sout_instance_t sout;
+
+    /* Asynchronous access outputs, for the statistics */
+    vlc_mutex_t     queues_lock;
+    struct sout_access_out_private_t **queues;
+    int             i_queues;
+    size_t          queue_max; /* of the deleted access outputs */
+    uint64_t        dropped;   /* by the deleted access outputs */
+} sout_instance_private_t;
+
+#define sout_instance_priv(s) container_of(s, sout_instance_private_t, sout)
+
 #undef sout_NewInstance
 
 /*****************************************************************************
@@ -80,6 +97,7 @@ static void mrl_Clean( mrl_t *p_mrl );
  *****************************************************************************/
 sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest )
 {
+    sout_instance_private_t *priv;
     sout_instance_t *p_sout;
     char *psz_chain;
 
@@ -98,12 +116,13 @@ sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest
         return NULL;
 
     /* *** Allocate descriptor *** */
-    p_sout = vlc_custom_create( p_parent, sizeof( *p_sout ), "stream output" );
-    if( p_sout == NULL )
+    priv = vlc_custom_create( p_parent, sizeof( *priv ), "stream output" );
+    if( priv == NULL )
     {
         free( psz_chain );
         return NULL;
     }
+    p_sout = &priv->sout;
 
     msg_Dbg( p_sout, "using sout chain=`%s'", psz_chain );
 
@@ -114,6 +133,11 @@ sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest
     vlc_mutex_init( &p_sout->lock );
     p_sout->p_stream = NULL;
 
+    vlc_mutex_init( &priv->queues_lock );
+    TAB_INIT( priv->i_queues, priv->queues );
+    priv->queue_max = 0;
+    priv->dropped = 0;
+
     var_Create( p_sout, "sout-mux-caching", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT );
 
     p_sout->p_stream = sout_StreamChainNew( p_sout, psz_chain, NULL, NULL );
@@ -128,6 +152,7 @@ sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest
 
     FREENULL( p_sout->psz_sout );
 
+    vlc_mutex_destroy( &priv->queues_lock );
     vlc_mutex_destroy( &p_sout->lock );
     vlc_object_release( p_sout );
     return NULL;
@@ -138,12 +163,17 @@ sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest
  *****************************************************************************/
 void sout_DeleteInstance( sout_instance_t * p_sout )
 {
+    sout_instance_private_t *priv = sout_instance_priv( p_sout );
+
     /* remove the stream out chain */
     sout_StreamChainDelete( p_sout->p_stream, NULL );
 
     /* *** free all string *** */
     FREENULL( p_sout->psz_sout );
 
+    assert( priv->i_queues == 0 );
+    TAB_CLEAN( priv->i_queues, priv->queues );
+    vlc_mutex_destroy( &priv->queues_lock );
     vlc_mutex_destroy( &p_sout->lock );
 
     /* *** free structure *** */
@@ -240,6 +270,242 @@ int sout_InputSendBuffer( sout_packetizer_input_t *p_input,
     return i_ret;
 }
 
+/*
+ * Asynchronous access output
+ *
+ * If enabled, the data is queued and written from a dedicated thread, so
+ * that a slow destination does not stall the muxer and the other outputs.
+ * The whole queue is handed over to the access output at once, which lets
+ * it coalesce the writes.
+ */
+typedef struct sout_access_out_private_t
+{
+    sout_access_out_t access;
+
+    sout_instance_private_t *owner; /* NULL if not in a stream output */
+    block_fifo_t *fifo; /* NULL if synchronous */
+    vlc_cond_t    wait;
+    vlc_thread_t  thread;
+    int           policy;
+    size_t        max_size;
+    bool          dropping;
+
+    /* Protected by the fifo lock */
+    bool          eos;
+    bool          busy;
+    bool          dead;
+    size_t        max_depth;
+    unsigned      dropped;
+    unsigned      errors;
+} sout_access_out_private_t;
+
+#define sout_access_out_priv(a) container_of(a, sout_access_out_private_t, access)
+
+static const char *const sout_access_policies[] = { "block", "drop", "disconnect" };
+
+enum
+{
+    SOUT_ACCESS_BLOCK,
+    SOUT_ACCESS_DROP,
+    SOUT_ACCESS_DISCONNECT,
+};
+
+static ssize_t AccessOutWrite( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    vlc_tracer_t *tracer = libvlc_tracer( p_access );
+    mtime_t trace_start = vlc_tracer_Begin( tracer );
+    mtime_t trace_date = p_buffer != NULL ? p_buffer->i_dts : VLC_TS_INVALID;
+
+    ssize_t i_ret = p_access->pf_write( p_access, p_buffer );
+
+    vlc_tracer_EndDate( tracer, VLC_TRACER_ACCESS_OUT, trace_start,
+                        trace_date );
+    return i_ret;
+}
+
+static void *AccessOutThread( void *data )
+{
+    sout_access_out_private_t *priv = data;
+    block_fifo_t *fifo = priv->fifo;
+    int canc = vlc_savecancel();
+
+    vlc_fifo_Lock( fifo );
+    for( ;; )
+    {
+        while( vlc_fifo_IsEmpty( fifo ) && !priv->eos )
+            vlc_fifo_Wait( fifo );
+        if( vlc_fifo_IsEmpty( fifo ) )
+            break;
+
+        block_t *p_chain = vlc_fifo_DequeueAllUnlocked( fifo );
+        priv->busy = true;
+        vlc_cond_broadcast( &priv->wait );
+        vlc_fifo_Unlock( fifo );
+
+        ssize_t i_ret = AccessOutWrite( &priv->access, p_chain );
+
+        vlc_fifo_Lock( fifo );
+        priv->busy = false;
+        if( i_ret < 0 )
+        {
+            /* The destination is gone: the next writes will fail */
+            msg_Err( &priv->access, "write error, disconnecting" );
+            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( fifo ) );
+            priv->errors++;
+            priv->dead = true;
+            priv->eos = true;
+        }
+        vlc_cond_broadcast( &priv->wait );
+    }
+    vlc_fifo_Unlock( fifo );
+
+    vlc_restorecancel( canc );
+    return NULL;
+}
+
+static int AccessOutStartAsync( sout_access_out_private_t *priv )
+{
+    sout_access_out_t *p_access = &priv->access;
+
+    char *psz_policy = var_InheritString( p_access, "sout-access-policy" );
+    priv->policy = SOUT_ACCESS_BLOCK;
+    for( size_t i = 0; psz_policy && i < ARRAY_SIZE(sout_access_policies); i++ )
+        if( !strcmp( psz_policy, sout_access_policies[i] ) )
+            priv->policy = i;
+    free( psz_policy );
+    priv->max_size = var_InheritInteger( p_access, "sout-access-queue-size" ) * 1024;
+
+    priv->fifo = block_FifoNew();
+    if( unlikely(priv->fifo == NULL) )
+        return VLC_ENOMEM;
+    vlc_cond_init( &priv->wait );
+
+    if( vlc_clone( &priv->thread, AccessOutThread, priv,
+                   VLC_THREAD_PRIORITY_OUTPUT ) )
+    {
+        vlc_cond_destroy( &priv->wait );
+        block_FifoRelease( priv->fifo );
+        priv->fifo = NULL;
+        return VLC_EGENERIC;
+    }
+
+    msg_Dbg( p_access, "writing asynchronously (%s, %zu bytes queue)",
+             sout_access_policies[priv->policy], priv->max_size );
+
+    /* Report the queue in the statistics of the stream output */
+    for( vlc_object_t *obj = p_access->obj.parent; obj != NULL;
+         obj = obj->obj.parent )
+        if( !strcmp( obj->obj.object_type, "stream output" ) )
+        {
+            priv->owner = sout_instance_priv( (sout_instance_t *)obj );
+            vlc_mutex_lock( &priv->owner->queues_lock );
+            TAB_APPEND( priv->owner->i_queues, priv->owner->queues, priv );
+            vlc_mutex_unlock( &priv->owner->queues_lock );
+            break;
+        }
+    return VLC_SUCCESS;
+}
+
+static void AccessOutStopAsync( sout_access_out_private_t *priv )
+{
+    vlc_fifo_Lock( priv->fifo );
+    priv->eos = true;
+    vlc_fifo_Signal( priv->fifo );
+    vlc_fifo_Unlock( priv->fifo );
+    vlc_join( priv->thread, NULL );
+
+    msg_Dbg( &priv->access, "%u blocks dropped, %u write errors, "
+             "%zu bytes queued at most", priv->dropped, priv->errors,
+             priv->max_depth );
+
+    sout_instance_private_t *owner = priv->owner;
+    if( owner != NULL )
+    {
+        vlc_mutex_lock( &owner->queues_lock );
+        TAB_REMOVE( owner->i_queues, owner->queues, priv );
+        owner->dropped += priv->dropped;
+        if( priv->max_depth > owner->queue_max )
+            owner->queue_max = priv->max_depth;
+        vlc_mutex_unlock( &owner->queues_lock );
+    }
+
+    vlc_cond_destroy( &priv->wait );
+    block_FifoRelease( priv->fifo );
+    priv->fifo = NULL;
+}
+
+/* Waits for the queued data to be written, so that the access output can be
+ * used from the calling thread. Returns false if it was disconnected. */
+static bool AccessOutDrain( sout_access_out_private_t *priv )
+{
+    if( priv->fifo == NULL )
+        return true;
+
+    vlc_fifo_Lock( priv->fifo );
+    while( (!vlc_fifo_IsEmpty( priv->fifo ) || priv->busy) && !priv->dead )
+        vlc_fifo_WaitCond( priv->fifo, &priv->wait );
+    bool b_alive = !priv->dead;
+    vlc_fifo_Unlock( priv->fifo );
+    return b_alive;
+}
+
+static ssize_t AccessOutQueue( sout_access_out_private_t *priv,
+                               block_t *p_buffer )
+{
+    block_fifo_t *fifo = priv->fifo;
+    size_t i_size = 0;
+
+    for( block_t *p = p_buffer; p != NULL; p = p->p_next )
+        i_size += p->i_buffer;
+
+    vlc_fifo_Lock( fifo );
+    if( priv->policy == SOUT_ACCESS_BLOCK )
+    {
+        while( vlc_fifo_GetBytes( fifo ) >= priv->max_size && !priv->dead )
+            vlc_fifo_WaitCond( fifo, &priv->wait );
+    }
+
+    if( priv->dead )
+    {
+        vlc_fifo_Unlock( fifo );
+        block_ChainRelease( p_buffer );
+        return -1;
+    }
+
+    if( vlc_fifo_GetBytes( fifo ) >= priv->max_size )
+    {
+        ssize_t i_ret = i_size;
+
+        priv->dropped++;
+        if( priv->policy == SOUT_ACCESS_DISCONNECT )
+        {
+            msg_Err( &priv->access, "too slow, disconnecting" );
+            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( fifo ) );
+            priv->dead = true;
+            priv->eos = true;
+            vlc_fifo_Signal( fifo );
+            vlc_cond_broadcast( &priv->wait );
+            i_ret = -1;
+        }
+        else if( !priv->dropping )
+        {
+            msg_Warn( &priv->access, "too slow, dropping data" );
+            priv->dropping = true;
+        }
+        vlc_fifo_Unlock( fifo );
+        block_ChainRelease( p_buffer );
+        return i_ret;
+    }
+
+    priv->dropping = false;
+    vlc_fifo_QueueUnlocked( fifo, p_buffer );
+    size_t i_depth = vlc_fifo_GetBytes( fifo );
+    if( i_depth > priv->max_depth )
+        priv->max_depth = i_depth;
+    vlc_fifo_Unlock( fifo );
+    return i_size;
+}
+
 #undef sout_AccessOutNew
 /*****************************************************************************
  * sout_AccessOutNew: allocate a new access out
@@ -247,12 +513,14 @@ int sout_InputSendBuffer( sout_packetizer_input_t *p_input,
 sout_access_out_t *sout_AccessOutNew( vlc_object_t *p_sout,
                                       const char *psz_access, const char *psz_name )
 {
+    sout_access_out_private_t *priv;
     sout_access_out_t *p_access;
     char              *psz_next;
 
-    p_access = vlc_custom_create( p_sout, sizeof( *p_access ), "access out" );
-    if( !p_access )
+    priv = vlc_custom_create( p_sout, sizeof( *priv ), "access out" );
+    if( !priv )
         return NULL;
+    p_access = &priv->access;
 
     psz_next = config_ChainCreate( &p_access->psz_access, &p_access->p_cfg,
                                    psz_access );
@@ -276,6 +544,15 @@ sout_access_out_t *sout_AccessOutNew( vlc_object_t *p_sout,
         return( NULL );
     }
 
+    priv->owner = NULL;
+    priv->fifo = NULL;
+    priv->eos = priv->busy = priv->dead = priv->dropping = false;
+    priv->max_depth = 0;
+    priv->dropped = priv->errors = 0;
+    if( var_InheritBool( p_access, "sout-access-async" )
+     && AccessOutStartAsync( priv ) )
+        msg_Warn( p_access, "cannot write asynchronously" );
+
     return p_access;
 }
 /*****************************************************************************
@@ -283,6 +560,11 @@ sout_access_out_t *sout_AccessOutNew( vlc_object_t *p_sout,
  *****************************************************************************/
 void sout_AccessOutDelete( sout_access_out_t *p_access )
 {
+    sout_access_out_private_t *priv = sout_access_out_priv( p_access );
+
+    if( priv->fifo != NULL )
+        AccessOutStopAsync( priv );
+
     if( p_access->p_module )
     {
         module_unneed( p_access, p_access->p_module );
@@ -303,6 +585,8 @@ int sout_AccessOutSeek( sout_access_out_t *p_access, off_t i_pos )
 {
     if (p_access->pf_seek == NULL)
         return VLC_EGENERIC;
+    if( !AccessOutDrain( sout_access_out_priv( p_access ) ) )
+        return VLC_EGENERIC;
     return p_access->pf_seek( p_access, i_pos );
 }
 
@@ -311,8 +595,10 @@ int sout_AccessOutSeek( sout_access_out_t *p_access, off_t i_pos )
  *****************************************************************************/
 ssize_t sout_AccessOutRead( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    return( p_access->pf_read ?
-            p_access->pf_read( p_access, p_buffer ) : VLC_EGENERIC );
+    if( p_access->pf_read == NULL
+     || !AccessOutDrain( sout_access_out_priv( p_access ) ) )
+        return VLC_EGENERIC;
+    return p_access->pf_read( p_access, p_buffer );
 }
 
 /*****************************************************************************
@@ -320,7 +606,53 @@ ssize_t sout_AccessOutRead( sout_access_out_t *p_access, block_t *p_buffer )
  *****************************************************************************/
 ssize_t sout_AccessOutWrite( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    return p_access->pf_write( p_access, p_buffer );
+    sout_access_out_private_t *priv = sout_access_out_priv( p_access );
+
+    if( priv->fifo != NULL )
+        return p_buffer != NULL ? AccessOutQueue( priv, p_buffer ) : 0;
+    return AccessOutWrite( p_access, p_buffer );
+}
+
+/* Whether a query must wait for the queued data to be written. The other ones
+ * report fixed properties of the access output. */
+static bool AccessOutControlIsOrdered (int query)
+{
+    switch (query)
+    {
+        case ACCESS_OUT_CONTROLS_PACE:
+        case ACCESS_OUT_CAN_SEEK:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Gets the statistics of the queues of the asynchronous access outputs of
+ * a stream output: the amount of data queued now and at most, and the
+ * number of writes dropped so far.
+ */
+void sout_GetQueueStats( sout_instance_t *p_sout, size_t *pi_depth,
+                         size_t *pi_max_depth, uint64_t *pi_dropped )
+{
+    sout_instance_private_t *priv = sout_instance_priv( p_sout );
+
+    vlc_mutex_lock( &priv->queues_lock );
+    *pi_depth = 0;
+    *pi_max_depth = priv->queue_max;
+    *pi_dropped = priv->dropped;
+    for( int i = 0; i < priv->i_queues; i++ )
+    {
+        sout_access_out_private_t *queue = priv->queues[i];
+
+        vlc_fifo_Lock( queue->fifo );
+        *pi_depth += vlc_fifo_GetBytes( queue->fifo );
+        if( queue->max_depth > *pi_max_depth )
+            *pi_max_depth = queue->max_depth;
+        *pi_dropped += queue->dropped;
+        vlc_fifo_Unlock( queue->fifo );
+    }
+    vlc_mutex_unlock( &priv->queues_lock );
 }
 
 /**
@@ -332,7 +664,9 @@ int sout_AccessOutControl (sout_access_out_t *access, int query, ...)
     int ret;
 
     va_start (ap, query);
-    if (access->pf_control)
+    if (access->pf_control
+     && (!AccessOutControlIsOrdered (query)
+      || AccessOutDrain (sout_access_out_priv (access))))
         ret = access->pf_control (access, query, ap);
     else
         ret = VLC_EGENERIC;
@@ -524,6 +858,8 @@ int sout_MuxSendBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
                          block_t *p_buffer )
 {
     mtime_t i_dts = p_buffer->i_dts;
+    mtime_t trace_date = p_buffer->i_pts > VLC_TS_INVALID ? p_buffer->i_pts
+                                                          : i_dts;
     block_FifoPut( p_input->p_fifo, p_buffer );
 
     if( p_mux->p_sout->i_out_pace_nocontrol )
@@ -547,7 +883,14 @@ int sout_MuxSendBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
             return VLC_SUCCESS;
         p_mux->b_waiting_stream = false;
     }
-    return p_mux->pf_mux( p_mux );
+
+    vlc_tracer_t *tracer = libvlc_tracer( p_mux );
+    mtime_t trace_start = vlc_tracer_Begin( tracer );
+
+    int i_ret = p_mux->pf_mux( p_mux );
+
+    vlc_tracer_EndDate( tracer, VLC_TRACER_MUX, trace_start, trace_date );
+    return i_ret;
 }
 
 void sout_MuxFlush( sout_mux_t *p_mux, sout_input_t *p_input )
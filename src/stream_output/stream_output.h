@@ -43,6 +43,7 @@ struct sout_packetizer_input_t
 sout_instance_t *sout_NewInstance( vlc_object_t *, const char * );
 #define sout_NewInstance(a,b) sout_NewInstance(VLC_OBJECT(a),b)
 void sout_DeleteInstance( sout_instance_t * );
+void sout_GetQueueStats( sout_instance_t *, size_t *, size_t *, uint64_t * );
 
 sout_packetizer_input_t *sout_InputNew( sout_instance_t *, const es_format_t * );
 int sout_InputDelete( sout_packetizer_input_t * );
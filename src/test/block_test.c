@@ -86,11 +86,113 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static unsigned storage_releases;
+
+static void storage_Release (block_t *block)
+{
+    storage_releases++;
+    free (block);
+}
+
+static block_t *storage_New (void)
+{
+    block_t *block = malloc (sizeof (*block) + sizeof (text));
+    assert (block != NULL);
+    block_Init (block, block + 1, sizeof (text));
+    block->pf_release = storage_Release;
+    memcpy (block->p_buffer, text, sizeof (text));
+    return block;
+}
+
+static void test_block_Slice (void)
+{
+    /* Slices released before the remaining tail */
+    block_t *tail = storage_New ();
+    tail->i_pts = 42;
+    storage_releases = 0;
+
+    block_t *head = block_Slice (&tail, 5);
+    assert (head != NULL && tail != NULL);
+    assert (head->i_buffer == 5 && head->i_pts == 42);
+    assert (!memcmp (head->p_buffer, text, 5));
+    assert (tail->i_buffer == sizeof (text) - 5);
+    assert (tail->i_pts == VLC_TS_INVALID);
+
+    block_t *next = block_Slice (&tail, 3);
+    assert (next != NULL);
+    assert (!memcmp (next->p_buffer, text + 5, 3));
+    assert (!memcmp (tail->p_buffer, text + 8, sizeof (text) - 8));
+
+    /* A slice cannot grow into its neighbours */
+    next = block_Realloc (next, 2, 6);
+    assert (next != NULL);
+    assert (!memcmp (next->p_buffer + 2, text + 5, 3));
+    assert (!memcmp (head->p_buffer, text, 5));
+    tail = block_Realloc (tail, 1, tail->i_buffer + 1);
+    assert (tail != NULL);
+    assert (!memcmp (head->p_buffer, text, 5));
+
+    block_Release (next);
+    block_Release (tail);
+    assert (storage_releases == 0);
+    block_Release (head);
+    assert (storage_releases == 1);
+
+    /* Remaining tail released before the slices */
+    tail = storage_New ();
+    storage_releases = 0;
+    head = block_Slice (&tail, 4);
+    next = block_Slice (&tail, 4);
+    assert (head != NULL && next != NULL);
+    block_Release (tail);
+    block_Release (head);
+    assert (storage_releases == 0);
+    assert (!memcmp (next->p_buffer, text + 4, 4));
+    block_Release (next);
+    assert (storage_releases == 1);
+
+    /* Cutting at the end hands the whole block over */
+    tail = storage_New ();
+    storage_releases = 0;
+    head = block_Slice (&tail, sizeof (text));
+    assert (tail == NULL && head != NULL);
+    block_Release (head);
+    assert (storage_releases == 1);
+}
+
+static void test_block_Share (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = 42;
+
+    block_t *copy = block_Share (&block);
+    assert (copy != NULL);
+    assert (copy->p_buffer == block->p_buffer);
+    assert (copy->i_buffer == sizeof (text));
+    assert (copy->i_pts == 42);
+
+    block_t *other = block_Share (&copy);
+    assert (other != NULL);
+    block_Release (block);
+    block_Release (copy);
+    assert (!memcmp (other->p_buffer, text, sizeof (text)));
+
+    /* Growing must not overwrite the shared storage */
+    other = block_Realloc (other, 0, sizeof (text) + 200);
+    assert (other != NULL);
+    assert (!memcmp (other->p_buffer, text, sizeof (text)));
+    block_Release (other);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Slice ();
+    test_block_Share ();
     return 0;
 }
 
@@ -54,6 +54,7 @@
 #include "display.h"
 #include "window.h"
 #include "../misc/variables.h"
+#include "../misc/tracer.h"
 
 /*****************************************************************************
  * Local prototypes
@@ -894,7 +895,13 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool fra
         vout->p->displayed.timestamp     = decoded->date;
         vout->p->displayed.is_interlaced = !decoded->b_progressive;
 
+        vlc_tracer_t *tracer = libvlc_tracer(vout);
+        mtime_t trace_start = vlc_tracer_Begin(tracer);
+
         picture = filter_chain_VideoFilter(vout->p->filter.chain_static, decoded);
+
+        vlc_tracer_EndDate(tracer, VLC_TRACER_FILTER, trace_start,
+                           vout->p->displayed.timestamp);
     }
 
     vlc_mutex_unlock(&vout->p->filter.lock);
@@ -970,6 +977,9 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     vout_display_t *vd = vout->p->display.vd;
 
     picture_t *torender = picture_Hold(vout->p->displayed.current);
+    vlc_tracer_t *tracer = libvlc_tracer(vout);
+    const mtime_t trace_date = torender->date;
+    mtime_t trace_start = vlc_tracer_Begin(tracer);
 
     vout_chrono_Start(&vout->p->render);
 
@@ -1155,6 +1165,7 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     }
 
     vout_chrono_Stop(&vout->p->render);
+    vlc_tracer_EndDate(tracer, VLC_TRACER_RENDER, trace_start, trace_date);
 #if 0
         {
         static int i = 0;
@@ -1175,7 +1186,9 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 
     /* Display the direct buffer returned by vout_RenderPicture */
     vout->p->displayed.date = mdate();
+    trace_start = vlc_tracer_Begin(tracer);
     vout_display_Display(vd, todisplay, subpic);
+    vlc_tracer_EndDate(tracer, VLC_TRACER_DISPLAY, trace_start, trace_date);
 
     vout_statistic_AddDisplayed(&vout->p->statistic, 1);
 
@@ -55,6 +55,8 @@
 typedef struct {
     subpicture_t *subpicture;
     bool          reject;
+    bool          prerender;     /**< text to be rendered by the worker */
+    bool          rendering;     /**< being rendered by the worker */
 } spu_heap_entry_t;
 
 typedef struct {
@@ -93,6 +95,18 @@ struct spu_private_t {
     vlc_mutex_t    filter_chain_lock;
     filter_chain_t *filter_chain;
 
+    /* Text prerendering worker */
+    struct {
+        bool            alive;
+        vlc_thread_t    thread;
+        vlc_cond_t      wait;
+        vlc_mutex_t     text_lock;          /**< protects text (only) */
+        filter_t        *text;
+        video_format_t  fmt_src;            /**< as of the last rendering */
+        video_format_t  fmt_dst;
+        vlc_fourcc_t    chroma_list[8];
+    } prerender;
+
     /* */
     mtime_t             last_sort_date;
     vout_thread_t       *vout;
@@ -108,10 +122,12 @@ static void SpuHeapInit(spu_heap_t *heap)
 
         e->subpicture = NULL;
         e->reject     = false;
+        e->prerender  = false;
+        e->rendering  = false;
     }
 }
 
-static int SpuHeapPush(spu_heap_t *heap, subpicture_t *subpic)
+static int SpuHeapPush(spu_heap_t *heap, subpicture_t *subpic, bool prerender)
 {
     for (int i = 0; i < VOUT_MAX_SUBPICTURES; i++) {
         spu_heap_entry_t *e = &heap->entry[i];
@@ -121,6 +137,8 @@ static int SpuHeapPush(spu_heap_t *heap, subpicture_t *subpic)
 
         e->subpicture = subpic;
         e->reject     = false;
+        e->prerender  = prerender;
+        e->rendering  = false;
         return VLC_SUCCESS;
     }
     return VLC_EGENERIC;
@@ -244,13 +262,11 @@ static filter_t *SpuRenderCreateAndLoadScale(vlc_object_t *object,
     return scale;
 }
 
-static void SpuRenderText(spu_t *spu, bool *rerender_text,
+static void SpuRenderText(filter_t *text, bool *rerender_text,
                           subpicture_region_t *region,
                           const vlc_fourcc_t *chroma_list,
                           mtime_t elapsed_time)
 {
-    filter_t *text = spu->p->text;
-
     assert(region->fmt.i_chroma == VLC_CODEC_TEXT);
 
     if (!text || !text->p_module)
@@ -538,7 +554,7 @@ static void SpuSelectSubpictures(spu_t *spu,
 
     for (int index = 0; index < VOUT_MAX_SUBPICTURES; index++) {
         spu_heap_entry_t *entry = &sys->heap.entry[index];
-        if (!entry->subpicture || entry->reject)
+        if (!entry->subpicture || entry->reject || entry->rendering)
             continue;
         const int i_channel = entry->subpicture->i_channel;
         int i;
@@ -570,11 +586,15 @@ static void SpuSelectSubpictures(spu_t *spu,
             bool is_late;
 
             if (!current || entry->reject) {
-                if (entry->reject)
+                if (entry->reject && !entry->rendering)
                     SpuHeapDeleteAt(&sys->heap, index);
                 continue;
             }
 
+            /* Not ready yet, it will be shown on the next picture */
+            if (entry->rendering)
+                continue;
+
             if (current->i_channel != channel[i] ||
                (ignore_osd && !current->b_subtitle))
                 continue;
@@ -604,6 +624,9 @@ static void SpuSelectSubpictures(spu_t *spu,
             if (current->b_subtitle && !is_late && !current->b_ephemer)
                 start_date = current->i_start;
 
+            /* The video output thread renders it from now on */
+            entry->prerender = false;
+
             /* */
             available_subpic[available_count] = current;
             is_available_late[available_count] = is_late;
@@ -647,6 +670,33 @@ static void SpuSelectSubpictures(spu_t *spu,
 
 
 
+/**
+ * Creates an output region referencing an already rendered (and possibly
+ * cached) picture.
+ *
+ * Unlike subpicture_region_New(), it does not allocate a picture buffer
+ * of the region size, which would be thrown away right away on every
+ * rendered frame.
+ */
+static subpicture_region_t *SpuRegionNewFromPicture(const video_format_t *fmt,
+                                                    picture_t *picture)
+{
+    video_format_t fmt_empty = *fmt;
+    fmt_empty.i_chroma  = VLC_CODEC_TEXT;
+    fmt_empty.p_palette = NULL;
+
+    subpicture_region_t *region = subpicture_region_New(&fmt_empty);
+    if (!region)
+        return NULL;
+
+    if (video_format_Copy(&region->fmt, fmt) != VLC_SUCCESS) {
+        subpicture_region_Delete(region);
+        return NULL;
+    }
+    region->p_picture = picture_Hold(picture);
+    return region;
+}
+
 /**
  * It will transform the provided region into another region suitable for rendering.
  */
@@ -675,7 +725,7 @@ static void SpuRenderRegion(spu_t *spu,
 
     /* Render text region */
     if (region->fmt.i_chroma == VLC_CODEC_TEXT) {
-        SpuRenderText(spu, &restore_text, region,
+        SpuRenderText(sys->text, &restore_text, region,
                       chroma_list,
                       render_date - subpic->i_start);
 
@@ -947,14 +997,12 @@ static void SpuRenderRegion(spu_t *spu,
         }
     }
 
-    subpicture_region_t *dst = *dst_ptr = subpicture_region_New(&region_fmt);
+    subpicture_region_t *dst = *dst_ptr = SpuRegionNewFromPicture(&region_fmt,
+                                                                  region_picture);
     if (dst) {
         dst->i_x       = x_offset;
         dst->i_y       = y_offset;
         dst->i_align   = 0;
-        if (dst->p_picture)
-            picture_Release(dst->p_picture);
-        dst->p_picture = picture_Hold(region_picture);
         int fade_alpha = 255;
         if (subpic->b_fade) {
             mtime_t fade_start = subpic->i_start + 3 * (subpic->i_stop - subpic->i_start) / 4;
@@ -1129,6 +1177,106 @@ static subpicture_t *SpuRenderSubpictures(spu_t *spu,
     return output;
 }
 
+/**
+ * Renders the text regions of a subpicture ahead of its display, so that
+ * the video output thread does not have to lay the text out.
+ *
+ * The regions are updated for the formats of the last rendering: should
+ * they change, the subpicture will be updated and rendered again by the
+ * video output thread. Time-dependent text (karaoke) is left as is.
+ */
+static void SpuPrerenderSubpicture(filter_t *text, subpicture_t *subpic,
+                                   const video_format_t *fmt_src,
+                                   const video_format_t *fmt_dst,
+                                   const vlc_fourcc_t *chroma_list,
+                                   mtime_t start)
+{
+    subpicture_Update(subpic, fmt_src, fmt_dst, start);
+
+    if (subpic->i_original_picture_width  <= 0 ||
+        subpic->i_original_picture_height <= 0)
+        return;
+
+    text->fmt_out.video.i_width          =
+    text->fmt_out.video.i_visible_width  = subpic->i_original_picture_width;
+    text->fmt_out.video.i_height         =
+    text->fmt_out.video.i_visible_height = subpic->i_original_picture_height;
+
+    for (subpicture_region_t *region = subpic->p_region; region != NULL;
+         region = region->p_next) {
+        if (region->fmt.i_chroma != VLC_CODEC_TEXT)
+            continue;
+
+        video_format_t fmt_original = region->fmt;
+        bool rerender_text;
+
+        SpuRenderText(text, &rerender_text, region, chroma_list, 0);
+
+        if (rerender_text && region->fmt.i_chroma != VLC_CODEC_TEXT) {
+            if (region->p_picture) {
+                picture_Release(region->p_picture);
+                region->p_picture = NULL;
+            }
+            region->fmt = fmt_original;
+        }
+    }
+}
+
+static void *SpuPrerenderThread(void *data)
+{
+    spu_t *spu = data;
+    spu_private_t *sys = spu->p;
+
+    vlc_mutex_lock(&sys->lock);
+    while (sys->prerender.alive) {
+        /* Pick the subpicture to be displayed first */
+        spu_heap_entry_t *next = NULL;
+
+        for (int i = 0; i < VOUT_MAX_SUBPICTURES; i++) {
+            spu_heap_entry_t *entry = &sys->heap.entry[i];
+
+            if (!entry->subpicture || !entry->prerender || entry->reject)
+                continue;
+            if (!next || entry->subpicture->i_start < next->subpicture->i_start)
+                next = entry;
+        }
+
+        if (!next) {
+            vlc_cond_wait(&sys->prerender.wait, &sys->lock);
+            continue;
+        }
+
+        next->prerender = false;
+        if (sys->prerender.fmt_dst.i_chroma == 0)
+            continue; /* nothing was rendered yet */
+
+        video_format_t fmt_src, fmt_dst;
+        vlc_fourcc_t chroma_list[ARRAY_SIZE(sys->prerender.chroma_list)];
+
+        video_format_Copy(&fmt_src, &sys->prerender.fmt_src);
+        video_format_Copy(&fmt_dst, &sys->prerender.fmt_dst);
+        memcpy(chroma_list, sys->prerender.chroma_list, sizeof (chroma_list));
+        const mtime_t start = next->subpicture->i_start;
+        next->rendering = true;
+        vlc_mutex_unlock(&sys->lock);
+
+        vlc_mutex_lock(&sys->prerender.text_lock);
+        filter_t *text = sys->prerender.text;
+        if (text && text->p_module)
+            SpuPrerenderSubpicture(text, next->subpicture,
+                                   &fmt_src, &fmt_dst, chroma_list, start);
+        vlc_mutex_unlock(&sys->prerender.text_lock);
+
+        video_format_Clean(&fmt_src);
+        video_format_Clean(&fmt_dst);
+
+        vlc_mutex_lock(&sys->lock);
+        next->rendering = false;
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
 /*****************************************************************************
  * Object variables callbacks
  *****************************************************************************/
@@ -1326,6 +1474,26 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     sys->last_sort_date = -1;
     sys->vout = vout;
 
+    /* Text prerendering worker */
+    vlc_cond_init(&sys->prerender.wait);
+    vlc_mutex_init(&sys->prerender.text_lock);
+    video_format_Init(&sys->prerender.fmt_src, 0);
+    video_format_Init(&sys->prerender.fmt_dst, 0);
+    sys->prerender.chroma_list[0] = 0;
+    sys->prerender.text = NULL;
+    sys->prerender.alive = false;
+
+    if (var_InheritBool(spu, "sub-prerender")) {
+        sys->prerender.text = SpuRenderCreateAndLoadText(spu);
+        sys->prerender.alive = true;
+        if (vlc_clone(&sys->prerender.thread, SpuPrerenderThread, spu,
+                      VLC_THREAD_PRIORITY_LOW)) {
+            sys->prerender.alive = false;
+            FilterRelease(sys->prerender.text);
+            sys->prerender.text = NULL;
+        }
+    }
+
     return spu;
 }
 
@@ -1338,6 +1506,20 @@ void spu_Destroy(spu_t *spu)
 {
     spu_private_t *sys = spu->p;
 
+    if (sys->prerender.alive) {
+        vlc_mutex_lock(&sys->lock);
+        sys->prerender.alive = false;
+        vlc_cond_signal(&sys->prerender.wait);
+        vlc_mutex_unlock(&sys->lock);
+        vlc_join(sys->prerender.thread, NULL);
+    }
+    if (sys->prerender.text)
+        FilterRelease(sys->prerender.text);
+    video_format_Clean(&sys->prerender.fmt_src);
+    video_format_Clean(&sys->prerender.fmt_dst);
+    vlc_mutex_destroy(&sys->prerender.text_lock);
+    vlc_cond_destroy(&sys->prerender.wait);
+
     if (sys->text)
         FilterRelease(sys->text);
 
@@ -1392,6 +1574,14 @@ void spu_Attach(spu_t *spu, vlc_object_t *input, bool attach)
         spu->p->text = SpuRenderCreateAndLoadText(spu);
 
         vlc_mutex_unlock(&spu->p->lock);
+
+        /* Reload the fonts attached to the input in the worker too */
+        if (spu->p->prerender.text) {
+            vlc_mutex_lock(&spu->p->prerender.text_lock);
+            FilterRelease(spu->p->prerender.text);
+            spu->p->prerender.text = SpuRenderCreateAndLoadText(spu);
+            vlc_mutex_unlock(&spu->p->prerender.text_lock);
+        }
     } else {
         vlc_mutex_lock(&spu->p->lock);
         spu->p->input = NULL;
@@ -1499,13 +1689,18 @@ void spu_PutSubpicture(spu_t *spu, subpicture_t *subpic)
         assert(r->p_private == NULL);
 
     /* */
+    /* Subtitles are rendered ahead of time if possible */
+    const bool prerender = sys->prerender.alive && subpic->b_subtitle;
+
     vlc_mutex_lock(&sys->lock);
-    if (SpuHeapPush(&sys->heap, subpic)) {
+    if (SpuHeapPush(&sys->heap, subpic, prerender)) {
         vlc_mutex_unlock(&sys->lock);
         msg_Err(spu, "subpicture heap full");
         subpicture_Delete(subpic);
         return;
     }
+    if (prerender)
+        vlc_cond_signal(&sys->prerender.wait);
     vlc_mutex_unlock(&sys->lock);
 }
 
@@ -1569,6 +1764,24 @@ subpicture_t *spu_Render(spu_t *spu,
 
     vlc_mutex_lock(&sys->lock);
 
+    if (sys->prerender.alive) {
+        if (!video_format_IsSimilar(&sys->prerender.fmt_src, fmt_src) ||
+            !video_format_IsSimilar(&sys->prerender.fmt_dst, fmt_dst)) {
+            video_format_Clean(&sys->prerender.fmt_src);
+            video_format_Clean(&sys->prerender.fmt_dst);
+            video_format_Copy(&sys->prerender.fmt_src, fmt_src);
+            video_format_Copy(&sys->prerender.fmt_dst, fmt_dst);
+        }
+
+        const size_t max = ARRAY_SIZE(sys->prerender.chroma_list) - 1;
+        size_t n = 0;
+        while (n < max && chroma_list[n] != 0) {
+            sys->prerender.chroma_list[n] = chroma_list[n];
+            n++;
+        }
+        sys->prerender.chroma_list[n] = 0;
+    }
+
     unsigned int subpicture_count;
     subpicture_t *subpicture_array[VOUT_MAX_SUBPICTURES];
 
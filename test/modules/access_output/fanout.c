@@ -0,0 +1,198 @@
+/*****************************************************************************
+ * fanout.c: test the fan-out access output
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#define MODULE_NAME test_fanout
+#define MODULE_STRING "test_fanout"
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_sout.h>
+#include <vlc_block.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+/*
+ * Two destinations are fed by the fan-out: one which keeps the blocks it
+ * receives, and one which scrambles them in place, as the live HTTP output
+ * does when it encrypts the segments. The kept blocks must be left intact.
+ * A third destination fails to write: it must be written to once only, and
+ * not disturb the other ones.
+ */
+
+#define BLOCK_SIZE  1316
+#define BLOCK_COUNT 256
+
+static block_t *kept;
+static block_t **kept_last = &kept;
+static size_t scrambled;
+static unsigned failed;
+static vlc_sem_t fail_sem;
+
+static ssize_t KeepWrite(sout_access_out_t *access, block_t *block)
+{
+    size_t len = 0;
+
+    (void) access;
+    for (block_t *b = block; b != NULL; b = b->p_next)
+        len += b->i_buffer;
+    block_ChainLastAppend(&kept_last, block);
+    return len;
+}
+
+static int KeepOpen(vlc_object_t *obj)
+{
+    sout_access_out_t *access = (sout_access_out_t *)obj;
+
+    access->pf_write = KeepWrite;
+    return VLC_SUCCESS;
+}
+
+static ssize_t ScrambleWrite(sout_access_out_t *access, block_t *block)
+{
+    size_t len = 0;
+
+    (void) access;
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        for (size_t i = 0; i < block->i_buffer; i++)
+            block->p_buffer[i] ^= 0x5a;
+        len += block->i_buffer;
+        block_Release(block);
+        block = next;
+    }
+    scrambled += len;
+    return len;
+}
+
+static int ScrambleOpen(vlc_object_t *obj)
+{
+    sout_access_out_t *access = (sout_access_out_t *)obj;
+
+    access->pf_write = ScrambleWrite;
+    return VLC_SUCCESS;
+}
+
+static ssize_t FailWrite(sout_access_out_t *access, block_t *block)
+{
+    (void) access;
+    block_ChainRelease(block);
+    failed++;
+    vlc_sem_post(&fail_sem);
+    return -1;
+}
+
+static int FailOpen(vlc_object_t *obj)
+{
+    sout_access_out_t *access = (sout_access_out_t *)obj;
+
+    access->pf_write = FailWrite;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_capability("sout access", 0)
+    add_shortcut("test-keep")
+    set_callbacks(KeepOpen, NULL)
+    add_submodule()
+    /* Take the place of the real live HTTP output, if any */
+    set_capability("sout access", 1000)
+    add_shortcut("livehttp")
+    set_callbacks(ScrambleOpen, NULL)
+    add_submodule()
+    set_capability("sout access", 0)
+    add_shortcut("test-fail")
+    set_callbacks(FailOpen, NULL)
+vlc_module_end()
+
+typedef int (*vlc_plugin_cb)(int (*)(void *, void *, int, ...), void *);
+
+VLC_EXPORT vlc_plugin_cb vlc_static_modules[] = {
+    vlc_entry__test_fanout,
+    NULL
+};
+
+static void test_fanout(vlc_object_t *obj, const char *chain, unsigned fails)
+{
+    sout_access_out_t *access = sout_AccessOutNew(obj, chain, "");
+    assert(access != NULL);
+
+    for (unsigned i = 0; i < BLOCK_COUNT; i++)
+    {
+        block_t *block = block_Alloc(BLOCK_SIZE);
+        assert(block != NULL);
+        memset(block->p_buffer, i, BLOCK_SIZE);
+        assert(sout_AccessOutWrite(access, block) == BLOCK_SIZE);
+
+        /* Let the failing destination fail before writing more */
+        if (i == 0 && fails > 0)
+            vlc_sem_wait(&fail_sem);
+    }
+
+    /* Waits for all the destinations to be written */
+    sout_AccessOutDelete(access);
+
+    assert(scrambled == BLOCK_SIZE * BLOCK_COUNT);
+    unsigned count = 0;
+    for (block_t *block = kept; block != NULL; block = block->p_next)
+    {
+        assert(block->i_buffer == BLOCK_SIZE);
+        for (size_t i = 0; i < block->i_buffer; i++)
+            assert(block->p_buffer[i] == (uint8_t)count);
+        count++;
+    }
+    assert(count == BLOCK_COUNT);
+    assert(failed == fails);
+
+    block_ChainRelease(kept);
+    kept = NULL;
+    kept_last = &kept;
+    scrambled = 0;
+    failed = 0;
+}
+
+int main(void)
+{
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+    vlc_sem_init(&fail_sem, 0);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* The original block used to go to the last destination */
+    test_fanout(obj, "fanout{dst=test-keep://,dst=livehttp://}", 0);
+    test_fanout(obj, "fanout{dst=livehttp://,dst=test-keep://}", 0);
+    test_fanout(obj, "fanout{dst=test-fail://,dst=livehttp://,"
+                     "dst=test-keep://}", 1);
+
+    libvlc_release(vlc);
+    vlc_sem_destroy(&fail_sem);
+    return 0;
+}
@@ -213,9 +213,43 @@ static void test_annexb()
     test_iterators( NULL, 0, p_res, rgi_res );
 }
 
+static const uint8_t * startcode_FindAnnexB_Ref( const uint8_t *p, const uint8_t *end )
+{
+    for( ; end - p > 3; p++ )
+        if( p[0] == 0 && p[1] == 0 && p[2] == 1 )
+            return p;
+    return NULL;
+}
+
+static void test_startcode()
+{
+    uint8_t buf[256 + 16];
+
+    printf("\nTEST startcode lookup\n");
+    srand( 0 );
+    for( unsigned i = 0; i < 10000; i++ )
+    {
+        /* zero-heavy random data with sparse start codes */
+        for( size_t j = 0; j < sizeof(buf); j++ )
+            buf[j] = (rand() % 4) ? 0x00 : (rand() % 3);
+
+        const uint8_t *p = &buf[rand() % 16];
+        const uint8_t *end = &p[rand() % 257];
+
+        const uint8_t *ref = startcode_FindAnnexB_Ref( p, end );
+        assert( startcode_FindAnnexB_Bits( p, end ) == ref );
+        assert( startcode_FindAnnexB( p, end ) == ref );
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+        if( vlc_CPU_SSE2() )
+            assert( startcode_FindAnnexB_SSE2( p, end ) == ref );
+#endif
+    }
+}
+
 int main( void )
 {
     test_annexb();
+    test_startcode();
 
     return 0;
 }
@@ -18,6 +18,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include <stdint.h>
 #include <vlc/vlc.h>
 
 #if 0
@@ -37,6 +38,22 @@ struct vlc_run_args
 
     /* true to test demux controls */
     bool test_demux_controls;
+
+    /* if not NULL, remux the elementary streams with this muxer (and its
+     * options), into the dummy access output */
+    const char *mux;
+
+    /* if not NULL, filled with the statistics of the demux loop */
+    struct vlc_run_stats *stats;
+};
+
+struct vlc_run_stats
+{
+    uint64_t demux_calls;
+    uint64_t blocks; /* sent to the ES output */
+    uint64_t bytes;  /* sent to the ES output */
+    uint64_t wall_ns;
+    uint64_t cpu_ns; /* of the demux thread, decoders included */
 };
 
 void vlc_run_args_init(struct vlc_run_args *args);
@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include <vlc_common.h>
 #include <vlc_access.h>
@@ -42,6 +43,9 @@
 #include <vlc_meta.h>
 #include <vlc_es_out.h>
 #include <vlc_url.h>
+#include <vlc_codec.h>
+#include <vlc_modules.h>
+#include <vlc_sout.h>
 #include "../lib/libvlc_internal.h"
 
 #include <vlc/vlc.h>
@@ -53,6 +57,8 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    struct vlc_run_stats *stats;
+    sout_mux_t *mux;
 };
 
 struct es_out_id_t
@@ -61,8 +67,84 @@ struct es_out_id_t
 #ifdef HAVE_DECODERS
     decoder_t *decoder;
 #endif
+    /* Remuxing */
+    decoder_t *packetizer; /* NULL if the ES is packetized already */
+    es_format_t fmt;
+    sout_input_t *mux_input;
+    bool mux_failed;
 };
 
+static decoder_t *test_packetizer_create(vlc_object_t *parent,
+                                         const es_format_t *fmt)
+{
+    decoder_t *packetizer = vlc_object_create(parent, sizeof (*packetizer));
+    if (packetizer == NULL)
+        return NULL;
+
+    es_format_Copy(&packetizer->fmt_in, fmt);
+    es_format_Init(&packetizer->fmt_out, fmt->i_cat, 0);
+    packetizer->p_module = module_need(packetizer, "packetizer", NULL, false);
+    if (packetizer->p_module == NULL)
+    {
+        es_format_Clean(&packetizer->fmt_in);
+        vlc_object_release(packetizer);
+        return NULL;
+    }
+    return packetizer;
+}
+
+static void test_packetizer_destroy(decoder_t *packetizer)
+{
+    module_unneed(packetizer, packetizer->p_module);
+    es_format_Clean(&packetizer->fmt_out);
+    es_format_Clean(&packetizer->fmt_in);
+    if (packetizer->p_description)
+        vlc_meta_Delete(packetizer->p_description);
+    vlc_object_release(packetizer);
+}
+
+static void MuxSendPacketized(sout_mux_t *mux, es_out_id_t *id,
+                              const es_format_t *fmt, block_t *block)
+{
+    /* As with the stream output, the stream is added to the muxer with the
+     * format of its first packetized block */
+    if (id->mux_input == NULL && !id->mux_failed)
+    {
+        id->mux_input = sout_MuxAddStream(mux, fmt);
+        id->mux_failed = id->mux_input == NULL;
+    }
+
+    if (id->mux_input != NULL)
+        sout_MuxSendBuffer(mux, id->mux_input, block);
+    else
+        block_ChainRelease(block);
+}
+
+/* Sends a block to the muxer, or drains the packetizer if block is NULL */
+static void MuxSend(sout_mux_t *mux, es_out_id_t *id, block_t *block)
+{
+    if (id->packetizer == NULL)
+    {
+        if (block != NULL)
+            MuxSendPacketized(mux, id, &id->fmt, block);
+        return;
+    }
+
+    decoder_t *packetizer = id->packetizer;
+    block_t **pp_block = block != NULL ? &block : NULL;
+    block_t *packetized;
+
+    while ((packetized = packetizer->pf_packetize(packetizer, pp_block)))
+        while (packetized != NULL)
+        {
+            block_t *next = packetized->p_next;
+
+            packetized->p_next = NULL;
+            MuxSendPacketized(mux, id, &packetizer->fmt_out, packetized);
+            packetized = next;
+        }
+}
+
 static es_out_id_t *EsOutAdd(es_out_t *out, const es_format_t *fmt)
 {
     struct test_es_out_t *ctx = (struct test_es_out_t *) out;
@@ -79,6 +161,15 @@ static es_out_id_t *EsOutAdd(es_out_t *out, const es_format_t *fmt)
 #ifdef HAVE_DECODERS
     id->decoder = test_decoder_create((void *)out->p_sys, fmt);
 #endif
+    id->packetizer = NULL;
+    es_format_Copy(&id->fmt, fmt);
+    id->mux_input = NULL;
+    id->mux_failed = false;
+    if (ctx->mux != NULL && !fmt->b_packetized)
+    {
+        id->packetizer = test_packetizer_create((void *)out->p_sys, fmt);
+        id->mux_failed = id->packetizer == NULL;
+    }
 
     debug("[%p] Added   ES\n", (void *)id);
     return id;
@@ -97,8 +188,31 @@ static void EsOutCheckId(es_out_t *out, es_out_id_t *id)
 
 static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 {
+    struct test_es_out_t *ctx = (struct test_es_out_t *) out;
+
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(out, id);
+    if (ctx->stats != NULL)
+    {
+        ctx->stats->blocks++;
+        ctx->stats->bytes += block->i_buffer;
+    }
+    if (ctx->mux != NULL)
+    {
+#ifdef HAVE_DECODERS
+        if (id->decoder)
+        {
+            block_t *dup = block_Duplicate(block);
+            if (dup != NULL)
+                MuxSend(ctx->mux, id, dup);
+        }
+        else
+#endif
+        {
+            MuxSend(ctx->mux, id, block);
+            return VLC_SUCCESS;
+        }
+    }
 #ifdef HAVE_DECODERS
     if (id->decoder)
         test_decoder_process(id->decoder, block);
@@ -108,7 +222,7 @@ static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
     return VLC_SUCCESS;
 }
 
-static void IdDelete(es_out_id_t *id)
+static void IdDelete(struct test_es_out_t *ctx, es_out_id_t *id)
 {
 #ifdef HAVE_DECODERS
     if (id->decoder)
@@ -118,6 +232,15 @@ static void IdDelete(es_out_id_t *id)
         test_decoder_destroy(id->decoder);
     }
 #endif
+    if (id->packetizer != NULL)
+    {
+        /* Drain */
+        MuxSend(ctx->mux, id, NULL);
+        test_packetizer_destroy(id->packetizer);
+    }
+    if (id->mux_input != NULL)
+        sout_MuxDeleteStream(ctx->mux, id->mux_input);
+    es_format_Clean(&id->fmt);
     free(id);
 }
 
@@ -135,7 +258,7 @@ static void EsOutDelete(es_out_t *out, es_out_id_t *id)
 
     debug("[%p] Deleted ES\n", (void *)id);
     *pp = id->next;
-    IdDelete(id);
+    IdDelete(ctx, id);
 }
 
 static int EsOutControl(es_out_t *out, int query, va_list args)
@@ -189,12 +312,14 @@ static void EsOutDestroy(es_out_t *out)
     while ((id = ctx->ids) != NULL)
     {
         ctx->ids = id->next;
-        IdDelete(id);
+        IdDelete(ctx, id);
     }
     free(ctx);
 }
 
-static es_out_t *test_es_out_create(vlc_object_t *parent)
+static es_out_t *test_es_out_create(vlc_object_t *parent,
+                                    struct vlc_run_stats *stats,
+                                    sout_mux_t *mux)
 {
     struct test_es_out_t *ctx = malloc(sizeof (*ctx));
     if (ctx == NULL)
@@ -204,6 +329,8 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->stats = stats;
+    ctx->mux = mux;
 
     es_out_t *out = &ctx->out;
     out->pf_add = EsOutAdd;
@@ -256,6 +383,61 @@ static void demux_get_meta(demux_t *demux)
     vlc_meta_Delete(p_meta);
 }
 
+static sout_mux_t *test_mux_create(vlc_object_t *parent, const char *name)
+{
+    /* The muxers only use the stream output instance for its variables and
+     * pace control: no stream output chain is needed */
+    sout_instance_t *sout = vlc_object_create(parent, sizeof (*sout));
+    if (sout == NULL)
+        return NULL;
+
+    sout->psz_sout = NULL;
+    sout->i_out_pace_nocontrol = 0;
+    vlc_mutex_init(&sout->lock);
+    sout->p_stream = NULL;
+    var_Create(sout, "sout-mux-caching", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
+
+    sout_access_out_t *access = sout_AccessOutNew(sout, "dummy", "");
+    if (access == NULL)
+    {
+        fprintf(stderr, "Error: cannot create the dummy access output.\n");
+        goto error;
+    }
+
+    sout_mux_t *mux = sout_MuxNew(sout, name, access);
+    if (mux == NULL)
+    {
+        fprintf(stderr, "Error: cannot create muxer: %s\n", name);
+        sout_AccessOutDelete(access);
+        goto error;
+    }
+    return mux;
+
+error:
+    vlc_mutex_destroy(&sout->lock);
+    vlc_object_release(sout);
+    return NULL;
+}
+
+static void test_mux_destroy(sout_mux_t *mux)
+{
+    sout_instance_t *sout = mux->p_sout;
+    sout_access_out_t *access = mux->p_access;
+
+    sout_MuxDelete(mux);
+    sout_AccessOutDelete(access);
+    vlc_mutex_destroy(&sout->lock);
+    vlc_object_release(sout);
+}
+
+static uint64_t clock_ns(clockid_t id)
+{
+    struct timespec ts;
+
+    clock_gettime(id, &ts);
+    return ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
 static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
 {
     const char *name = args->name;
@@ -265,14 +447,34 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     if (s == NULL)
         return -1;
 
-    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    if (args->stats != NULL)
+        memset(args->stats, 0, sizeof (*args->stats));
+
+    sout_mux_t *mux = NULL;
+    if (args->mux != NULL)
+    {
+        mux = test_mux_create(VLC_OBJECT(s), args->mux);
+        if (mux == NULL)
+        {
+            vlc_stream_Delete(s);
+            return -1;
+        }
+    }
+
+    es_out_t *out = test_es_out_create(VLC_OBJECT(s), args->stats, mux);
     if (out == NULL)
+    {
+        if (mux != NULL)
+            test_mux_destroy(mux);
         return -1;
+    }
 
     demux_t *demux = demux_New(VLC_OBJECT(s), name, "", s, out);
     if (demux == NULL)
     {
         es_out_Delete(out);
+        if (mux != NULL)
+            test_mux_destroy(mux);
         vlc_stream_Delete(s);
         debug("Error: cannot create demultiplexer: %s\n", name);
         return -1;
@@ -280,6 +482,8 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
 
     uintmax_t i = 0;
     int val;
+    uint64_t wall = clock_ns(CLOCK_MONOTONIC);
+    uint64_t cpu = clock_ns(CLOCK_THREAD_CPUTIME_ID);
 
     while ((val = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS)
     {
@@ -305,8 +509,18 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
         i++;
     }
 
+    /* Include the decoders and muxer draining */
     demux_Delete(demux);
     es_out_Delete(out);
+    if (mux != NULL)
+        test_mux_destroy(mux);
+
+    if (args->stats != NULL)
+    {
+        args->stats->demux_calls = i;
+        args->stats->wall_ns = clock_ns(CLOCK_MONOTONIC) - wall;
+        args->stats->cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu;
+    }
 
     debug("Completed with %ju iteration(s).\n", i);
 
@@ -437,12 +651,22 @@ extern vlc_plugin_cb vlc_static_modules[];
     f(vc1) \
     f(rawvid) \
     f(rawaud) \
+    f(mux_asf) \
+    f(mux_avi) \
+    f(mux_dummy) \
+    f(mux_mp4) \
+    f(mux_ps) \
+    PLUGIN_MUX_TS(f) \
+    f(mux_wav) \
+    f(access_output_dummy) \
     DECODER_PLUGINS(f)
 
 #ifdef HAVE_DVBPSI
 # define PLUGIN_TS(f) f(ts)
+# define PLUGIN_MUX_TS(f) f(mux_ts)
 #else
 # define PLUGIN_TS(f)
+# define PLUGIN_MUX_TS(f)
 #endif
 
 #define DECL_PLUGIN(p) \
@@ -0,0 +1,211 @@
+/**
+ * @file vlc-demux-bench.c
+ */
+/*****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Throughput benchmark of the demuxers (and, in the vlc-demux-dec-bench
+ * flavour, of the packetizers and decoders) on sample files.
+ *
+ * Each file is loaded in memory, processed a few times to warm the caches
+ * up, then processed again for the measured runs. The results are printed
+ * on the standard output as one JSON object per file, with the median and
+ * the best of the runs, so that they can be tracked across versions.
+ *
+ * With a muxer (-m option or VLC_MUX environment variable), the elementary
+ * streams are also packetized and remuxed into a dummy access output, so
+ * that the whole remuxing path is measured.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "src/input/demux-run.h"
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static unsigned char *load_file(const char *path, size_t *length)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    unsigned char *buf = NULL;
+    size_t size = 0;
+
+    for (;;)
+    {
+        unsigned char *p = realloc(buf, size + 65536);
+        if (p == NULL)
+        {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        buf = p;
+
+        size_t len = fread(buf + size, 1, 65536, file);
+        size += len;
+        if (len < 65536)
+            break;
+    }
+
+    if (buf != NULL && ferror(file))
+    {
+        perror(path);
+        free(buf);
+        buf = NULL;
+    }
+    fclose(file);
+    *length = size;
+    return buf;
+}
+
+static void print_string(const char *str)
+{
+    putchar('"');
+    for (; *str; str++)
+        if (*str == '"' || *str == '\\')
+            printf("\\%c", *str);
+        else if ((unsigned char)*str < 0x20)
+            printf("\\u%04x", *str);
+        else
+            putchar(*str);
+    putchar('"');
+}
+
+static int bench_file(struct vlc_run_args *args, const char *path,
+                      unsigned warmup, unsigned runs)
+{
+    size_t length;
+    unsigned char *buf = load_file(path, &length);
+    if (buf == NULL)
+        return -1;
+
+    uint64_t *wall = malloc(runs * sizeof (*wall));
+    uint64_t *cpu = malloc(runs * sizeof (*cpu));
+    struct vlc_run_stats stats;
+    int ret = -1;
+
+    if (wall == NULL || cpu == NULL)
+        goto out;
+
+    args->stats = &stats;
+    for (unsigned i = 0; i < warmup + runs; i++)
+    {
+        if (vlc_demux_process_memory(args, buf, length))
+        {
+            fprintf(stderr, "Error: cannot process %s\n", path);
+            goto out;
+        }
+        if (i >= warmup)
+        {
+            wall[i - warmup] = stats.wall_ns;
+            cpu[i - warmup] = stats.cpu_ns;
+        }
+    }
+
+    qsort(wall, runs, sizeof (*wall), cmp_u64);
+    qsort(cpu, runs, sizeof (*cpu), cmp_u64);
+
+    const uint64_t wall_med = wall[runs / 2], cpu_med = cpu[runs / 2];
+    const double wall_s = wall_med ? wall_med / 1e9 : 1e-9;
+    const uint64_t blocks = stats.blocks ? stats.blocks : 1;
+
+    printf("{\"file\":");
+    print_string(path);
+    printf(",\"target\":");
+    print_string(args->name != NULL ? args->name : "any");
+    printf(",\"mux\":");
+    print_string(args->mux != NULL ? args->mux : "none");
+    printf(",\"runs\":%u,\"input_bytes\":%zu,\"demux_calls\":%"PRIu64
+           ",\"blocks\":%"PRIu64",\"block_bytes\":%"PRIu64
+           ",\"wall_ns_median\":%"PRIu64",\"wall_ns_min\":%"PRIu64
+           ",\"cpu_ns_median\":%"PRIu64",\"cpu_ns_min\":%"PRIu64
+           ",\"mb_per_s\":%.3f,\"blocks_per_s\":%.1f"
+           ",\"cpu_ns_per_block\":%.1f,\"cpu_ns_per_byte\":%.3f}\n",
+           runs, length, stats.demux_calls, stats.blocks, stats.bytes,
+           wall_med, wall[0], cpu_med, cpu[0],
+           length / wall_s / 1e6, stats.blocks / wall_s,
+           (double)cpu_med / blocks, length ? (double)cpu_med / length : 0.);
+    fflush(stdout);
+    ret = 0;
+out:
+    free(cpu);
+    free(wall);
+    free(buf);
+    return ret;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: [VLC_TARGET=demux] [VLC_MUX=mux] %s "
+            "[-w warmup] [-n runs] [-m mux] <filename>...\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    struct vlc_run_args args;
+    unsigned warmup = 1, runs = 5;
+    int c;
+
+    vlc_run_args_init(&args);
+
+    while ((c = getopt(argc, argv, "w:n:m:")) != -1)
+        switch (c)
+        {
+            case 'w':
+                warmup = strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                runs = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                args.mux = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+
+    if (optind >= argc || runs == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int ret = 0;
+    for (int i = optind; i < argc; i++)
+        if (bench_file(&args, argv[i], warmup, runs))
+            ret = 1;
+    return ret;
+}
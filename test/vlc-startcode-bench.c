@@ -0,0 +1,251 @@
+/**
+ * @file vlc-startcode-bench.c
+ */
+/*****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Micro-benchmark of the sync scanning helpers used by the demuxers and the
+ * packetizers: the AnnexB start code lookup (byte loop, bit trick, SSE2 and
+ * run-time dispatch) and the TS sync byte lookup (byte loop and memchr()).
+ *
+ * The buffers are synthetic and stay in the caches, so that the results
+ * measure the scanning code alone. One JSON object is printed per helper and
+ * per data pattern, with the median of the runs.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include "../modules/packetizer/startcode_helper.h"
+
+#define BUFFER_SIZE (1 << 20)
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static const uint8_t *startcode_Byte(const uint8_t *p, const uint8_t *end)
+{
+    for (; end - p > 3; p++)
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    return NULL;
+}
+
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+static const uint8_t *startcode_SSE2(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindAnnexB_SSE2(p, end);
+}
+#endif
+
+/* Same lookups as FindTSSync() in the TS demuxer, before and after it used
+ * memchr(): the offset of a sync byte followed by another one a packet
+ * later. */
+static const uint8_t *tssync_Byte(const uint8_t *p, const uint8_t *end)
+{
+    for (; end - p > 188; p++)
+        if (p[0] == 0x47 && p[188] == 0x47)
+            return p;
+    return NULL;
+}
+
+static const uint8_t *tssync_Memchr(const uint8_t *p, const uint8_t *end)
+{
+    while (end - p > 188)
+    {
+        p = memchr(p, 0x47, end - p - 188);
+        if (p == NULL)
+            return NULL;
+        if (p[188] == 0x47)
+            return p;
+        p++;
+    }
+    return NULL;
+}
+
+typedef const uint8_t *(*scan_fn)(const uint8_t *, const uint8_t *);
+
+static const struct
+{
+    const char *name;
+    scan_fn scan;
+    bool tssync;
+} helpers[] = {
+    { "startcode_byte", startcode_Byte, false },
+    { "startcode_bits", startcode_FindAnnexB_Bits, false },
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    { "startcode_sse2", startcode_SSE2, false },
+#endif
+    { "startcode", startcode_FindAnnexB, false },
+    { "tssync_byte", tssync_Byte, true },
+    { "tssync_memchr", tssync_Memchr, true },
+};
+
+enum
+{
+    PATTERN_RANDOM, /* compressed data, hardly any match */
+    PATTERN_NAL,    /* start codes every 4 KiB */
+    PATTERN_ZEROS,  /* zero-heavy data, many false candidates */
+};
+
+static const char *const patterns[] = { "random", "nal", "zeros" };
+
+static void fill(uint8_t *buf, size_t size, int pattern, bool tssync)
+{
+    srand(0);
+    for (size_t i = 0; i < size; i++)
+        switch (pattern)
+        {
+            case PATTERN_ZEROS:
+                buf[i] = (rand() % 4) ? 0x00 : (rand() % 0x100);
+                break;
+            default:
+                buf[i] = rand() % 0x100;
+                break;
+        }
+
+    /* Remove the accidental matches, then add the wanted ones */
+    for (size_t i = 0; i + 2 < size; i++)
+        if (tssync ? buf[i] == 0x47 && i + 188 < size && buf[i + 188] == 0x47
+                   : buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1)
+            buf[i] = 0xff;
+
+    if (pattern == PATTERN_NAL)
+        for (size_t i = 4096; i + 188 < size; i += 4096)
+        {
+            if (tssync)
+                buf[i] = buf[i + 188] = 0x47;
+            else
+                memcpy(&buf[i], "\x00\x00\x01", 3);
+        }
+}
+
+/* Scans the whole buffer, match after match */
+static size_t scan_all(scan_fn scan, const uint8_t *buf, size_t size)
+{
+    const uint8_t *p = buf, *end = buf + size;
+    size_t matches = 0;
+
+    while ((p = scan(p, end)) != NULL)
+    {
+        matches++;
+        p++;
+    }
+    return matches;
+}
+
+static void bench(unsigned h, int pattern, const uint8_t *buf, size_t size,
+                  unsigned runs, uint64_t *times)
+{
+    size_t matches = 0;
+
+    for (unsigned i = 0; i < runs + 1; i++)
+    {
+        uint64_t start = now_ns();
+        matches = scan_all(helpers[h].scan, buf, size);
+        if (i > 0) /* the first run warms the caches up */
+            times[i - 1] = now_ns() - start;
+    }
+
+    qsort(times, runs, sizeof (*times), cmp_u64);
+
+    const uint64_t med = times[runs / 2] ? times[runs / 2] : 1;
+    printf("{\"helper\":\"%s\",\"pattern\":\"%s\",\"runs\":%u"
+           ",\"bytes\":%zu,\"matches\":%zu,\"ns_median\":%"PRIu64
+           ",\"ns_min\":%"PRIu64",\"mb_per_s\":%.1f}\n",
+           helpers[h].name, patterns[pattern], runs, size, matches,
+           med, times[0], size * 1e3 / med);
+    fflush(stdout);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-n runs] [-s size_kib]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned runs = 20;
+    size_t size = BUFFER_SIZE;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:s:")) != -1)
+        switch (c)
+        {
+            case 'n':
+                runs = strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                size = strtoul(optarg, NULL, 0) * 1024;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+
+    if (runs == 0 || size < 1024)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    /* Misalign the data on purpose, as in real packets */
+    uint8_t *alloc = malloc(size + 1);
+    uint64_t *times = malloc(runs * sizeof (*times));
+    if (alloc == NULL || times == NULL)
+    {
+        free(alloc);
+        free(times);
+        return 1;
+    }
+    uint8_t *buf = alloc + 1;
+
+    for (int pattern = 0; pattern < (int)ARRAY_SIZE(patterns); pattern++)
+        for (int tssync = 0; tssync < 2; tssync++)
+        {
+            fill(buf, size, pattern, tssync);
+            for (unsigned h = 0; h < ARRAY_SIZE(helpers); h++)
+                if (helpers[h].tssync == tssync)
+                    bench(h, pattern, buf, size, runs, times);
+        }
+
+    free(times);
+    free(alloc);
+    return 0;
+}